@@ -1,7 +1,24 @@
 /**
  * @file arith_perf.c
  * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
- * @brief Performance of GMP arithmetic using small integers.
+ * @brief Performance of GMP arithmetic versus native integers.
+ * @details Times add, mul, divmod and powm with int64, __int128, mpz and mpn
+ * for operand sizes from 1 limb to max_limbs, and prints a CSV row per
+ * operation, representation and size with percentiles of time per operation.
+ * Each measurement calibrates a batch of iterations that lasts at least
+ * MIN_BATCH_DURATION, runs some warmup batches, and then times repetitions.
+ * Slow measurements skip warmups and repetitions beyond a time budget; the
+ * calibration batch warms them up.
+ *
+ * Operands of n limbs have their highest bit set. Divmod divides a 2n-limb
+ * dividend by an n-limb divisor. Powm raises an n-limb base to a one-limb
+ * exponent modulo an odd n-limb modulus; mpn uses mpn_sec_powm, the only
+ * mpn power, so its rows are labelled mpn_sec: it runs in constant time,
+ * unlike mpz_powm. Native types take the low bits of the same operands and
+ * wrap around on overflow, so they give the lower bound of each operation
+ * for the sizes they hold: int64 1 limb, and __int128 up to 2 limbs. Native
+ * powm keeps products in a wider type: a 32-bit modulus for int64 and a
+ * 64-bit modulus for __int128.
  * @version 0.1
  * @date 2022-05-03
  *
@@ -10,54 +27,469 @@
  */
 #define _DEFAULT_SOURCE
 
-#include <execinfo.h>
 #include <gmp.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 
-#define SUM_LIMIT 1e6
+/// Largest operand size, in limbs
+#define DEFAULT_MAX_LIMBS 10000
+
+/// Timed batches of each measurement
+#define DEFAULT_REPETITIONS 11
+
+/// Batches run before timing each measurement
+#define DEFAULT_WARMUPS 2
+
+/// Minimum duration of a batch, in seconds
+#define MIN_BATCH_DURATION 1e-3
+
+/// Once a measurement takes this long, in seconds, it stops doing warmups
+/// and repetitions beyond MIN_REPETITIONS, so large sizes stay practical
+#define MAX_MEASUREMENT_DURATION 2.0
+
+/// Repetitions done even if a measurement takes too long
+#define MIN_REPETITIONS 3
+
+/// Operand sets of each size, used in turn so results are not cached
+#define OPERAND_SETS 16
+
+/// Seed of random operands, so every run uses the same ones
+#define RANDOM_SEED 2022
+
+typedef unsigned __int128 uint128_t;
+
+/// Operands of one size, in every representation
+typedef struct operands {
+  /// Operand size in limbs
+  mp_size_t limbs;
+  /// First operands, bases of powm
+  mpz_t first[OPERAND_SETS];
+  /// Second operands
+  mpz_t second[OPERAND_SETS];
+  /// Dividends of 2 * limbs limbs
+  mpz_t dividend[OPERAND_SETS];
+  /// Divisors, odd moduli of powm
+  mpz_t divisor[OPERAND_SETS];
+  /// One-limb exponents of powm
+  mpz_t exponent[OPERAND_SETS];
+  /// mpz results
+  mpz_t result;
+  mpz_t remainder;
+  /// mpn results of 2 * limbs + 1 limbs
+  mp_limb_t* result_limbs;
+  mp_limb_t* remainder_limbs;
+  /// Scratch space of mpn_sec_powm
+  mp_limb_t* scratch;
+  /// Low bits of operands, for native types
+  uint64_t first64[OPERAND_SETS];
+  uint64_t second64[OPERAND_SETS];
+  uint64_t divisor64[OPERAND_SETS];
+  uint64_t exponent64[OPERAND_SETS];
+  uint128_t first128[OPERAND_SETS];
+  uint128_t second128[OPERAND_SETS];
+  uint128_t dividend128[OPERAND_SETS];
+  uint128_t divisor128[OPERAND_SETS];
+} operands_t;
+
+/// Operation timed for some representation
+typedef struct benchmark {
+  /// Operation name
+  const char* operation;
+  /// Representation name
+  const char* representation;
+  /// Largest operand size, in limbs, that the representation can hold
+  mp_size_t max_limbs;
+  /// Run the operation iterations times
+  void (*run)(operands_t* operands, size_t iterations);
+} benchmark_t;
 
 double get_duration(struct timespec stop_time, struct timespec start_time);
-void test_mpz_perf(void);
-void test_int64_perf(void);
+int operands_init(operands_t* operands, mp_size_t limbs,
+                  gmp_randstate_t random);
+void operands_destroy(operands_t* operands);
+void random_limbs(mpz_t number, mp_size_t limbs, gmp_randstate_t random);
+double time_batch(const benchmark_t* benchmark, operands_t* operands,
+                  size_t iterations);
+int compare_doubles(const void* first, const void* second);
+double percentile(const double* sorted, size_t count, double fraction);
 
-int main(void) {
-  test_mpz_perf();
-  test_int64_perf();
+void add_int64(operands_t* operands, size_t iterations);
+void add_int128(operands_t* operands, size_t iterations);
+void add_mpz(operands_t* operands, size_t iterations);
+void add_mpn(operands_t* operands, size_t iterations);
+void mul_int64(operands_t* operands, size_t iterations);
+void mul_int128(operands_t* operands, size_t iterations);
+void mul_mpz(operands_t* operands, size_t iterations);
+void mul_mpn(operands_t* operands, size_t iterations);
+void divmod_int64(operands_t* operands, size_t iterations);
+void divmod_int128(operands_t* operands, size_t iterations);
+void divmod_mpz(operands_t* operands, size_t iterations);
+void divmod_mpn(operands_t* operands, size_t iterations);
+void powm_int64(operands_t* operands, size_t iterations);
+void powm_int128(operands_t* operands, size_t iterations);
+void powm_mpz(operands_t* operands, size_t iterations);
+void powm_mpn(operands_t* operands, size_t iterations);
+
+/// Every benchmark, in the order they are reported for each size
+static const benchmark_t benchmarks[] = {
+    {"add", "int64", 1, add_int64},
+    {"add", "int128", 2, add_int128},
+    {"add", "mpz", 0, add_mpz},
+    {"add", "mpn", 0, add_mpn},
+    {"mul", "int64", 1, mul_int64},
+    {"mul", "int128", 2, mul_int128},
+    {"mul", "mpz", 0, mul_mpz},
+    {"mul", "mpn", 0, mul_mpn},
+    {"divmod", "int64", 1, divmod_int64},
+    {"divmod", "int128", 2, divmod_int128},
+    {"divmod", "mpz", 0, divmod_mpz},
+    {"divmod", "mpn", 0, divmod_mpn},
+    {"powm", "int64", 1, powm_int64},
+    {"powm", "int128", 1, powm_int128},
+    {"powm", "mpz", 0, powm_mpz},
+    {"powm", "mpn_sec", 0, powm_mpn},
+};
+
+/// Benchmark count
+#define BENCHMARK_COUNT (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+/**
+ * @brief Keep a value the compiler cannot prove unused, so loops of native
+ * operations are not removed.
+ *
+ * @param value Value
+ */
+static inline void keep(uint64_t value) {
+  __asm__ volatile("" : : "r"(value));
 }
 
-void test_mpz_perf(void) {
-  struct timespec start, stop;
-  mpz_t sum_mp, term_mp;
-  mpz_init(sum_mp);
-  mpz_init(term_mp);
-  double duration = 0.0;
-  clock_gettime(CLOCK_MONOTONIC, &start);
-  for (size_t index = 0; index < SUM_LIMIT; ++index) {
-    mpz_set_ui(term_mp, index);
-    mpz_add(sum_mp, sum_mp, term_mp);
+int main(int argc, char* argv[]) {
+  size_t max_limbs = DEFAULT_MAX_LIMBS;
+  size_t repetitions = DEFAULT_REPETITIONS;
+  size_t warmups = DEFAULT_WARMUPS;
+  if ((argc >= 2 && sscanf(argv[1], "%zu", &max_limbs) != 1) ||
+      (argc >= 3 && sscanf(argv[2], "%zu", &repetitions) != 1) ||
+      (argc >= 4 && sscanf(argv[3], "%zu", &warmups) != 1) ||
+      max_limbs == 0 || repetitions == 0) {
+    fprintf(stderr, "usage: %s [max_limbs] [repetitions] [warmups]\n",
+            argv[0]);
+    return EXIT_FAILURE;
   }
-  clock_gettime(CLOCK_MONOTONIC, &stop);
-  duration = get_duration(stop, start);
-  printf("Sum using GMP:   %fs\n", duration);
-  mpz_clear(term_mp);
-  mpz_clear(sum_mp);
+  double* times = malloc(repetitions * sizeof(double));
+  if (times == NULL) {
+    fprintf(stderr, "error: cannot allocate times\n");
+    return EXIT_FAILURE;
+  }
+  gmp_randstate_t random;
+  gmp_randinit_default(random);
+  gmp_randseed_ui(random, RANDOM_SEED);
+  int error = EXIT_SUCCESS;
+  printf("operation,representation,limbs,iterations,repetitions,min_ns,"
+         "p10_ns,median_ns,p90_ns,max_ns\n");
+  // Sizes 1, 2, 5, 10, 20, 50... up to max_limbs
+  const size_t steps[] = {1, 2, 5};
+  for (size_t scale = 1, step = 0; scale * steps[step] <= max_limbs;
+       step = (step + 1) % 3, scale *= step == 0 ? 10 : 1) {
+    const mp_size_t limbs = scale * steps[step];
+    operands_t operands;
+    error = operands_init(&operands, limbs, random);
+    if (error != EXIT_SUCCESS) {
+      break;
+    }
+    for (size_t index = 0; index < BENCHMARK_COUNT; ++index) {
+      const benchmark_t* benchmark = &benchmarks[index];
+      if (benchmark->max_limbs > 0 && limbs > benchmark->max_limbs) {
+        continue;
+      }
+      // Iterations per batch: double them until a batch is long enough
+      size_t iterations = 1;
+      double spent = 0.0;
+      double batch = 0.0;
+      while ((batch = time_batch(benchmark, &operands, iterations)) <
+             MIN_BATCH_DURATION) {
+        spent += batch;
+        iterations *= 2;
+      }
+      spent += batch;
+      for (size_t warmup = 0;
+           warmup < warmups && spent < MAX_MEASUREMENT_DURATION; ++warmup) {
+        spent += time_batch(benchmark, &operands, iterations);
+      }
+      size_t done = 0;
+      for (; done < repetitions && (done < MIN_REPETITIONS ||
+                                    spent < MAX_MEASUREMENT_DURATION);
+           ++done) {
+        batch = time_batch(benchmark, &operands, iterations);
+        spent += batch;
+        times[done] = 1e9 * batch / iterations;
+      }
+      qsort(times, done, sizeof(double), compare_doubles);
+      printf("%s,%s,%zu,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+             benchmark->operation, benchmark->representation, limbs,
+             iterations, done, times[0], percentile(times, done, 0.1),
+             percentile(times, done, 0.5), percentile(times, done, 0.9),
+             times[done - 1]);
+      fflush(stdout);
+    }
+    operands_destroy(&operands);
+  }
+  gmp_randclear(random);
+  free(times);
+  return error;
 }
 
-void test_int64_perf(void) {
+int operands_init(operands_t* operands, mp_size_t limbs,
+                  gmp_randstate_t random) {
+  memset(operands, 0, sizeof(operands_t));
+  operands->limbs = limbs;
+  for (size_t set = 0; set < OPERAND_SETS; ++set) {
+    random_limbs(operands->first[set], limbs, random);
+    random_limbs(operands->second[set], limbs, random);
+    random_limbs(operands->dividend[set], 2 * limbs, random);
+    random_limbs(operands->divisor[set], limbs, random);
+    mpz_setbit(operands->divisor[set], 0);
+    random_limbs(operands->exponent[set], 1, random);
+    // Native types take the low bits of the same operands
+    const mp_limb_t* first = mpz_limbs_read(operands->first[set]);
+    const mp_limb_t* second = mpz_limbs_read(operands->second[set]);
+    const mp_limb_t* dividend = mpz_limbs_read(operands->dividend[set]);
+    const mp_limb_t* divisor = mpz_limbs_read(operands->divisor[set]);
+    operands->first64[set] = first[0];
+    operands->second64[set] = second[0];
+    operands->divisor64[set] = (uint32_t)divisor[0] | 1;
+    operands->exponent64[set] = mpz_getlimbn(operands->exponent[set], 0);
+    operands->first128[set] = limbs > 1 ? (uint128_t)first[1] << 64 | first[0]
+                                        : first[0];
+    operands->second128[set] =
+        limbs > 1 ? (uint128_t)second[1] << 64 | second[0] : second[0];
+    operands->dividend128[set] = (uint128_t)dividend[1] << 64 | dividend[0];
+    operands->divisor128[set] =
+        limbs > 1 ? (uint128_t)divisor[1] << 64 | divisor[0] : divisor[0];
+  }
+  mpz_init2(operands->result, 2 * limbs * mp_bits_per_limb);
+  mpz_init2(operands->remainder, limbs * mp_bits_per_limb);
+  const size_t scratch_limbs = mpn_sec_powm_itch(limbs, mp_bits_per_limb,
+                                                 limbs);
+  operands->result_limbs = malloc((2 * limbs + 1) * sizeof(mp_limb_t));
+  operands->remainder_limbs = malloc((limbs + 1) * sizeof(mp_limb_t));
+  operands->scratch = malloc(scratch_limbs * sizeof(mp_limb_t));
+  if (operands->result_limbs == NULL || operands->remainder_limbs == NULL ||
+      operands->scratch == NULL) {
+    fprintf(stderr, "error: cannot allocate operands of %zu limbs\n",
+            (size_t)limbs);
+    operands_destroy(operands);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+void operands_destroy(operands_t* operands) {
+  for (size_t set = 0; set < OPERAND_SETS; ++set) {
+    mpz_clear(operands->first[set]);
+    mpz_clear(operands->second[set]);
+    mpz_clear(operands->dividend[set]);
+    mpz_clear(operands->divisor[set]);
+    mpz_clear(operands->exponent[set]);
+  }
+  mpz_clear(operands->result);
+  mpz_clear(operands->remainder);
+  free(operands->result_limbs);
+  free(operands->remainder_limbs);
+  free(operands->scratch);
+}
+
+void random_limbs(mpz_t number, mp_size_t limbs, gmp_randstate_t random) {
+  const mp_bitcnt_t bits = limbs * mp_bits_per_limb;
+  mpz_init2(number, bits);
+  mpz_urandomb(number, random, bits);
+  mpz_setbit(number, bits - 1);
+}
+
+double time_batch(const benchmark_t* benchmark, operands_t* operands,
+                  size_t iterations) {
   struct timespec start, stop;
-  int64_t sum = 0;
-  double duration = 0.0;
   clock_gettime(CLOCK_MONOTONIC, &start);
-  for (size_t index = 0; index < SUM_LIMIT; ++index) {
-    sum += index;
-  }
+  benchmark->run(operands, iterations);
   clock_gettime(CLOCK_MONOTONIC, &stop);
-  duration = get_duration(stop, start);
-  printf("Sum using int64: %fs\n", duration);
+  return get_duration(stop, start);
+}
+
+int compare_doubles(const void* first, const void* second) {
+  const double difference = *(const double*)first - *(const double*)second;
+  return (difference > 0) - (difference < 0);
+}
+
+double percentile(const double* sorted, size_t count, double fraction) {
+  // Linear interpolation between closest ranks
+  const double rank = fraction * (count - 1);
+  const size_t lower = (size_t)rank;
+  if (lower + 1 >= count) {
+    return sorted[count - 1];
+  }
+  return sorted[lower] + (rank - lower) * (sorted[lower + 1] - sorted[lower]);
+}
+
+void add_int64(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    keep(operands->first64[set] + operands->second64[set]);
+  }
+}
+
+void add_int128(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    const uint128_t sum = operands->first128[set] + operands->second128[set];
+    keep((uint64_t)sum);
+    keep((uint64_t)(sum >> 64));
+  }
+}
+
+void add_mpz(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    mpz_add(operands->result, operands->first[set], operands->second[set]);
+  }
+}
+
+void add_mpn(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    keep(mpn_add_n(operands->result_limbs,
+                   mpz_limbs_read(operands->first[set]),
+                   mpz_limbs_read(operands->second[set]), operands->limbs));
+  }
+}
+
+void mul_int64(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    keep(operands->first64[set] * operands->second64[set]);
+  }
+}
+
+void mul_int128(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    const uint128_t product =
+        operands->first128[set] * operands->second128[set];
+    keep((uint64_t)product);
+    keep((uint64_t)(product >> 64));
+  }
+}
+
+void mul_mpz(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    mpz_mul(operands->result, operands->first[set], operands->second[set]);
+  }
+}
+
+void mul_mpn(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    mpn_mul_n(operands->result_limbs, mpz_limbs_read(operands->first[set]),
+              mpz_limbs_read(operands->second[set]), operands->limbs);
+  }
+}
+
+void divmod_int64(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    const uint64_t dividend = operands->first64[set];
+    const uint64_t divisor = operands->divisor64[set];
+    keep(dividend / divisor);
+    keep(dividend % divisor);
+  }
+}
+
+void divmod_int128(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    const uint128_t dividend = operands->dividend128[set];
+    const uint128_t divisor = operands->divisor128[set];
+    const uint128_t quotient = dividend / divisor;
+    const uint128_t remainder = dividend % divisor;
+    keep((uint64_t)quotient);
+    keep((uint64_t)remainder);
+  }
+}
+
+void divmod_mpz(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    mpz_tdiv_qr(operands->result, operands->remainder,
+                operands->dividend[set], operands->divisor[set]);
+  }
+}
+
+void divmod_mpn(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    mpn_tdiv_qr(operands->result_limbs, operands->remainder_limbs, 0,
+                mpz_limbs_read(operands->dividend[set]), 2 * operands->limbs,
+                mpz_limbs_read(operands->divisor[set]), operands->limbs);
+  }
+}
+
+void powm_int64(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    // Modulus below 2^32, so products fit in 64 bits
+    const uint64_t modulus = operands->divisor64[set];
+    uint64_t base = operands->first64[set] % modulus;
+    uint64_t exponent = operands->exponent64[set];
+    uint64_t power = 1;
+    while (exponent > 0) {
+      if (exponent & 1) {
+        power = power * base % modulus;
+      }
+      base = base * base % modulus;
+      exponent >>= 1;
+    }
+    keep(power);
+  }
+}
+
+void powm_int128(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    // Modulus below 2^64, so products fit in 128 bits
+    const uint128_t modulus = (uint64_t)operands->divisor128[set];
+    uint128_t base = operands->first128[set] % modulus;
+    uint64_t exponent = operands->exponent64[set];
+    uint128_t power = 1;
+    while (exponent > 0) {
+      if (exponent & 1) {
+        power = power * base % modulus;
+      }
+      base = base * base % modulus;
+      exponent >>= 1;
+    }
+    keep((uint64_t)power);
+  }
+}
+
+void powm_mpz(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    mpz_powm(operands->result, operands->first[set], operands->exponent[set],
+             operands->divisor[set]);
+  }
+}
+
+void powm_mpn(operands_t* operands, size_t iterations) {
+  for (size_t index = 0; index < iterations; ++index) {
+    const size_t set = index % OPERAND_SETS;
+    mpn_sec_powm(operands->result_limbs, mpz_limbs_read(operands->first[set]),
+                 operands->limbs, mpz_limbs_read(operands->exponent[set]),
+                 mp_bits_per_limb, mpz_limbs_read(operands->divisor[set]),
+                 operands->limbs, operands->scratch);
+  }
 }
 
 // https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
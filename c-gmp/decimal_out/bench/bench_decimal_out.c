@@ -0,0 +1,135 @@
+/**
+ * @file bench_decimal_out.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Benchmark of parallel decimal output against mpz_get_str.
+ * @details For random numbers of 10^4, 10^5... digits up to max_digits,
+ * times mpz_get_str and decimal_out_get_str with 1, 2, 4... threads up to
+ * thread_count, both into a preallocated buffer, and checks that both
+ * strings are identical. Prints a CSV row per size, function and thread
+ * count, with the fastest of the runs and speedup over mpz_get_str.
+ * @version 1.0.0
+ * @date 2022-07-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <gmp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "decimal_out.h"
+
+/// Default largest digit count
+#define DEFAULT_MAX_DIGITS 10000000
+
+/// Smallest digit count
+#define MIN_DIGITS 10000
+
+/// Runs are repeated until they take this many seconds
+#define MIN_TOTAL_DURATION 0.2
+
+/// Seed of random numbers, so every run uses the same ones
+#define RANDOM_SEED 2022
+
+double get_duration(struct timespec stop_time, struct timespec start_time);
+
+/**
+ * @brief Time the conversion of a number, with mpz_get_str if thread_count
+ * is 0, or decimal_out_get_str otherwise.
+ *
+ * @param buffer Buffer of decimal_out_size(number) bytes
+ * @param number Number
+ * @param thread_count Threads of decimal_out_get_str, or 0
+ * @return Fastest of the runs, in seconds, or a negative value on error
+ */
+double time_conversion(char* buffer, mpz_t number, size_t thread_count);
+
+int main(int argc, char* argv[]) {
+  size_t max_digits = DEFAULT_MAX_DIGITS;
+  const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t max_threads = cpu_count > 1 ? (size_t)cpu_count : 2;
+  if ((argc >= 2 && sscanf(argv[1], "%zu", &max_digits) != 1) ||
+      (argc >= 3 && sscanf(argv[2], "%zu", &max_threads) != 1) ||
+      max_digits < MIN_DIGITS || max_threads == 0) {
+    fprintf(stderr, "usage: %s [max_digits] [thread_count]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  int error = EXIT_SUCCESS;
+  gmp_randstate_t random;
+  gmp_randinit_default(random);
+  gmp_randseed_ui(random, RANDOM_SEED);
+  mpz_t number, power;
+  mpz_inits(number, power, NULL);
+  printf("digits,function,threads,seconds,speedup\n");
+  for (size_t digits = MIN_DIGITS; digits <= max_digits && !error;
+       digits *= 10) {
+    mpz_ui_pow_ui(power, 10, digits);
+    mpz_urandomm(number, random, power);
+    char* expected = malloc(decimal_out_size(number));
+    char* buffer = malloc(decimal_out_size(number));
+    if (expected == NULL || buffer == NULL) {
+      fprintf(stderr, "%s", "error: cannot allocate digits\n");
+      free(expected);
+      free(buffer);
+      error = EXIT_FAILURE;
+      break;
+    }
+    const double baseline = time_conversion(expected, number, 0);
+    printf("%zu,mpz_get_str,1,%.6f,1.000\n", digits, baseline);
+    fflush(stdout);
+    // 1, 2, 4... threads, and then max_threads
+    for (size_t threads = 1; !error;
+         threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+      const double elapsed = time_conversion(buffer, number, threads);
+      if (elapsed < 0 || strcmp(buffer, expected) != 0) {
+        fprintf(stderr, "error: digits of %zu threads differ\n", threads);
+        error = EXIT_FAILURE;
+        break;
+      }
+      printf("%zu,decimal_out_get_str,%zu,%.6f,%.3f\n", digits, threads,
+             elapsed, baseline / elapsed);
+      fflush(stdout);
+      if (threads == max_threads) {
+        break;
+      }
+    }
+    free(expected);
+    free(buffer);
+  }
+  mpz_clears(number, power, NULL);
+  gmp_randclear(random);
+  return error;
+}
+
+double time_conversion(char* buffer, mpz_t number, size_t thread_count) {
+  double fastest = -1.0, total = 0.0;
+  while (total < MIN_TOTAL_DURATION) {
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (thread_count == 0) {
+      mpz_get_str(buffer, 10, number);
+    } else if (decimal_out_get_str(buffer, number, thread_count) == 0) {
+      return -1.0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    const double elapsed = get_duration(stop, start);
+    if (fastest < 0 || elapsed < fastest) {
+      fastest = elapsed;
+    }
+    total += elapsed;
+  }
+  return fastest;
+}
+
+// https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
+double get_duration(struct timespec stop_time, struct timespec start_time) {
+  return (stop_time.tv_sec + 1e-9 * stop_time.tv_nsec) -
+         (start_time.tv_sec + 1e-9 * start_time.tv_nsec);
+}
@@ -0,0 +1,255 @@
+/**
+ * @file decimal_out.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Parallel decimal output of big integers. Implementation.
+ * @version 1.0.0
+ * @date 2022-07-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "decimal_out.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/// Most powers of ten that split a number, enough for 2^31 threads
+#define MAX_POWERS 32
+
+/// Powers of ten that split numbers, each one the square of the previous one
+typedef struct powers {
+  /// Powers of ten
+  mpz_t values[MAX_POWERS];
+  /// Exponent of each power, the digits of the halves it splits
+  size_t digits[MAX_POWERS];
+  /// Power count
+  size_t count;
+} powers_t;
+
+/// High half of a number, converted by its own thread
+typedef struct part {
+  /// Value of the half
+  mpz_t number;
+  /// Where its digits are written
+  char* digits;
+  /// Digit count, padded with zeros on the left
+  size_t width;
+  /// Threads that convert this half
+  size_t thread_count;
+  /// Powers of ten that split it
+  const powers_t* powers;
+  /// True if memory could not be allocated
+  bool failed;
+} part_t;
+
+/**
+ * @brief Compute the powers of ten that split a number, so the largest one
+ * has about half of its digits, and there are enough levels for each thread
+ * to get its own part.
+ *
+ * @param powers Powers to initialize
+ * @param width Digits of number
+ * @param thread_count Threads
+ */
+static void decimal_out_init_powers(powers_t* powers, size_t width,
+                                    size_t thread_count);
+
+/**
+ * @brief Write a non-negative number as width digits, padded with zeros on
+ * the left, splitting it among threads.
+ *
+ * @param powers Powers of ten that split the number
+ * @param number Number lower than 10^width
+ * @param digits Where digits are written, without a null character
+ * @param width Digit count
+ * @param thread_count Threads, including the calling one
+ * @return true on success, false if memory could not be allocated
+ */
+static bool decimal_out_convert(const powers_t* powers, mpz_srcptr number,
+                                char* digits, size_t width,
+                                size_t thread_count);
+
+/**
+ * @brief Write a non-negative number as width digits, padded with zeros on
+ * the left, with mpn_get_str on the calling thread.
+ *
+ * @see decimal_out_convert
+ */
+static bool decimal_out_convert_serial(mpz_srcptr number, char* digits,
+                                       size_t width);
+
+/// Convert a part on its own thread
+static void* decimal_out_run_part(void* data);
+
+size_t decimal_out_get_str(char* buffer, mpz_srcptr number,
+                           size_t thread_count) {
+  assert(buffer);
+  if (thread_count == 0) {
+    const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    thread_count = cpu_count > 0 ? (size_t)cpu_count : 1;
+  }
+  char* digits = buffer;
+  if (mpz_sgn(number) < 0) {
+    *digits++ = '-';
+  }
+  // Digit count, or one more. Then the first digit is a zero
+  size_t width = mpz_sizeinbase(number, 10);
+  if (width < DECIMAL_OUT_PARALLEL_DIGITS) {
+    thread_count = 1;
+  }
+  mpz_t magnitude;
+  mpz_roinit_n(magnitude, mpz_limbs_read(number), mpz_size(number));
+  powers_t powers;
+  decimal_out_init_powers(&powers, width, thread_count);
+  const bool converted =
+      decimal_out_convert(&powers, magnitude, digits, width, thread_count);
+  for (size_t level = 0; level < powers.count; ++level) {
+    mpz_clear(powers.values[level]);
+  }
+  if (!converted) {
+    return 0;
+  }
+  if (width > 1 && digits[0] == '0') {
+    memmove(digits, digits + 1, --width);
+  }
+  digits[width] = '\0';
+  return digits + width - buffer;
+}
+
+size_t decimal_out_str(FILE* output, mpz_srcptr number, size_t thread_count) {
+  assert(output);
+  char* buffer = malloc(decimal_out_size(number));
+  if (buffer == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate digits\n");
+    return 0;
+  }
+  size_t length = decimal_out_get_str(buffer, number, thread_count);
+  if (length > 0 && fwrite(buffer, 1, length, output) != length) {
+    length = 0;
+  }
+  free(buffer);
+  return length;
+}
+
+static void decimal_out_init_powers(powers_t* powers, size_t width,
+                                    size_t thread_count) {
+  // One level per halving of threads, and one more for uneven halves
+  powers->count = 0;
+  if (thread_count > 1) {
+    powers->count = 1;
+    while (((size_t)1 << (powers->count - 1)) < thread_count &&
+           powers->count < MAX_POWERS) {
+      ++powers->count;
+    }
+  }
+  if (powers->count == 0) {
+    return;
+  }
+  // The largest power has about half of the digits of the number
+  const size_t first_digits =
+      (width + ((size_t)1 << powers->count) - 1) >> powers->count;
+  powers->digits[0] = first_digits > 0 ? first_digits : 1;
+  mpz_init(powers->values[0]);
+  mpz_ui_pow_ui(powers->values[0], 10, powers->digits[0]);
+  for (size_t level = 1; level < powers->count; ++level) {
+    powers->digits[level] = 2 * powers->digits[level - 1];
+    mpz_init(powers->values[level]);
+    mpz_mul(powers->values[level], powers->values[level - 1],
+            powers->values[level - 1]);
+  }
+}
+
+static bool decimal_out_convert(const powers_t* powers, mpz_srcptr number,
+                                char* digits, size_t width,
+                                size_t thread_count) {
+  // Largest power with fewer digits than the number
+  size_t level = powers->count;
+  while (level > 0 && powers->digits[level - 1] >= width) {
+    --level;
+  }
+  if (thread_count <= 1 || level == 0) {
+    return decimal_out_convert_serial(number, digits, width);
+  }
+  --level;
+  const size_t low_width = powers->digits[level];
+  part_t high;
+  high.digits = digits;
+  high.width = width - low_width;
+  high.powers = powers;
+  high.failed = false;
+  // Threads for each half, in proportion to its digits
+  high.thread_count = thread_count * high.width / width;
+  if (high.thread_count == 0) {
+    high.thread_count = 1;
+  } else if (high.thread_count == thread_count) {
+    high.thread_count = thread_count - 1;
+  }
+  mpz_t low;
+  mpz_init(high.number);
+  mpz_init(low);
+  mpz_tdiv_qr(high.number, low, number, powers->values[level]);
+  pthread_t thread;
+  const bool created =
+      pthread_create(&thread, NULL, decimal_out_run_part, &high) == 0;
+  if (!created) {
+    // The calling thread converts both halves
+    decimal_out_run_part(&high);
+  }
+  const bool converted =
+      decimal_out_convert(powers, low, digits + high.width, low_width,
+                          thread_count - high.thread_count);
+  mpz_clear(low);
+  if (created) {
+    pthread_join(thread, NULL);
+  }
+  mpz_clear(high.number);
+  return converted && !high.failed;
+}
+
+static bool decimal_out_convert_serial(mpz_srcptr number, char* digits,
+                                       size_t width) {
+  const mp_size_t limb_count = mpz_size(number);
+  size_t length = 0;
+  size_t first = 0;
+  mp_limb_t* limbs = NULL;
+  unsigned char* values = NULL;
+  if (limb_count > 0) {
+    // mpn_get_str overwrites its limbs, and needs room for the largest
+    // number of limb_count limbs plus one. 1234 / 4096 > log10(2)
+    const size_t capacity = ((limb_count * GMP_NUMB_BITS * 1234) >> 12) + 2;
+    limbs = malloc(limb_count * sizeof(mp_limb_t) + capacity);
+    if (limbs == NULL) {
+      fprintf(stderr, "%s", "error: cannot allocate digits\n");
+      return false;
+    }
+    values = (unsigned char*)(limbs + limb_count);
+    mpn_copyi(limbs, mpz_limbs_read(number), limb_count);
+    length = mpn_get_str(values, 10, limbs, limb_count);
+    while (first < length && values[first] == 0) {
+      ++first;
+    }
+  }
+  assert(length - first <= width);
+  const size_t padding = width - (length - first);
+  memset(digits, '0', padding);
+  for (size_t index = first; index < length; ++index) {
+    digits[padding + index - first] = (char)('0' + values[index]);
+  }
+  free(limbs);
+  return true;
+}
+
+static void* decimal_out_run_part(void* data) {
+  part_t* part = (part_t*)data;
+  part->failed = !decimal_out_convert(part->powers, part->number,
+                                      part->digits, part->width,
+                                      part->thread_count);
+  return NULL;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file decimal_out.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Parallel decimal output of big integers. Header.
+ * @version 1.0.0
+ * @date 2022-07-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef DECIMAL_OUT_H
+#define DECIMAL_OUT_H
+
+#include <gmp.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/// Numbers with fewer digits are converted by the calling thread only
+#define DECIMAL_OUT_PARALLEL_DIGITS 100000
+
+/**
+ * @brief Bytes of a buffer for the decimal digits of a number, its sign and
+ * a null character.
+ *
+ * @param number Number
+ * @return Byte count
+ */
+static inline size_t decimal_out_size(mpz_srcptr number) {
+  return mpz_sizeinbase(number, 10) + 2;
+}
+
+/**
+ * @brief Write a number in base 10 into a buffer, as mpz_get_str.
+ * @remark The number is split in a high and a low half by a power of ten,
+ * and threads convert both halves at once, each one into its own range of
+ * the buffer, with the low half padded with zeros. Halves are split again
+ * while there are threads for them, and then converted with mpn_get_str.
+ * Powers are 10^(d * 2^i) for a d such that the largest one has about half
+ * of the digits of the number, so they are computed by repeated squaring.
+ *
+ * @param buffer Buffer of at least decimal_out_size(number) bytes
+ * @param number Number
+ * @param thread_count Threads, including the calling one. If 0, one per CPU
+ * @return Length of the string written, without its null character, or 0 if
+ * memory could not be allocated
+ */
+size_t decimal_out_get_str(char* buffer, mpz_srcptr number,
+                           size_t thread_count);
+
+/**
+ * @brief Print a number in base 10, as mpz_out_str, with threads.
+ *
+ * @see decimal_out_get_str
+ * @param output Output stream
+ * @param number Number
+ * @param thread_count Threads, including the calling one. If 0, one per CPU
+ * @return Bytes written, or 0 on error
+ */
+size_t decimal_out_str(FILE* output, mpz_srcptr number, size_t thread_count);
+
+#endif  // DECIMAL_OUT_H
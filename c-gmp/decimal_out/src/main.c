@@ -0,0 +1,49 @@
+/**
+ * @file main.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Prints in base 10 the numbers read from standard input, in any base
+ * that mpz_inp_str detects, or the power base^exponent.
+ * @version 1.0.0
+ * @date 2022-07-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "decimal_out.h"
+
+int main(int argc, char* argv[]) {
+  size_t thread_count = 0;
+  unsigned long base = 0, exponent = 0;
+  if ((argc >= 2 && sscanf(argv[1], "%zu", &thread_count) != 1) ||
+      (argc == 3 || argc > 4) ||
+      (argc == 4 && (sscanf(argv[2], "%lu", &base) != 1 ||
+                     sscanf(argv[3], "%lu", &exponent) != 1))) {
+    fprintf(stderr, "usage: %s [thread_count [base exponent]] < numbers\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  int error = EXIT_SUCCESS;
+  mpz_t number;
+  mpz_init(number);
+  if (argc == 4) {
+    mpz_ui_pow_ui(number, base, exponent);
+    if (decimal_out_str(stdout, number, thread_count) == 0) {
+      error = EXIT_FAILURE;
+    }
+    printf("\n");
+  } else {
+    while (error == EXIT_SUCCESS && mpz_inp_str(number, stdin, 0)) {
+      if (decimal_out_str(stdout, number, thread_count) == 0) {
+        error = EXIT_FAILURE;
+      }
+      printf("\n");
+    }
+  }
+  mpz_clear(number);
+  return error;
+}
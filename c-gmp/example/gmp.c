@@ -3,6 +3,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "decimal_out.h"
+
 /// Test basic operations: +, -, *, div, mod
 void test_operations(mpz_t num1, mpz_t num2);
 /// Prints num1 operator num2 == result
@@ -74,10 +76,10 @@ void test_operations(mpz_t num1, mpz_t num2) {
 }
 
 void print_result(mpz_t num1, const char* operator, mpz_t num2, mpz_t result) {
-  mpz_out_str(stdout, /*base*/ 10, num1);
+  decimal_out_str(stdout, num1, /*thread_count*/ 0);
   fprintf(stdout, " %s ", operator);
-  mpz_out_str(stdout, /*base*/ 10, num2);
+  decimal_out_str(stdout, num2, /*thread_count*/ 0);
   fprintf(stdout, " == ");
-  mpz_out_str(stdout, /*base*/ 10, result);
+  decimal_out_str(stdout, result, /*thread_count*/ 0);
   fprintf(stdout, "\n");
 }
@@ -0,0 +1,15 @@
+# Benchmarks. Each bench/*.c file is a program linked with the limb_file
+# objects, except the one that contains the main program.
+BENCH_DIR=bench
+BENCHSRC=$(wildcard $(BENCH_DIR)/*.c)
+BENCHEXE=$(BENCHSRC:$(BENCH_DIR)/%.c=$(BIN_DIR)/%)
+BENCHOBJ=$(filter-out $(OBJ_DIR)/main.o,$(OBJECTS))
+
+.PHONY: bench
+# Seconds to save and load text and limb files, as CSV
+bench: FLAGS += -O3 -DNDEBUG
+bench: $(BENCHEXE)
+	$(BIN_DIR)/bench_limb_file $(BENCHARGS)
+
+$(BENCHEXE): $(BIN_DIR)/%: $(BENCH_DIR)/%.c $(BENCHOBJ) | $(BIN_DIR)/.
+	$(CC) $(FLAGC) $(INCLUDE) $^ -o $@ $(LIBS)
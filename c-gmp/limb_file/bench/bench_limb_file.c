@@ -0,0 +1,257 @@
+/**
+ * @file bench_limb_file.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Benchmark of limb files against decimal text files.
+ * @details For arrays of many small numbers, some medium ones and a few
+ * large ones, times saving them as decimal text with mpz_out_str and as a
+ * limb file, and loading them back with mpz_inp_str, with limb_file_read,
+ * with limb_file_map, and with limb_file_map reading every limb. Every
+ * loaded array is compared to the saved one. Prints a CSV row per array,
+ * operation and format, with file bytes, seconds and megabytes per second.
+ * Files are written to /tmp and are usually in the page cache, so times
+ * are those of conversion and copies, not of disks.
+ * @version 1.0.0
+ * @date 2022-07-25
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <gmp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "limb_file.h"
+
+/// Seed of random numbers, so every run uses the same ones
+#define RANDOM_SEED 2022
+
+/// Arrays benchmarked if none is given as arguments: count and limbs
+static const size_t default_shapes[][2] = {
+    {1000000, 1},
+    {10000, 100},
+    {10, 100000},
+};
+
+double get_duration(struct timespec stop_time, struct timespec start_time);
+
+/**
+ * @brief Save and load an array of random numbers in both formats.
+ *
+ * @param count Number count
+ * @param limbs Limbs of each number
+ * @param random Random state
+ * @return Error code
+ */
+int bench_shape(size_t count, size_t limbs, gmp_randstate_t random);
+
+/**
+ * @brief Check that loaded numbers are the saved ones.
+ *
+ * @param expected Saved numbers
+ * @param numbers Loaded numbers
+ * @param count Number count
+ * @return Error code
+ */
+int check_numbers(mpz_t expected[], mpz_t numbers[], size_t count);
+
+/// Print a CSV row
+void print_row(size_t count, size_t limbs, const char* operation,
+               const char* format, const char* path, double seconds);
+
+int main(int argc, char* argv[]) {
+  size_t count = 0, limbs = 0;
+  if (argc == 2 || argc > 3 ||
+      (argc == 3 && (sscanf(argv[1], "%zu", &count) != 1 ||
+                     sscanf(argv[2], "%zu", &limbs) != 1 || count == 0 ||
+                     limbs == 0))) {
+    fprintf(stderr, "usage: %s [count limbs]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  gmp_randstate_t random;
+  gmp_randinit_default(random);
+  gmp_randseed_ui(random, RANDOM_SEED);
+  int error = EXIT_SUCCESS;
+  printf("numbers,limbs,operation,format,bytes,seconds,mb_per_second\n");
+  if (argc == 3) {
+    error = bench_shape(count, limbs, random);
+  } else {
+    const size_t shape_count =
+        sizeof(default_shapes) / sizeof(default_shapes[0]);
+    for (size_t shape = 0; shape < shape_count && !error; ++shape) {
+      error = bench_shape(default_shapes[shape][0], default_shapes[shape][1],
+                          random);
+    }
+  }
+  gmp_randclear(random);
+  return error;
+}
+
+int bench_shape(size_t count, size_t limbs, gmp_randstate_t random) {
+  mpz_t* numbers = malloc(count * sizeof(mpz_t));
+  mpz_t* loaded = malloc(count * sizeof(mpz_t));
+  char text_path[] = "/tmp/bench_limb_file_text_XXXXXX";
+  char limb_path[] = "/tmp/bench_limb_file_limbs_XXXXXX";
+  const int text_fd = mkstemp(text_path);
+  const int limb_fd = mkstemp(limb_path);
+  if (numbers == NULL || loaded == NULL || text_fd < 0 || limb_fd < 0) {
+    fprintf(stderr, "%s", "error: cannot allocate numbers or files\n");
+    free(numbers);
+    free(loaded);
+    return EXIT_FAILURE;
+  }
+  close(text_fd);
+  close(limb_fd);
+  for (size_t index = 0; index < count; ++index) {
+    mpz_init(numbers[index]);
+    mpz_urandomb(numbers[index], random, limbs * mp_bits_per_limb);
+    if (index % 2) {
+      mpz_neg(numbers[index], numbers[index]);
+    }
+  }
+  int error = EXIT_SUCCESS;
+  struct timespec start, stop;
+
+  // Save as decimal text
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  FILE* file = fopen(text_path, "w");
+  for (size_t index = 0; file && index < count; ++index) {
+    mpz_out_str(file, 10, numbers[index]);
+    fputc('\n', file);
+  }
+  if (file == NULL || fclose(file) != 0) {
+    error = EXIT_FAILURE;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  print_row(count, limbs, "save", "text", text_path,
+            get_duration(stop, start));
+
+  // Save as limb file
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  file = fopen(limb_path, "wb");
+  if (file == NULL || limb_file_write(file, numbers, count) != EXIT_SUCCESS) {
+    error = EXIT_FAILURE;
+  }
+  if (file && fclose(file) != 0) {
+    error = EXIT_FAILURE;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  print_row(count, limbs, "save", "limbs", limb_path,
+            get_duration(stop, start));
+
+  // Load decimal text
+  if (!error) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    file = fopen(text_path, "r");
+    size_t index = 0;
+    for (; file && index < count; ++index) {
+      mpz_init(loaded[index]);
+      if (mpz_inp_str(loaded[index], file, 10) == 0) {
+        ++index;
+        error = EXIT_FAILURE;
+        break;
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    if (file) {
+      fclose(file);
+    } else {
+      error = EXIT_FAILURE;
+    }
+    if (!error) {
+      print_row(count, limbs, "load", "text", text_path,
+                get_duration(stop, start));
+      error = check_numbers(numbers, loaded, count);
+    }
+    for (size_t cleared = 0; cleared < index; ++cleared) {
+      mpz_clear(loaded[cleared]);
+    }
+  }
+
+  // Load limb file, copying limbs
+  if (!error) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    file = fopen(limb_path, "rb");
+    mpz_t* read_numbers = NULL;
+    size_t read_count = 0;
+    error = file ? limb_file_read(file, &read_numbers, &read_count)
+                 : EXIT_FAILURE;
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    if (file) {
+      fclose(file);
+    }
+    if (!error) {
+      print_row(count, limbs, "load", "limbs", limb_path,
+                get_duration(stop, start));
+      error = read_count == count
+                  ? check_numbers(numbers, read_numbers, count)
+                  : EXIT_FAILURE;
+      limb_file_free_numbers(read_numbers, read_count);
+    }
+  }
+
+  // Map limb file. Pages are only read when limbs are used, so it is timed
+  // again reading every limb
+  for (int touched = 0; touched < 2 && !error; ++touched) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    limb_file_map_t map;
+    error = limb_file_map(&map, limb_path);
+    volatile mp_limb_t sum = 0;
+    for (size_t index = 0; !error && touched && index < map.count; ++index) {
+      const mp_limb_t* limbs_read = mpz_limbs_read(map.numbers[index]);
+      for (size_t limb = 0; limb < mpz_size(map.numbers[index]); ++limb) {
+        sum += limbs_read[limb];
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    if (!error) {
+      print_row(count, limbs, "load", touched ? "mmap_read" : "mmap",
+                limb_path, get_duration(stop, start));
+      error = map.count == count
+                  ? check_numbers(numbers, map.numbers, count)
+                  : EXIT_FAILURE;
+      limb_file_unmap(&map);
+    }
+  }
+  if (error) {
+    fprintf(stderr, "error: %zu numbers of %zu limbs differ\n", count, limbs);
+  }
+  unlink(text_path);
+  unlink(limb_path);
+  for (size_t index = 0; index < count; ++index) {
+    mpz_clear(numbers[index]);
+  }
+  free(numbers);
+  free(loaded);
+  return error;
+}
+
+int check_numbers(mpz_t expected[], mpz_t numbers[], size_t count) {
+  for (size_t index = 0; index < count; ++index) {
+    if (mpz_cmp(expected[index], numbers[index]) != 0) {
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+void print_row(size_t count, size_t limbs, const char* operation,
+               const char* format, const char* path, double seconds) {
+  struct stat status;
+  const size_t bytes = stat(path, &status) == 0 ? (size_t)status.st_size : 0;
+  printf("%zu,%zu,%s,%s,%zu,%.6f,%.3f\n", count, limbs, operation, format,
+         bytes, seconds, 1e-6 * bytes / seconds);
+  fflush(stdout);
+}
+
+// https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
+double get_duration(struct timespec stop_time, struct timespec start_time) {
+  return (stop_time.tv_sec + 1e-9 * stop_time.tv_nsec) -
+         (start_time.tv_sec + 1e-9 * start_time.tv_nsec);
+}
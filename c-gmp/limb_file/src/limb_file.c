@@ -0,0 +1,245 @@
+/**
+ * @file limb_file.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Binary files of big integers stored as their limbs. Implementation.
+ * @version 1.0.0
+ * @date 2022-07-25
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "limb_file.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Bytes of the limbs of a number, padded to LIMB_FILE_ALIGNMENT
+static inline size_t limb_file_padded_bytes(uint64_t limb_count) {
+  return (limb_count * sizeof(mp_limb_t) + LIMB_FILE_ALIGNMENT - 1) &
+         ~(size_t)(LIMB_FILE_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Check that a header was written by a machine with the same limbs.
+ *
+ * @param header Header
+ * @param available Bytes after the header, to bound the number count
+ * @return Error code
+ */
+static int limb_file_check_header(const limb_file_header_t* header,
+                                  size_t available);
+
+/**
+ * @brief Check that a record is consistent and its limbs fit in the file.
+ *
+ * @param record Record
+ * @param available Bytes after the record
+ * @return Error code
+ */
+static int limb_file_check_record(const limb_file_record_t* record,
+                                  size_t available);
+
+int limb_file_write(FILE* output, mpz_t numbers[], size_t count) {
+  assert(output);
+  static const char padding[LIMB_FILE_ALIGNMENT] = {0};
+  limb_file_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, LIMB_FILE_MAGIC, sizeof(header.magic));
+  header.version = LIMB_FILE_VERSION;
+  header.limb_bytes = sizeof(mp_limb_t);
+  header.nail_bits = GMP_NAIL_BITS;
+  header.byte_order = LIMB_FILE_BYTE_ORDER;
+  header.count = count;
+  bool written = fwrite(&header, sizeof(header), 1, output) == 1;
+  for (size_t index = 0; written && index < count; ++index) {
+    const limb_file_record_t record = {mpz_size(numbers[index]),
+                                       mpz_sgn(numbers[index]), 0};
+    const size_t bytes = record.limb_count * sizeof(mp_limb_t);
+    written = fwrite(&record, sizeof(record), 1, output) == 1 &&
+              fwrite(mpz_limbs_read(numbers[index]), 1, bytes, output) ==
+                  bytes;
+    const size_t padding_bytes = limb_file_padded_bytes(record.limb_count) -
+                                 bytes;
+    if (written && padding_bytes > 0) {
+      written = fwrite(padding, 1, padding_bytes, output) == padding_bytes;
+    }
+  }
+  if (!written || fflush(output) != 0) {
+    fprintf(stderr, "%s", "error: cannot write limb file\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+int limb_file_read(FILE* input, mpz_t** numbers, size_t* count) {
+  assert(input);
+  assert(numbers);
+  assert(count);
+  *numbers = NULL;
+  *count = 0;
+  // Bound counts with the size of regular files, so an invalid count does
+  // not allocate more memory than the file could need
+  size_t available = SIZE_MAX;
+  struct stat status;
+  const long position = ftell(input);
+  if (fstat(fileno(input), &status) == 0 && S_ISREG(status.st_mode) &&
+      position >= 0 && status.st_size >= position) {
+    available = status.st_size - position;
+  }
+  limb_file_header_t header;
+  if (fread(&header, sizeof(header), 1, input) != 1 ||
+      limb_file_check_header(&header, available - sizeof(header)) !=
+          EXIT_SUCCESS) {
+    fprintf(stderr, "%s", "error: invalid limb file\n");
+    return EXIT_FAILURE;
+  }
+  available -= sizeof(header);
+  mpz_t* read_numbers = malloc((header.count > 0 ? header.count : 1) *
+                               sizeof(mpz_t));
+  if (read_numbers == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate numbers\n");
+    return EXIT_FAILURE;
+  }
+  size_t read_count = 0;
+  bool valid = true;
+  for (; valid && read_count < header.count; ++read_count) {
+    limb_file_record_t record;
+    valid = fread(&record, sizeof(record), 1, input) == 1 &&
+            limb_file_check_record(&record, available - sizeof(record)) ==
+                EXIT_SUCCESS;
+    if (!valid) {
+      break;
+    }
+    available -= sizeof(record) + limb_file_padded_bytes(record.limb_count);
+    // Limbs are copied from the file into the number, without conversion
+    mpz_ptr number = read_numbers[read_count];
+    mpz_init(number);
+    if (record.limb_count > 0) {
+      mp_limb_t* limbs = mpz_limbs_write(number, record.limb_count);
+      valid = fread(limbs, sizeof(mp_limb_t), record.limb_count, input) ==
+              record.limb_count;
+      const mp_size_t size = record.sign * (mp_size_t)record.limb_count;
+      mpz_limbs_finish(number, valid ? size : 0);
+    }
+    const size_t padding_bytes = limb_file_padded_bytes(record.limb_count) -
+                                 record.limb_count * sizeof(mp_limb_t);
+    char padding[LIMB_FILE_ALIGNMENT];
+    if (valid && padding_bytes > 0) {
+      valid = fread(padding, 1, padding_bytes, input) == padding_bytes;
+    }
+  }
+  if (!valid) {
+    fprintf(stderr, "%s", "error: invalid limb file\n");
+    limb_file_free_numbers(read_numbers, read_count);
+    return EXIT_FAILURE;
+  }
+  *numbers = read_numbers;
+  *count = read_count;
+  return EXIT_SUCCESS;
+}
+
+void limb_file_free_numbers(mpz_t* numbers, size_t count) {
+  for (size_t index = 0; index < count; ++index) {
+    mpz_clear(numbers[index]);
+  }
+  free(numbers);
+}
+
+int limb_file_map(limb_file_map_t* map, const char* path) {
+  assert(map);
+  assert(path);
+  memset(map, 0, sizeof(*map));
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "error: cannot open %s\n", path);
+    return EXIT_FAILURE;
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0 ||
+      status.st_size < (off_t)sizeof(limb_file_header_t)) {
+    fprintf(stderr, "error: invalid limb file %s\n", path);
+    close(fd);
+    return EXIT_FAILURE;
+  }
+  map->size = status.st_size;
+  map->data = mmap(NULL, map->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map->data == MAP_FAILED) {
+    fprintf(stderr, "error: cannot map %s\n", path);
+    map->data = NULL;
+    return EXIT_FAILURE;
+  }
+  const limb_file_header_t* header = (const limb_file_header_t*)map->data;
+  size_t offset = sizeof(limb_file_header_t);
+  bool valid =
+      limb_file_check_header(header, map->size - offset) == EXIT_SUCCESS;
+  if (valid) {
+    map->count = header->count;
+    map->numbers = malloc((map->count > 0 ? map->count : 1) * sizeof(mpz_t));
+    valid = map->numbers != NULL;
+  }
+  // Numbers point to their limbs in the map
+  for (size_t index = 0; valid && index < map->count; ++index) {
+    const limb_file_record_t* record =
+        (const limb_file_record_t*)((const char*)map->data + offset);
+    offset += sizeof(limb_file_record_t);
+    valid = offset <= map->size &&
+            limb_file_check_record(record, map->size - offset) ==
+                EXIT_SUCCESS;
+    if (valid) {
+      mpz_roinit_n(map->numbers[index],
+                   (const mp_limb_t*)((const char*)map->data + offset),
+                   record->sign * (mp_size_t)record->limb_count);
+      offset += limb_file_padded_bytes(record->limb_count);
+    }
+  }
+  if (!valid) {
+    fprintf(stderr, "error: invalid limb file %s\n", path);
+    limb_file_unmap(map);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+void limb_file_unmap(limb_file_map_t* map) {
+  assert(map);
+  if (map->data) {
+    munmap(map->data, map->size);
+  }
+  free(map->numbers);
+  memset(map, 0, sizeof(*map));
+}
+
+static int limb_file_check_header(const limb_file_header_t* header,
+                                  size_t available) {
+  if (memcmp(header->magic, LIMB_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != LIMB_FILE_VERSION ||
+      header->limb_bytes != sizeof(mp_limb_t) ||
+      header->nail_bits != GMP_NAIL_BITS ||
+      header->byte_order != LIMB_FILE_BYTE_ORDER ||
+      header->count > available / sizeof(limb_file_record_t)) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+static int limb_file_check_record(const limb_file_record_t* record,
+                                  size_t available) {
+  if (record->sign < -1 || record->sign > 1 ||
+      (record->sign == 0) != (record->limb_count == 0) ||
+      record->limb_count > INT_MAX ||
+      limb_file_padded_bytes(record->limb_count) > available) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file limb_file.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Binary files of big integers stored as their limbs. Header.
+ * @version 1.0.0
+ * @date 2022-07-25
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef LIMB_FILE_H
+#define LIMB_FILE_H
+
+#include <gmp.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/// First bytes of a limb file
+#define LIMB_FILE_MAGIC "GMPLIMBS"
+
+/// Version of the format
+#define LIMB_FILE_VERSION 1
+
+/// Written in the byte order of the machine, to detect other byte orders
+#define LIMB_FILE_BYTE_ORDER 0x01020304
+
+/// Records and limbs start at multiples of this many bytes
+#define LIMB_FILE_ALIGNMENT 8
+
+/**
+ * @brief Header at the start of a limb file.
+ * @remark Files are only read by machines with the same limb size, nails and
+ * byte order that wrote them, since limbs are stored as they are in memory.
+ *
+ */
+typedef struct limb_file_header {
+  /// LIMB_FILE_MAGIC, without null character
+  char magic[8];
+  /// LIMB_FILE_VERSION
+  uint32_t version;
+  /// sizeof(mp_limb_t)
+  uint16_t limb_bytes;
+  /// GMP_NAIL_BITS
+  uint16_t nail_bits;
+  /// LIMB_FILE_BYTE_ORDER
+  uint32_t byte_order;
+  /// Zero
+  uint32_t reserved;
+  /// Number count
+  uint64_t count;
+} limb_file_header_t;
+
+/**
+ * @brief Record before the limbs of each number.
+ * @remark Limbs follow the record, the least significant first, as
+ * mpz_limbs_read returns them. Then zeros up to a multiple of
+ * LIMB_FILE_ALIGNMENT bytes.
+ *
+ */
+typedef struct limb_file_record {
+  /// Limb count, without high zero limbs
+  uint64_t limb_count;
+  /// -1, 0 or 1, as mpz_sgn. 0 if and only if limb_count is 0
+  int32_t sign;
+  /// Zero
+  uint32_t reserved;
+} limb_file_record_t;
+
+/**
+ * @brief Numbers of a limb file mapped to memory.
+ *
+ */
+typedef struct limb_file_map {
+  /// Mapped file
+  void* data;
+  /// Bytes of file
+  size_t size;
+  /// Number count
+  size_t count;
+  /// Read-only numbers whose limbs are in the mapped file
+  mpz_t* numbers;
+} limb_file_map_t;
+
+/**
+ * @brief Write numbers to a limb file.
+ *
+ * @param output Output stream, opened in binary mode
+ * @param numbers Numbers
+ * @param count Number count
+ * @return Error code
+ */
+int limb_file_write(FILE* output, mpz_t numbers[], size_t count);
+
+/**
+ * @brief Read the numbers of a limb file, copying their limbs.
+ *
+ * @param input Input stream, opened in binary mode
+ * @param numbers Where an array of initialized numbers is stored. It must be
+ * released with limb_file_free_numbers
+ * @param count Where the number count is stored
+ * @return Error code
+ */
+int limb_file_read(FILE* input, mpz_t** numbers, size_t* count);
+
+/**
+ * @brief Clear and free numbers read by limb_file_read.
+ *
+ * @param numbers Numbers
+ * @param count Number count
+ */
+void limb_file_free_numbers(mpz_t* numbers, size_t count);
+
+/**
+ * @brief Map a limb file to memory, and expose its numbers without copying
+ * their limbs, with mpz_roinit_n.
+ * @remark Numbers of the map can only be read. They must not be modified,
+ * cleared, or used after limb_file_unmap.
+ *
+ * @param map Map to initialize
+ * @param path Path of limb file
+ * @return Error code
+ */
+int limb_file_map(limb_file_map_t* map, const char* path);
+
+/**
+ * @brief Unmap a limb file.
+ *
+ * @param map Map
+ */
+void limb_file_unmap(limb_file_map_t* map);
+
+#endif  // LIMB_FILE_H
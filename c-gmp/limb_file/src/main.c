@@ -0,0 +1,112 @@
+/**
+ * @file main.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Writes numbers read from standard input to a limb file, or prints
+ * the numbers of a limb file.
+ * @version 1.0.0
+ * @date 2022-07-25
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gmp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "limb_file.h"
+
+/// Numbers of the first allocation of the array of read numbers
+#define INITIAL_CAPACITY 1024
+
+/**
+ * @brief Write the numbers of standard input, in any base that mpz_inp_str
+ * detects, to a limb file.
+ *
+ * @param path Path of limb file
+ * @return Error code
+ */
+int write_numbers(const char* path);
+
+/**
+ * @brief Print the numbers of a limb file, mapped to memory.
+ *
+ * @param path Path of limb file
+ * @param base Base of printed numbers
+ * @return Error code
+ */
+int print_numbers(const char* path, int base);
+
+int main(int argc, char* argv[]) {
+  int base = 10;
+  if (argc >= 3 && strcmp(argv[1], "write") == 0 && argc == 3) {
+    return write_numbers(argv[2]);
+  }
+  if (argc >= 3 && strcmp(argv[1], "read") == 0 &&
+      (argc == 3 || (argc == 4 && sscanf(argv[3], "%d", &base) == 1 &&
+                     base >= 2 && base <= 62))) {
+    return print_numbers(argv[2], base);
+  }
+  fprintf(stderr,
+          "usage: %s write file < numbers\n"
+          "       %s read file [base]\n",
+          argv[0], argv[0]);
+  return EXIT_FAILURE;
+}
+
+int write_numbers(const char* path) {
+  int error = EXIT_SUCCESS;
+  size_t count = 0, capacity = INITIAL_CAPACITY;
+  mpz_t* numbers = malloc(capacity * sizeof(mpz_t));
+  if (numbers == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate numbers\n");
+    return EXIT_FAILURE;
+  }
+  while (true) {
+    if (count == capacity) {
+      mpz_t* grown = realloc(numbers, 2 * capacity * sizeof(mpz_t));
+      if (grown == NULL) {
+        fprintf(stderr, "%s", "error: cannot allocate numbers\n");
+        error = EXIT_FAILURE;
+        break;
+      }
+      numbers = grown;
+      capacity *= 2;
+    }
+    mpz_init(numbers[count]);
+    if (mpz_inp_str(numbers[count], stdin, 0) == 0) {
+      mpz_clear(numbers[count]);
+      break;
+    }
+    ++count;
+  }
+  if (error == EXIT_SUCCESS) {
+    FILE* output = fopen(path, "wb");
+    if (output == NULL) {
+      fprintf(stderr, "error: cannot create %s\n", path);
+      error = EXIT_FAILURE;
+    } else {
+      error = limb_file_write(output, numbers, count);
+      if (fclose(output) != 0) {
+        error = EXIT_FAILURE;
+      }
+    }
+  }
+  limb_file_free_numbers(numbers, count);
+  return error;
+}
+
+int print_numbers(const char* path, int base) {
+  limb_file_map_t map;
+  if (limb_file_map(&map, path) != EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+  for (size_t index = 0; index < map.count; ++index) {
+    mpz_out_str(stdout, base, map.numbers[index]);
+    printf("\n");
+  }
+  limb_file_unmap(&map);
+  return EXIT_SUCCESS;
+}
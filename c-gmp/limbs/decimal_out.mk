@@ -0,0 +1,9 @@
+# Parallel decimal output, compiled from the decimal_out project
+DECIMAL_OUT_DIR=../decimal_out/src
+INCLUDE += -I$(DECIMAL_OUT_DIR)
+OBJECTS += $(OBJ_DIR)/decimal_out.o
+
+$(OBJ_DIR)/decimal_out.o: $(DECIMAL_OUT_DIR)/decimal_out.c | $(OBJ_DIR)/.
+	$(CC) -c $(FLAGC) $(INCLUDE) -MMD $< -o $@
+
+-include $(OBJ_DIR)/decimal_out.d
@@ -0,0 +1,9 @@
+# Binary limb files, compiled from the limb_file project
+LIMB_FILE_DIR=../limb_file/src
+INCLUDE += -I$(LIMB_FILE_DIR)
+OBJECTS += $(OBJ_DIR)/limb_file.o
+
+$(OBJ_DIR)/limb_file.o: $(LIMB_FILE_DIR)/limb_file.c | $(OBJ_DIR)/.
+	$(CC) -c $(FLAGC) $(INCLUDE) -MMD $< -o $@
+
+-include $(OBJ_DIR)/limb_file.d
@@ -10,8 +10,13 @@
  */
 
 #include <gmp.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+
+#include "decimal_out.h"
+#include "limb_file.h"
 
 #define NUMBER_COUNT 3
 
@@ -19,12 +24,30 @@ void store_operands(mpz_t large_numbers[]);
 void print_multiplication(mpz_t large_numbers[]);
 void print_limbs(mpz_t large_numbers[]);
 
-int main(void) {
+int main(int argc, char* argv[]) {
   mpz_t large_numbers[NUMBER_COUNT];
-  for (size_t index = 0; index < NUMBER_COUNT; ++index) {
-    mpz_init(large_numbers[index]);
+  limb_file_map_t map;
+  const bool mapped = argc >= 2;
+  if (mapped) {
+    // Operands are read-only views of the limbs of the file, not copies
+    if (limb_file_map(&map, argv[1]) != EXIT_SUCCESS) {
+      return EXIT_FAILURE;
+    }
+    if (map.count < NUMBER_COUNT) {
+      fprintf(stderr, "error: %s has fewer than %d numbers\n", argv[1],
+              NUMBER_COUNT);
+      limb_file_unmap(&map);
+      return EXIT_FAILURE;
+    }
+    for (size_t index = 0; index < NUMBER_COUNT; ++index) {
+      *large_numbers[index] = *map.numbers[index];
+    }
+  } else {
+    for (size_t index = 0; index < NUMBER_COUNT; ++index) {
+      mpz_init(large_numbers[index]);
+    }
+    store_operands(large_numbers);
   }
-  store_operands(large_numbers);
   mpz_t large_result;
   mpz_init(large_result);
   mpz_mul(large_result, large_numbers[0], large_numbers[1]);
@@ -36,8 +59,12 @@ int main(void) {
     printf("error when multiplying large numbers\n");
   }
   mpz_clear(large_result);
-  for (size_t index = 0; index < NUMBER_COUNT; ++index) {
-    mpz_clear(large_numbers[index]);
+  if (mapped) {
+    limb_file_unmap(&map);
+  } else {
+    for (size_t index = 0; index < NUMBER_COUNT; ++index) {
+      mpz_clear(large_numbers[index]);
+    }
   }
   return 0;
 }
@@ -61,13 +88,13 @@ void store_operands(mpz_t large_numbers[]) {
 
 void print_multiplication(mpz_t large_numbers[]) {
   printf("%d bits per limb\n\n", mp_bits_per_limb);
-  mpz_out_str(stdout, 10, large_numbers[0]);
+  decimal_out_str(stdout, large_numbers[0], 0);
   printf("\n(%zu limbs, %zu bits)\n*\n", mpz_size(large_numbers[0]),
          mpz_sizeinbase(large_numbers[0], 2));
-  mpz_out_str(stdout, 10, large_numbers[1]);
+  decimal_out_str(stdout, large_numbers[1], 0);
   printf("\n(%zu limbs, %zu bits)\n==\n", mpz_size(large_numbers[1]),
          mpz_sizeinbase(large_numbers[1], 2));
-  mpz_out_str(stdout, 10, large_numbers[2]);
+  decimal_out_str(stdout, large_numbers[2], 0);
   printf("\n(%zu limbs, %zu bits)\n", mpz_size(large_numbers[2]),
          mpz_sizeinbase(large_numbers[2], 2));
   printf("\n");
@@ -76,7 +103,7 @@ void print_multiplication(mpz_t large_numbers[]) {
 void print_limbs(mpz_t large_numbers[]) {
   mp_size_t limb_count;
   for (size_t number_index = 0; number_index < NUMBER_COUNT; ++number_index) {
-    mpz_out_str(stdout, 10, large_numbers[number_index]);
+    decimal_out_str(stdout, large_numbers[number_index], 0);
     printf("\n==\n0x");
     mpz_out_str(stdout, 16, large_numbers[number_index]);
     printf("\nlimbs:\n");
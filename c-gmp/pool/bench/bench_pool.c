@@ -0,0 +1,264 @@
+/**
+ * @file bench_pool.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Benchmark of the pool against the default GMP memory functions on
+ * the workloads of arith_perf.
+ * @details Each operation of arith_perf (add, mul, divmod and powm) is timed
+ * with its results initialized and cleared in every iteration, as in
+ * test_operations of example/gmp.c, so each iteration allocates and frees
+ * memory. Operations run on one thread and on thread_count threads at once,
+ * first with the default memory functions and then with the pool. Prints a
+ * CSV row per memory functions, thread count, operation and size, with time
+ * per operation of each thread, operations per second of all threads, and
+ * allocations per operation and percentage of them served by the pool.
+ * @version 1.0.0
+ * @date 2022-07-04
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <gmp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gmp_pool.h"
+
+/// Largest operand size, in limbs
+#define DEFAULT_MAX_LIMBS 1000
+
+/// Minimum duration of a timed run, in seconds
+#define MIN_RUN_DURATION 0.05
+
+/// Seed of random operands, so every run uses the same ones
+#define RANDOM_SEED 2022
+
+/// Benchmarked operations
+enum operation { ADD, MUL, DIVMOD, POWM, OPERATION_COUNT };
+
+/// Names of operations
+static const char* const operation_names[] = {"add", "mul", "divmod",
+                                              "powm"};
+
+/// Operands of one size, read by all threads
+typedef struct operands {
+  mpz_t first;
+  mpz_t second;
+  /// Dividend of 2 * limbs limbs
+  mpz_t dividend;
+  /// Odd divisor, modulus of powm
+  mpz_t divisor;
+  /// One-limb exponent of powm
+  mpz_t exponent;
+} operands_t;
+
+/// Data shared by the threads of a run
+typedef struct shared_data {
+  operands_t* operands;
+  enum operation operation;
+  size_t iterations;
+} shared_data_t;
+
+double get_duration(struct timespec stop_time, struct timespec start_time);
+void operands_init(operands_t* operands, size_t limbs,
+                   gmp_randstate_t random);
+void operands_destroy(operands_t* operands);
+
+/**
+ * @brief Run iterations of an operation, initializing and clearing results
+ * in each one.
+ *
+ * @param operands Operands
+ * @param operation Operation
+ * @param iterations Iteration count
+ */
+void run_operation(operands_t* operands, enum operation operation,
+                   size_t iterations);
+
+/**
+ * @brief Run an operation on threads at once.
+ *
+ * @param shared_data Shared data
+ * @param thread_count Thread count
+ * @return Elapsed seconds, or a negative value on error
+ */
+double run_threads(shared_data_t* shared_data, size_t thread_count);
+
+void* run_thread(void* data);
+
+int main(int argc, char* argv[]) {
+  size_t max_limbs = DEFAULT_MAX_LIMBS;
+  const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t max_threads = cpu_count > 1 ? (size_t)cpu_count : 2;
+  if ((argc >= 2 && sscanf(argv[1], "%zu", &max_limbs) != 1) ||
+      (argc >= 3 && sscanf(argv[2], "%zu", &max_threads) != 1) ||
+      max_limbs == 0 || max_threads == 0) {
+    fprintf(stderr, "usage: %s [max_limbs] [thread_count]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  int error = EXIT_SUCCESS;
+  printf("allocator,threads,operation,limbs,iterations,ns_per_op,"
+         "mops_per_second,allocations_per_op,hit_percent\n");
+  for (int pooled = 0; pooled < 2 && error == EXIT_SUCCESS; ++pooled) {
+    // Operands are allocated by the memory functions being measured, since
+    // blocks must be freed by the functions that allocated them
+    if (pooled && gmp_pool_install(GMP_POOL_DEFAULT_CACHE_BYTES) !=
+                      EXIT_SUCCESS) {
+      error = EXIT_FAILURE;
+      break;
+    }
+    gmp_randstate_t random;
+    gmp_randinit_default(random);
+    gmp_randseed_ui(random, RANDOM_SEED);
+    for (size_t limbs = 1; limbs <= max_limbs && error == EXIT_SUCCESS;
+         limbs *= 10) {
+      operands_t operands;
+      operands_init(&operands, limbs, random);
+      for (int operation = 0; operation < OPERATION_COUNT; ++operation) {
+        // Iterations per thread: double them until one thread takes long
+        // enough
+        shared_data_t shared_data = {&operands, operation, 1};
+        struct timespec start, stop;
+        while (true) {
+          clock_gettime(CLOCK_MONOTONIC, &start);
+          run_operation(&operands, operation, shared_data.iterations);
+          clock_gettime(CLOCK_MONOTONIC, &stop);
+          if (get_duration(stop, start) >= MIN_RUN_DURATION) {
+            break;
+          }
+          shared_data.iterations *= 2;
+        }
+        const size_t thread_counts[] = {1, max_threads};
+        for (size_t index = 0; index < 2 && error == EXIT_SUCCESS; ++index) {
+          const size_t threads = thread_counts[index];
+          if (index == 1 && threads == 1) {
+            break;
+          }
+          if (pooled) {
+            gmp_pool_reset_stats();
+          }
+          const double elapsed = run_threads(&shared_data, threads);
+          if (elapsed < 0) {
+            error = EXIT_FAILURE;
+            break;
+          }
+          const double operations = (double)shared_data.iterations * threads;
+          printf("%s,%zu,%s,%zu,%zu,%.3f,%.3f,", pooled ? "pool" : "default",
+                 threads, operation_names[operation], limbs,
+                 shared_data.iterations,
+                 1e9 * elapsed / shared_data.iterations,
+                 1e-6 * operations / elapsed);
+          if (pooled) {
+            gmp_pool_stats_t stats;
+            gmp_pool_get_stats(&stats);
+            const double requests = stats.allocations + stats.reallocations;
+            printf("%.3f,%.2f\n", requests / operations,
+                   requests > 0 ? 100.0 * stats.hits / requests : 0.0);
+          } else {
+            printf(",\n");
+          }
+          fflush(stdout);
+        }
+      }
+      operands_destroy(&operands);
+    }
+    gmp_randclear(random);
+    if (pooled) {
+      gmp_pool_uninstall();
+    }
+  }
+  return error;
+}
+
+void operands_init(operands_t* operands, size_t limbs,
+                   gmp_randstate_t random) {
+  const mp_bitcnt_t bits = limbs * mp_bits_per_limb;
+  mpz_inits(operands->first, operands->second, operands->dividend,
+            operands->divisor, operands->exponent, NULL);
+  mpz_urandomb(operands->first, random, bits);
+  mpz_setbit(operands->first, bits - 1);
+  mpz_urandomb(operands->second, random, bits);
+  mpz_setbit(operands->second, bits - 1);
+  mpz_urandomb(operands->dividend, random, 2 * bits);
+  mpz_setbit(operands->dividend, 2 * bits - 1);
+  mpz_urandomb(operands->divisor, random, bits);
+  mpz_setbit(operands->divisor, bits - 1);
+  mpz_setbit(operands->divisor, 0);
+  mpz_urandomb(operands->exponent, random, mp_bits_per_limb);
+  mpz_setbit(operands->exponent, mp_bits_per_limb - 1);
+}
+
+void operands_destroy(operands_t* operands) {
+  mpz_clears(operands->first, operands->second, operands->dividend,
+             operands->divisor, operands->exponent, NULL);
+}
+
+void run_operation(operands_t* operands, enum operation operation,
+                   size_t iterations) {
+  mpz_t result, remainder;
+  for (size_t iteration = 0; iteration < iterations; ++iteration) {
+    mpz_init(result);
+    switch (operation) {
+      case ADD:
+        mpz_add(result, operands->first, operands->second);
+        break;
+      case MUL:
+        mpz_mul(result, operands->first, operands->second);
+        break;
+      case DIVMOD:
+        mpz_init(remainder);
+        mpz_tdiv_qr(result, remainder, operands->dividend, operands->divisor);
+        mpz_clear(remainder);
+        break;
+      default:
+        mpz_powm(result, operands->first, operands->exponent,
+                 operands->divisor);
+        break;
+    }
+    mpz_clear(result);
+  }
+}
+
+double run_threads(shared_data_t* shared_data, size_t thread_count) {
+  pthread_t* threads = malloc(thread_count * sizeof(pthread_t));
+  if (threads == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate threads\n");
+    return -1.0;
+  }
+  // Creating threads takes much less than a run, so it is timed too
+  struct timespec start, stop;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  size_t created = 0;
+  for (; created < thread_count; ++created) {
+    if (pthread_create(&threads[created], NULL, run_thread, shared_data) !=
+        0) {
+      fprintf(stderr, "error: cannot create thread %zu\n", created);
+      break;
+    }
+  }
+  for (size_t index = 0; index < created; ++index) {
+    pthread_join(threads[index], NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  free(threads);
+  return created == thread_count ? get_duration(stop, start) : -1.0;
+}
+
+void* run_thread(void* data) {
+  shared_data_t* shared_data = (shared_data_t*)data;
+  run_operation(shared_data->operands, shared_data->operation,
+                shared_data->iterations);
+  return NULL;
+}
+
+// https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
+double get_duration(struct timespec stop_time, struct timespec start_time) {
+  return (stop_time.tv_sec + 1e-9 * stop_time.tv_nsec) -
+         (start_time.tv_sec + 1e-9 * start_time.tv_nsec);
+}
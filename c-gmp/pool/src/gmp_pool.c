@@ -0,0 +1,394 @@
+/**
+ * @file gmp_pool.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Thread-local size-class pool for GMP memory. Implementation.
+ * @version 1.0.0
+ * @date 2022-07-04
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "gmp_pool.h"
+
+#include <assert.h>
+#include <gmp.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Number of block sizes, powers of two from min to max block
+#define CLASS_COUNT 13
+
+/**
+ * @brief Free block, linked to the next free block of the same size.
+ *
+ */
+typedef struct gmp_pool_block {
+  struct gmp_pool_block* next;
+} gmp_pool_block_t;
+
+/**
+ * @brief Counters of a thread. Only the owner thread updates them, but any
+ * thread may read them, so they are atomic with relaxed order.
+ *
+ */
+typedef struct gmp_pool_counters {
+  atomic_uint_least64_t allocations;
+  atomic_uint_least64_t reallocations;
+  atomic_uint_least64_t frees;
+  atomic_uint_least64_t hits;
+  atomic_uint_least64_t misses;
+  atomic_uint_least64_t bytes_requested;
+  atomic_int_least64_t bytes_in_use;
+  atomic_uint_least64_t bytes_cached;
+} gmp_pool_counters_t;
+
+/**
+ * @brief Free blocks and counters of a thread.
+ *
+ */
+typedef struct gmp_pool_cache {
+  /// Free blocks of each size
+  gmp_pool_block_t* free_lists[CLASS_COUNT];
+  /// Bytes of free blocks
+  size_t cached_bytes;
+  /// Counters
+  gmp_pool_counters_t counters;
+  /// Next cache of the registry
+  struct gmp_pool_cache* next;
+} gmp_pool_cache_t;
+
+/// Memory functions installed before the pool
+static void* (*previous_allocate)(size_t);
+static void* (*previous_reallocate)(void*, size_t, size_t);
+static void (*previous_free)(void*, size_t);
+
+/// Bytes of free blocks that each thread keeps
+static size_t max_cached_bytes;
+
+/// Cache of the calling thread, NULL until it allocates
+static _Thread_local gmp_pool_cache_t* thread_cache;
+
+/// Key whose destructor releases the cache of an exiting thread
+static pthread_key_t cache_key;
+static pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+static int cache_key_error;
+
+/// Protects registry, retired and baseline
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+/// Caches of running threads
+static gmp_pool_cache_t* registry;
+/// Counters of exited threads
+static gmp_pool_stats_t retired;
+/// Counters when statistics were reset
+static gmp_pool_stats_t baseline;
+
+static void* gmp_pool_allocate(size_t size);
+static void* gmp_pool_reallocate(void* pointer, size_t old_size,
+                                 size_t new_size);
+static void gmp_pool_free(void* pointer, size_t size);
+
+/**
+ * @brief Add to a counter of the calling thread. A relaxed load and store is
+ * enough, since no other thread writes it.
+ *
+ * @param counter Counter
+ * @param value Value to add, it may be negative for signed counters
+ */
+static inline void gmp_pool_count(atomic_uint_least64_t* counter,
+                                  uint64_t value) {
+  atomic_store_explicit(
+      counter, atomic_load_explicit(counter, memory_order_relaxed) + value,
+      memory_order_relaxed);
+}
+
+static inline void gmp_pool_count_signed(atomic_int_least64_t* counter,
+                                         int64_t value) {
+  atomic_store_explicit(
+      counter, atomic_load_explicit(counter, memory_order_relaxed) + value,
+      memory_order_relaxed);
+}
+
+/**
+ * @brief Get the size class of a pooled request.
+ *
+ * @param size Bytes, at most GMP_POOL_MAX_BLOCK
+ * @return Class index, block size is GMP_POOL_MIN_BLOCK << class
+ */
+static inline size_t gmp_pool_class(size_t size) {
+  assert(size <= GMP_POOL_MAX_BLOCK);
+  if (size <= GMP_POOL_MIN_BLOCK) {
+    return 0;
+  }
+  // Bits of size - 1 is log2 of size rounded up
+  return 8 * sizeof(unsigned long) - __builtin_clzl(size - 1) - 4;
+}
+
+/**
+ * @brief Get the bytes of the block that serves a request.
+ *
+ * @param size Bytes requested
+ * @return Block size of the class of size, or size if it is not pooled
+ */
+static inline size_t gmp_pool_block_size(size_t size) {
+  return size > GMP_POOL_MAX_BLOCK
+             ? size
+             : (size_t)GMP_POOL_MIN_BLOCK << gmp_pool_class(size);
+}
+
+/**
+ * @brief Add counters of a cache to statistics.
+ *
+ * @param stats Statistics
+ * @param counters Counters
+ */
+static void gmp_pool_add_counters(gmp_pool_stats_t* stats,
+                                  gmp_pool_counters_t* counters) {
+  stats->allocations += atomic_load_explicit(&counters->allocations,
+                                             memory_order_relaxed);
+  stats->reallocations += atomic_load_explicit(&counters->reallocations,
+                                               memory_order_relaxed);
+  stats->frees += atomic_load_explicit(&counters->frees, memory_order_relaxed);
+  stats->hits += atomic_load_explicit(&counters->hits, memory_order_relaxed);
+  stats->misses += atomic_load_explicit(&counters->misses,
+                                        memory_order_relaxed);
+  stats->bytes_requested += atomic_load_explicit(&counters->bytes_requested,
+                                                 memory_order_relaxed);
+  stats->bytes_in_use += atomic_load_explicit(&counters->bytes_in_use,
+                                              memory_order_relaxed);
+  stats->bytes_cached += atomic_load_explicit(&counters->bytes_cached,
+                                              memory_order_relaxed);
+}
+
+/**
+ * @brief Give free blocks of a cache back to the previous memory functions,
+ * keep its counters as retired, and remove it from the registry.
+ * @remark Called by the thread that owns the cache, at exit or uninstall.
+ *
+ * @param data Cache
+ */
+static void gmp_pool_release_cache(void* data) {
+  gmp_pool_cache_t* cache = (gmp_pool_cache_t*)data;
+  for (size_t size_class = 0; size_class < CLASS_COUNT; ++size_class) {
+    const size_t block_size = (size_t)GMP_POOL_MIN_BLOCK << size_class;
+    while (cache->free_lists[size_class]) {
+      gmp_pool_block_t* block = cache->free_lists[size_class];
+      cache->free_lists[size_class] = block->next;
+      previous_free(block, block_size);
+    }
+  }
+  atomic_store_explicit(&cache->counters.bytes_cached, 0,
+                        memory_order_relaxed);
+  pthread_mutex_lock(&registry_mutex);
+  gmp_pool_cache_t** link = &registry;
+  while (*link != cache) {
+    link = &(*link)->next;
+  }
+  *link = cache->next;
+  gmp_pool_add_counters(&retired, &cache->counters);
+  pthread_mutex_unlock(&registry_mutex);
+  // Later allocations of the thread, e.g. in other destructors, must not
+  // use the freed cache
+  thread_cache = NULL;
+  free(cache);
+}
+
+static void gmp_pool_create_key(void) {
+  cache_key_error = pthread_key_create(&cache_key, gmp_pool_release_cache);
+}
+
+/**
+ * @brief Get the cache of the calling thread, creating it on first use.
+ *
+ * @return Cache, or NULL if it cannot be created
+ */
+static inline gmp_pool_cache_t* gmp_pool_get_cache(void) {
+  if (thread_cache == NULL) {
+    gmp_pool_cache_t* cache = calloc(1, sizeof(gmp_pool_cache_t));
+    if (cache == NULL || pthread_setspecific(cache_key, cache) != 0) {
+      // The thread uses the previous memory functions directly
+      free(cache);
+      return NULL;
+    }
+    pthread_mutex_lock(&registry_mutex);
+    cache->next = registry;
+    registry = cache;
+    pthread_mutex_unlock(&registry_mutex);
+    thread_cache = cache;
+  }
+  return thread_cache;
+}
+
+/**
+ * @brief Take a block for a request, from the pool if possible.
+ *
+ * @param cache Cache of the calling thread
+ * @param size Bytes
+ * @return Block of at least size bytes
+ */
+static void* gmp_pool_take(gmp_pool_cache_t* cache, size_t size) {
+  if (size > GMP_POOL_MAX_BLOCK) {
+    gmp_pool_count_signed(&cache->counters.bytes_in_use, size);
+    gmp_pool_count(&cache->counters.misses, 1);
+    return previous_allocate(size);
+  }
+  const size_t size_class = gmp_pool_class(size);
+  const size_t block_size = (size_t)GMP_POOL_MIN_BLOCK << size_class;
+  gmp_pool_count_signed(&cache->counters.bytes_in_use, block_size);
+  gmp_pool_block_t* block = cache->free_lists[size_class];
+  if (block) {
+    cache->free_lists[size_class] = block->next;
+    cache->cached_bytes -= block_size;
+    atomic_store_explicit(&cache->counters.bytes_cached, cache->cached_bytes,
+                          memory_order_relaxed);
+    gmp_pool_count(&cache->counters.hits, 1);
+    return block;
+  }
+  gmp_pool_count(&cache->counters.misses, 1);
+  return previous_allocate(block_size);
+}
+
+/**
+ * @brief Give back a block, to the pool if it has room.
+ *
+ * @param cache Cache of the calling thread
+ * @param pointer Block
+ * @param size Bytes requested for the block
+ */
+static void gmp_pool_give(gmp_pool_cache_t* cache, void* pointer,
+                          size_t size) {
+  if (size > GMP_POOL_MAX_BLOCK) {
+    gmp_pool_count_signed(&cache->counters.bytes_in_use, -(int64_t)size);
+    previous_free(pointer, size);
+    return;
+  }
+  const size_t size_class = gmp_pool_class(size);
+  const size_t block_size = (size_t)GMP_POOL_MIN_BLOCK << size_class;
+  gmp_pool_count_signed(&cache->counters.bytes_in_use, -(int64_t)block_size);
+  if (cache->cached_bytes + block_size > max_cached_bytes) {
+    previous_free(pointer, block_size);
+    return;
+  }
+  gmp_pool_block_t* block = (gmp_pool_block_t*)pointer;
+  block->next = cache->free_lists[size_class];
+  cache->free_lists[size_class] = block;
+  cache->cached_bytes += block_size;
+  atomic_store_explicit(&cache->counters.bytes_cached, cache->cached_bytes,
+                        memory_order_relaxed);
+}
+
+static void* gmp_pool_allocate(size_t size) {
+  gmp_pool_cache_t* cache = gmp_pool_get_cache();
+  if (cache == NULL) {
+    // Round up as the pool does, since other threads may pool the block
+    return previous_allocate(gmp_pool_block_size(size));
+  }
+  gmp_pool_count(&cache->counters.allocations, 1);
+  gmp_pool_count(&cache->counters.bytes_requested, size);
+  return gmp_pool_take(cache, size);
+}
+
+static void* gmp_pool_reallocate(void* pointer, size_t old_size,
+                                 size_t new_size) {
+  gmp_pool_cache_t* cache = gmp_pool_get_cache();
+  if (cache == NULL) {
+    // Blocks keep the sizes of their classes, as if they were pooled
+    return previous_reallocate(pointer, gmp_pool_block_size(old_size),
+                               gmp_pool_block_size(new_size));
+  }
+  gmp_pool_count(&cache->counters.reallocations, 1);
+  if (new_size > old_size) {
+    gmp_pool_count(&cache->counters.bytes_requested, new_size - old_size);
+  }
+  if (old_size > GMP_POOL_MAX_BLOCK && new_size > GMP_POOL_MAX_BLOCK) {
+    gmp_pool_count_signed(&cache->counters.bytes_in_use,
+                          (int64_t)new_size - (int64_t)old_size);
+    gmp_pool_count(&cache->counters.misses, 1);
+    return previous_reallocate(pointer, old_size, new_size);
+  }
+  if (old_size <= GMP_POOL_MAX_BLOCK && new_size <= GMP_POOL_MAX_BLOCK &&
+      gmp_pool_class(old_size) == gmp_pool_class(new_size)) {
+    // The block already fits the new size
+    gmp_pool_count(&cache->counters.hits, 1);
+    return pointer;
+  }
+  void* block = gmp_pool_take(cache, new_size);
+  memcpy(block, pointer, old_size < new_size ? old_size : new_size);
+  gmp_pool_give(cache, pointer, old_size);
+  return block;
+}
+
+static void gmp_pool_free(void* pointer, size_t size) {
+  gmp_pool_cache_t* cache = gmp_pool_get_cache();
+  if (cache == NULL) {
+    // Pooled blocks are larger than size, so free them with their size
+    previous_free(pointer, gmp_pool_block_size(size));
+    return;
+  }
+  gmp_pool_count(&cache->counters.frees, 1);
+  gmp_pool_give(cache, pointer, size);
+}
+
+int gmp_pool_install(size_t max_cache_bytes) {
+  pthread_once(&cache_key_once, gmp_pool_create_key);
+  if (cache_key_error != 0) {
+    fprintf(stderr, "%s", "error: cannot create pool key\n");
+    return EXIT_FAILURE;
+  }
+  max_cached_bytes = max_cache_bytes;
+  void* (*allocate)(size_t) = NULL;
+  mp_get_memory_functions(&allocate, NULL, NULL);
+  if (allocate == gmp_pool_allocate) {
+    // Already installed, previous functions must not be the pool itself
+    return EXIT_SUCCESS;
+  }
+  mp_get_memory_functions(&previous_allocate, &previous_reallocate,
+                          &previous_free);
+  pthread_mutex_lock(&registry_mutex);
+  memset(&retired, 0, sizeof(gmp_pool_stats_t));
+  memset(&baseline, 0, sizeof(gmp_pool_stats_t));
+  pthread_mutex_unlock(&registry_mutex);
+  mp_set_memory_functions(gmp_pool_allocate, gmp_pool_reallocate,
+                          gmp_pool_free);
+  return EXIT_SUCCESS;
+}
+
+void gmp_pool_uninstall(void) {
+  if (thread_cache) {
+    pthread_setspecific(cache_key, NULL);
+    gmp_pool_release_cache(thread_cache);
+  }
+  mp_set_memory_functions(previous_allocate, previous_reallocate,
+                          previous_free);
+}
+
+void gmp_pool_get_stats(gmp_pool_stats_t* stats) {
+  assert(stats);
+  pthread_mutex_lock(&registry_mutex);
+  *stats = retired;
+  for (gmp_pool_cache_t* cache = registry; cache; cache = cache->next) {
+    gmp_pool_add_counters(stats, &cache->counters);
+  }
+  stats->allocations -= baseline.allocations;
+  stats->reallocations -= baseline.reallocations;
+  stats->frees -= baseline.frees;
+  stats->hits -= baseline.hits;
+  stats->misses -= baseline.misses;
+  stats->bytes_requested -= baseline.bytes_requested;
+  pthread_mutex_unlock(&registry_mutex);
+}
+
+void gmp_pool_reset_stats(void) {
+  gmp_pool_stats_t stats;
+  pthread_mutex_lock(&registry_mutex);
+  stats = retired;
+  for (gmp_pool_cache_t* cache = registry; cache; cache = cache->next) {
+    gmp_pool_add_counters(&stats, &cache->counters);
+  }
+  baseline = stats;
+  pthread_mutex_unlock(&registry_mutex);
+}
@@ -0,0 +1,91 @@
+/**
+ * @file gmp_pool.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Thread-local size-class pool for GMP memory. Header.
+ * @version 1.0.0
+ * @date 2022-07-04
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef GMP_POOL_H
+#define GMP_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Smallest block size, in bytes. Smaller requests take a block of this size
+#define GMP_POOL_MIN_BLOCK 16
+
+/// Largest block size, in bytes. Larger requests are not pooled
+#define GMP_POOL_MAX_BLOCK 65536
+
+/// Bytes of free blocks that each thread keeps by default
+#define GMP_POOL_DEFAULT_CACHE_BYTES (4 * 1024 * 1024)
+
+/**
+ * @brief Allocation counts and bytes of the pool, summed over all threads.
+ *
+ */
+typedef struct gmp_pool_stats {
+  /// Calls to the allocate function
+  uint64_t allocations;
+  /// Calls to the reallocate function
+  uint64_t reallocations;
+  /// Calls to the free function
+  uint64_t frees;
+  /// Allocations and reallocations served from a free block of the pool
+  uint64_t hits;
+  /// Allocations and reallocations that took memory from the previous
+  /// memory functions, e.g. malloc
+  uint64_t misses;
+  /// Bytes requested by allocations and by growing reallocations
+  uint64_t bytes_requested;
+  /// Bytes given to GMP and not freed yet, rounded up to block sizes
+  int64_t bytes_in_use;
+  /// Bytes of free blocks kept by threads
+  uint64_t bytes_cached;
+} gmp_pool_stats_t;
+
+/**
+ * @brief Install the pool with mp_set_memory_functions. Each thread keeps a
+ * free list per power-of-two block size, from GMP_POOL_MIN_BLOCK to
+ * GMP_POOL_MAX_BLOCK bytes, so most mpz_init, mpz_clear and reallocations
+ * in loops reuse blocks without locks. Blocks come from the memory functions
+ * that were installed before, and go back to them when a thread caches more
+ * than max_cache_bytes or when it exits.
+ * @remark As any call to mp_set_memory_functions, it must be called when no
+ * GMP variable has memory allocated, usually at the start of the program.
+ *
+ * @param max_cache_bytes Bytes of free blocks that each thread keeps
+ * @return Error code
+ */
+int gmp_pool_install(size_t max_cache_bytes);
+
+/**
+ * @brief Restore the memory functions installed before the pool, and release
+ * free blocks of the calling thread. Memory allocated while the pool was
+ * installed must be freed before. Other threads that used the pool must
+ * have exited.
+ *
+ */
+void gmp_pool_uninstall(void);
+
+/**
+ * @brief Get statistics of all threads since the pool was installed or
+ * statistics were reset. Counters of running threads are read without
+ * stopping them, so they may be slightly behind.
+ *
+ * @param stats Where statistics are stored
+ */
+void gmp_pool_get_stats(gmp_pool_stats_t* stats);
+
+/**
+ * @brief Set counters of all threads to zero, except bytes in use and bytes
+ * cached.
+ *
+ */
+void gmp_pool_reset_stats(void);
+
+#endif  // GMP_POOL_H
@@ -0,0 +1,105 @@
+/**
+ * @file main.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Operations of example/gmp.c with the pool installed, and its
+ * allocation statistics.
+ * @version 1.0.0
+ * @date 2022-07-04
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gmp_pool.h"
+
+/// Test basic operations: +, -, *, div, mod, printing them if output is set
+void test_operations(mpz_t num1, mpz_t num2, FILE* output);
+/// Prints num1 operator num2 == result, unless output is NULL
+void print_result(FILE* output, mpz_t num1, const char* operator, mpz_t num2,
+                  mpz_t result);
+/// Prints allocation statistics of the pool
+void print_stats(void);
+
+int main(int argc, char* argv[]) {
+  size_t iterations = 1;
+  if ((argc >= 2 && sscanf(argv[1], "%zu", &iterations) != 1) ||
+      iterations == 0) {
+    fprintf(stderr, "usage: %s [iterations] < numbers\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  // Before any GMP variable is allocated
+  if (gmp_pool_install(GMP_POOL_DEFAULT_CACHE_BYTES) != EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+  int error = EXIT_SUCCESS;
+  mpz_t num1, num2;
+  mpz_init_set_si(num1, -101);
+  mpz_init_set_ui(num2, 2);
+
+  // Read two arbitrary precision numbers as strings from stdin
+  char num1text[1024], num2text[1024];
+  if (scanf("%1023s %1023s", num1text, num2text) == 2) {
+    error += mpz_set_str(num1, num1text, /*base*/ 10);
+    error += mpz_set_str(num2, num2text, /*base*/ 10);
+  }
+  if (error == 0) {
+    // Each iteration initializes and clears its result, as gmp.c
+    for (size_t iteration = 0; iteration < iterations; ++iteration) {
+      test_operations(num1, num2, iteration == 0 ? stdout : NULL);
+    }
+  } else {
+    fprintf(stderr, "invalid number\n");
+  }
+
+  mpz_clear(num1);
+  mpz_clear(num2);
+  print_stats();
+  gmp_pool_uninstall();
+  return error;
+}
+
+void test_operations(mpz_t num1, mpz_t num2, FILE* output) {
+  mpz_t result;
+  mpz_init(result);
+  mpz_add(result, num1, num2);
+  print_result(output, num1, "+", num2, result);
+  mpz_sub(result, num1, num2);
+  print_result(output, num1, "-", num2, result);
+  mpz_mul(result, num1, num2);
+  print_result(output, num1, "*", num2, result);
+  mpz_div(result, num1, num2);
+  print_result(output, num1, "/", num2, result);
+  mpz_mod(result, num1, num2);
+  print_result(output, num1, "mod", num2, result);
+  mpz_clear(result);
+}
+
+void print_result(FILE* output, mpz_t num1, const char* operator, mpz_t num2,
+                  mpz_t result) {
+  if (output == NULL) {
+    return;
+  }
+  mpz_out_str(output, /*base*/ 10, num1);
+  fprintf(output, " %s ", operator);
+  mpz_out_str(output, /*base*/ 10, num2);
+  fprintf(output, " == ");
+  mpz_out_str(output, /*base*/ 10, result);
+  fprintf(output, "\n");
+}
+
+void print_stats(void) {
+  gmp_pool_stats_t stats;
+  gmp_pool_get_stats(&stats);
+  printf("\nallocations:     %lu\n", (unsigned long)stats.allocations);
+  printf("reallocations:   %lu\n", (unsigned long)stats.reallocations);
+  printf("frees:           %lu\n", (unsigned long)stats.frees);
+  printf("pool hits:       %lu\n", (unsigned long)stats.hits);
+  printf("pool misses:     %lu\n", (unsigned long)stats.misses);
+  printf("bytes requested: %lu\n", (unsigned long)stats.bytes_requested);
+  printf("bytes in use:    %ld\n", (long)stats.bytes_in_use);
+  printf("bytes cached:    %lu\n", (unsigned long)stats.bytes_cached);
+}
@@ -0,0 +1,215 @@
+/**
+ * @file bench_reduction.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Scaling of the parallel reduction tree across thread counts.
+ * @details Workloads are the factorial of n, the product of n / 100 random
+ * numbers of 1 to 10^4 bits, and the sum of n random numbers of 1024 bits.
+ * Each one is reduced with 1, 2, 4... threads up to thread_count, and the
+ * median time is printed as a CSV row with speedup and efficiency relative
+ * to one thread. Results are checked against mpz_fac_ui for the factorial,
+ * against a loop of mpz_add for the sum, and against one thread for the
+ * product, whose times are printed too.
+ * @version 1.0.0
+ * @date 2022-06-27
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "reduction.h"
+
+/// Default n of workloads
+#define DEFAULT_N 1000000
+
+/// Default timed runs of each workload and thread count
+#define DEFAULT_REPETITIONS 3
+
+/// Seed of random numbers, so every run uses the same ones
+#define RANDOM_SEED 2022
+
+/// Workloads
+enum workload { FACTORIAL, PRODUCT, SUM, WORKLOAD_COUNT };
+
+/// Names of workloads
+static const char* const workload_names[] = {"factorial", "product", "sum"};
+
+double get_duration(struct timespec stop_time, struct timespec start_time);
+int compare_doubles(const void* first, const void* second);
+
+/**
+ * @brief Create the numbers of a workload.
+ *
+ * @param workload Workload
+ * @param n n of workloads
+ * @param random Random state
+ * @param count Where the number count is stored
+ * @return Array of initialized numbers, or NULL on error
+ */
+mpz_t* create_numbers(enum workload workload, size_t n,
+                      gmp_randstate_t random, size_t* count);
+
+/**
+ * @brief Calculate a workload without the reduction tree.
+ *
+ * @param workload Workload
+ * @param result Result
+ * @param numbers Numbers of the workload
+ * @param count Number count
+ * @param n n of workloads
+ * @return Non-zero if there is a reference for the workload
+ */
+int reference(enum workload workload, mpz_t result, mpz_t* numbers,
+              size_t count, size_t n);
+
+int main(int argc, char* argv[]) {
+  size_t n = DEFAULT_N;
+  const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t max_threads = cpu_count > 0 ? (size_t)cpu_count : 1;
+  size_t repetitions = DEFAULT_REPETITIONS;
+  if ((argc >= 2 && sscanf(argv[1], "%zu", &n) != 1) ||
+      (argc >= 3 && sscanf(argv[2], "%zu", &max_threads) != 1) ||
+      (argc >= 4 && sscanf(argv[3], "%zu", &repetitions) != 1) ||
+      n < 100 || max_threads == 0 || repetitions == 0) {
+    fprintf(stderr, "usage: %s [n>=100] [thread_count] [repetitions]\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  double* times = malloc(repetitions * sizeof(double));
+  if (times == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate times\n");
+    return EXIT_FAILURE;
+  }
+  gmp_randstate_t random;
+  gmp_randinit_default(random);
+  gmp_randseed_ui(random, RANDOM_SEED);
+  mpz_t result, expected;
+  mpz_inits(result, expected, NULL);
+  int error = EXIT_SUCCESS;
+  printf("workload,method,threads,seconds,speedup,efficiency\n");
+  for (int workload = 0; workload < WORKLOAD_COUNT && error == EXIT_SUCCESS;
+       ++workload) {
+    size_t count = 0;
+    mpz_t* numbers = create_numbers(workload, n, random, &count);
+    if (numbers == NULL) {
+      error = EXIT_FAILURE;
+      break;
+    }
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    const int has_reference = reference(workload, expected, numbers, count,
+                                        n);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    if (has_reference) {
+      printf("%s,reference,1,%.6f,,\n", workload_names[workload],
+             get_duration(stop, start));
+    }
+    double serial_time = 0.0;
+    // Thread counts 1, 2, 4... and max_threads
+    for (size_t threads = 1; threads <= max_threads && error == EXIT_SUCCESS;
+         threads = threads < max_threads && 2 * threads > max_threads
+                       ? max_threads
+                       : 2 * threads) {
+      for (size_t repetition = 0;
+           repetition < repetitions && error == EXIT_SUCCESS; ++repetition) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        error = reduction_reduce(result, numbers, count,
+                                 workload == SUM ? REDUCTION_SUM
+                                                 : REDUCTION_PRODUCT,
+                                 threads);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        times[repetition] = get_duration(stop, start);
+        if (!has_reference && threads == 1 && repetition == 0) {
+          mpz_set(expected, result);
+        }
+        if (error == EXIT_SUCCESS && mpz_cmp(result, expected) != 0) {
+          fprintf(stderr, "error: wrong %s with %zu threads\n",
+                  workload_names[workload], threads);
+          error = EXIT_FAILURE;
+        }
+      }
+      if (error == EXIT_SUCCESS) {
+        qsort(times, repetitions, sizeof(double), compare_doubles);
+        const double median = times[repetitions / 2];
+        if (threads == 1) {
+          serial_time = median;
+        }
+        printf("%s,tree,%zu,%.6f,%.3f,%.3f\n", workload_names[workload],
+               threads, median, serial_time / median,
+               serial_time / median / threads);
+        fflush(stdout);
+      }
+    }
+    for (size_t index = 0; index < count; ++index) {
+      mpz_clear(numbers[index]);
+    }
+    free(numbers);
+  }
+  mpz_clears(result, expected, NULL);
+  gmp_randclear(random);
+  free(times);
+  return error;
+}
+
+mpz_t* create_numbers(enum workload workload, size_t n,
+                      gmp_randstate_t random, size_t* count) {
+  *count = workload == PRODUCT ? n / 100 : n;
+  mpz_t* numbers = malloc(*count * sizeof(mpz_t));
+  if (numbers == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate numbers\n");
+    return NULL;
+  }
+  for (size_t index = 0; index < *count; ++index) {
+    mpz_init(numbers[index]);
+    switch (workload) {
+      case FACTORIAL:
+        mpz_set_ui(numbers[index], index + 1);
+        break;
+      case PRODUCT:
+        // Sizes are skewed, many small numbers and a few large ones
+        mpz_urandomb(numbers[index], random,
+                     1 + gmp_urandomm_ui(random, 1 + gmp_urandomm_ui(
+                                                         random, 10000)));
+        mpz_setbit(numbers[index], 0);
+        break;
+      default:
+        mpz_urandomb(numbers[index], random, 1024);
+        break;
+    }
+  }
+  return numbers;
+}
+
+int reference(enum workload workload, mpz_t result, mpz_t* numbers,
+              size_t count, size_t n) {
+  switch (workload) {
+    case FACTORIAL:
+      mpz_fac_ui(result, n);
+      return 1;
+    case SUM:
+      mpz_set_ui(result, 0);
+      for (size_t index = 0; index < count; ++index) {
+        mpz_add(result, result, numbers[index]);
+      }
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+int compare_doubles(const void* first, const void* second) {
+  const double difference = *(const double*)first - *(const double*)second;
+  return (difference > 0) - (difference < 0);
+}
+
+// https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
+double get_duration(struct timespec stop_time, struct timespec start_time) {
+  return (stop_time.tv_sec + 1e-9 * stop_time.tv_nsec) -
+         (start_time.tv_sec + 1e-9 * start_time.tv_nsec);
+}
@@ -0,0 +1,165 @@
+/**
+ * @file main.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Factorials, binomials, products and sums of big integers calculated
+ * by a parallel reduction tree.
+ * @version 1.0.0
+ * @date 2022-06-27
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "reduction.h"
+
+/**
+ * @brief Create an array with numbers from first to last.
+ *
+ * @param first First number
+ * @param last Last number, at least first - 1 for an empty array
+ * @param count Where the number count is stored
+ * @return Array of initialized numbers, or NULL on error
+ */
+mpz_t* create_range(unsigned long first, unsigned long last, size_t* count);
+
+/**
+ * @brief Read numbers from a stream until end of file.
+ *
+ * @param stream Input stream
+ * @param count Where the number count is stored
+ * @return Array of initialized numbers, or NULL on error
+ */
+mpz_t* read_numbers(FILE* stream, size_t* count);
+
+/**
+ * @brief Release an array of numbers.
+ *
+ * @param numbers Array of initialized numbers
+ * @param count Number count
+ */
+void destroy_numbers(mpz_t* numbers, size_t count);
+
+void print_usage(const char* program);
+
+int main(int argc, char* argv[]) {
+  const char* mode = argc >= 2 ? argv[1] : "";
+  // Numeric arguments of the mode before thread count, -1 if mode is invalid
+  int operands = -1;
+  if (strcmp(mode, "product") == 0 || strcmp(mode, "sum") == 0) {
+    operands = 0;
+  } else if (strcmp(mode, "factorial") == 0) {
+    operands = 1;
+  } else if (strcmp(mode, "binomial") == 0) {
+    operands = 2;
+  }
+  unsigned long n = 0, k = 0;
+  size_t thread_count = 0;
+  if (operands < 0 ||
+      (operands >= 1 && (argc < 3 || sscanf(argv[2], "%lu", &n) != 1)) ||
+      (operands >= 2 &&
+       (argc < 4 || sscanf(argv[3], "%lu", &k) != 1 || k > n)) ||
+      (argc >= operands + 3 &&
+       sscanf(argv[operands + 2], "%zu", &thread_count) != 1)) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  int error = EXIT_SUCCESS;
+  mpz_t result;
+  mpz_init(result);
+  size_t count = 0;
+  mpz_t* numbers = NULL;
+  if (operands == 0) {
+    numbers = read_numbers(stdin, &count);
+  } else {
+    // n! = 1 * ... * n, and n choose k = (n - k + 1) * ... * n / k!
+    numbers = create_range(operands == 1 ? 1 : n - k + 1, n, &count);
+  }
+  if (numbers) {
+    error = reduction_reduce(result, numbers, count,
+                             strcmp(mode, "sum") == 0 ? REDUCTION_SUM
+                                                      : REDUCTION_PRODUCT,
+                             thread_count);
+    destroy_numbers(numbers, count);
+    if (error == EXIT_SUCCESS && operands == 2) {
+      mpz_t denominator;
+      mpz_init(denominator);
+      numbers = create_range(1, k, &count);
+      if (numbers) {
+        error = reduction_product(denominator, numbers, count, thread_count);
+        destroy_numbers(numbers, count);
+        mpz_divexact(result, result, denominator);
+      } else {
+        error = EXIT_FAILURE;
+      }
+      mpz_clear(denominator);
+    }
+  } else {
+    error = EXIT_FAILURE;
+  }
+  if (error == EXIT_SUCCESS) {
+    mpz_out_str(stdout, 10, result);
+    printf("\n");
+  }
+  mpz_clear(result);
+  return error;
+}
+
+mpz_t* create_range(unsigned long first, unsigned long last, size_t* count) {
+  *count = last + 1 - first;
+  mpz_t* numbers = malloc((*count > 0 ? *count : 1) * sizeof(mpz_t));
+  if (numbers == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate numbers\n");
+    return NULL;
+  }
+  for (size_t index = 0; index < *count; ++index) {
+    mpz_init_set_ui(numbers[index], first + index);
+  }
+  return numbers;
+}
+
+mpz_t* read_numbers(FILE* stream, size_t* count) {
+  size_t capacity = 1024;
+  mpz_t* numbers = malloc(capacity * sizeof(mpz_t));
+  *count = 0;
+  while (numbers) {
+    if (*count == capacity) {
+      mpz_t* grown = realloc(numbers, 2 * capacity * sizeof(mpz_t));
+      if (grown == NULL) {
+        destroy_numbers(numbers, *count);
+        numbers = NULL;
+        break;
+      }
+      numbers = grown;
+      capacity *= 2;
+    }
+    mpz_init(numbers[*count]);
+    if (mpz_inp_str(numbers[*count], stream, 10) == 0) {
+      mpz_clear(numbers[*count]);
+      break;
+    }
+    ++*count;
+  }
+  if (numbers == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate numbers\n");
+  }
+  return numbers;
+}
+
+void destroy_numbers(mpz_t* numbers, size_t count) {
+  for (size_t index = 0; index < count; ++index) {
+    mpz_clear(numbers[index]);
+  }
+  free(numbers);
+}
+
+void print_usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s factorial n [thread_count]\n"
+          "       %s binomial n k [thread_count]\n"
+          "       %s product|sum [thread_count] < numbers\n",
+          program, program, program);
+}
@@ -0,0 +1,481 @@
+/**
+ * @file reduction.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Parallel product and sum of arrays of big integers. Implementation.
+ * @version 1.0.0
+ * @date 2022-06-27
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "reduction.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/// Initial capacity of each deque
+#define DEQUE_INITIAL_CAPACITY 64
+
+/// An mpz operation with two operands, e.g. mpz_mul
+typedef void (*mpz_operation_t)(mpz_ptr rop, mpz_srcptr op1, mpz_srcptr op2);
+
+/**
+ * @brief Node of the reduction tree, that combines a range of numbers.
+ *
+ */
+typedef struct reduction_node {
+  /// First number
+  size_t begin;
+  /// Number after the last one
+  size_t end;
+  /// Node that combines this one with its sibling, NULL for the root
+  struct reduction_node* parent;
+  /// Halves, if the node was split
+  struct reduction_node* children[2];
+  /// Halves that are not finished yet
+  atomic_int pending;
+  /// Combination of the range, once finished
+  mpz_t value;
+} reduction_node_t;
+
+/**
+ * @brief Nodes pending to be calculated by a thread. The owner thread pushes
+ * and pops at the bottom, other threads steal from the top.
+ *
+ */
+typedef struct reduction_deque {
+  /// Protects the deque
+  pthread_mutex_t mutex;
+  /// Pending nodes from top to bottom
+  reduction_node_t** nodes;
+  /// Capacity of nodes array
+  size_t capacity;
+  /// Index of the oldest node
+  size_t top;
+  /// Index after the newest node
+  size_t bottom;
+} reduction_deque_t;
+
+/**
+ * @brief Data shared by all threads of a reduction.
+ *
+ */
+typedef struct shared_data {
+  /// Numbers to combine
+  mpz_t* numbers;
+  /// Bits of numbers before each index, count + 1 elements
+  uint64_t* prefix_bits;
+  /// Operation
+  mpz_operation_t operation;
+  /// Preallocated nodes, 2 * count - 1 at most are needed
+  reduction_node_t* nodes;
+  /// Index of the next node to use
+  atomic_size_t next_node;
+  /// A deque per thread
+  reduction_deque_t* deques;
+  /// Thread count
+  size_t thread_count;
+  /// True when the root is finished
+  atomic_bool done;
+  /// Protects waits of idle threads
+  pthread_mutex_t idle_mutex;
+  /// Signaled when a node is pushed or the root is finished
+  pthread_cond_t work_available;
+  /// Nodes pushed so far, changed with idle_mutex locked
+  atomic_size_t pushes;
+  /// Threads waiting for work_available, protected by idle_mutex
+  size_t idle_threads;
+} shared_data_t;
+
+/**
+ * @brief Data of each thread.
+ *
+ */
+typedef struct private_data {
+  /// Thread number, i.e., index of its deque
+  size_t thread_number;
+  /// Shared data
+  shared_data_t* shared_data;
+} private_data_t;
+
+/**
+ * @brief Find the split of a range of at least two numbers where the bits of
+ * both halves are closest.
+ *
+ * @param shared_data Shared data
+ * @param begin First number
+ * @param end Number after the last one
+ * @return First number of the second half, from begin + 1 to end - 1
+ */
+static size_t reduction_split(const shared_data_t* shared_data, size_t begin,
+                              size_t end);
+
+/**
+ * @brief Combine a range of numbers on the calling thread, with a tree split
+ * as the parallel one.
+ *
+ * @param shared_data Shared data
+ * @param result Result
+ * @param begin First number
+ * @param end Number after the last one
+ */
+static void reduction_serial(const shared_data_t* shared_data, mpz_ptr result,
+                             size_t begin, size_t end);
+
+/**
+ * @brief Calculate a node, splitting it and pushing halves to the deque of
+ * the thread while it is large.
+ *
+ * @param shared_data Shared data
+ * @param deque Deque of the calling thread
+ * @param node Node
+ */
+static void reduction_run(shared_data_t* shared_data, reduction_deque_t* deque,
+                          reduction_node_t* node);
+
+/**
+ * @brief Mark a node as finished, and combine its parent if its sibling is
+ * finished too, up to the root.
+ *
+ * @param shared_data Shared data
+ * @param node Finished node
+ */
+static void reduction_complete(shared_data_t* shared_data,
+                               reduction_node_t* node);
+
+/**
+ * @brief Ensure a deque has room to push one node.
+ *
+ * @param deque Deque of the calling thread
+ * @return Error code
+ */
+static int reduction_deque_reserve(reduction_deque_t* deque);
+
+/**
+ * @brief Take the newest node of the deque of the calling thread.
+ *
+ * @param deque Deque
+ * @return Node, or NULL if deque is empty
+ */
+static reduction_node_t* reduction_deque_pop(reduction_deque_t* deque);
+
+/**
+ * @brief Take the oldest node of the deque of another thread.
+ *
+ * @param deque Deque
+ * @return Node, or NULL if deque is empty
+ */
+static reduction_node_t* reduction_deque_steal(reduction_deque_t* deque);
+
+/**
+ * @brief Take nodes from own deque, or steal them, until the root is done.
+ * Threads that find no node wait until one is pushed.
+ *
+ * @param data Private data
+ * @return NULL
+ */
+static void* reduction_run_thread(void* data);
+
+int reduction_reduce(mpz_t result, mpz_t numbers[], size_t count,
+                     enum reduction_operation operation, size_t thread_count) {
+  assert(result);
+  assert(numbers || count == 0);
+  if (count <= 1) {
+    if (count == 1) {
+      mpz_set(result, numbers[0]);
+    } else {
+      mpz_set_ui(result, operation == REDUCTION_PRODUCT ? 1 : 0);
+    }
+    return EXIT_SUCCESS;
+  }
+  if (thread_count == 0) {
+    const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    thread_count = cpu_count > 0 ? (size_t)cpu_count : 1;
+  }
+  int error = EXIT_SUCCESS;
+  shared_data_t shared_data;
+  shared_data.numbers = numbers;
+  shared_data.operation = operation == REDUCTION_PRODUCT ? mpz_mul : mpz_add;
+  shared_data.thread_count = thread_count;
+  shared_data.prefix_bits = malloc((count + 1) * sizeof(uint64_t));
+  shared_data.nodes = malloc((2 * count - 1) * sizeof(reduction_node_t));
+  shared_data.deques = calloc(thread_count, sizeof(reduction_deque_t));
+  pthread_t* threads = malloc(thread_count * sizeof(pthread_t));
+  private_data_t* private_data = calloc(thread_count, sizeof(private_data_t));
+  size_t deque_count = 0;
+  bool idle_ready = false;
+  if (shared_data.prefix_bits && shared_data.nodes && shared_data.deques &&
+      threads && private_data) {
+    idle_ready = pthread_mutex_init(&shared_data.idle_mutex, NULL) == 0;
+    if (idle_ready &&
+        pthread_cond_init(&shared_data.work_available, NULL) != 0) {
+      pthread_mutex_destroy(&shared_data.idle_mutex);
+      idle_ready = false;
+    }
+    for (; idle_ready && deque_count < thread_count; ++deque_count) {
+      reduction_deque_t* deque = &shared_data.deques[deque_count];
+      deque->capacity = DEQUE_INITIAL_CAPACITY;
+      deque->nodes = malloc(deque->capacity * sizeof(reduction_node_t*));
+      if (deque->nodes == NULL ||
+          pthread_mutex_init(&deque->mutex, NULL) != 0) {
+        free(deque->nodes);
+        break;
+      }
+    }
+  }
+  if (idle_ready && deque_count == thread_count) {
+    // Sizes of numbers, so halves of each node are split by bits
+    shared_data.prefix_bits[0] = 0;
+    for (size_t index = 0; index < count; ++index) {
+      shared_data.prefix_bits[index + 1] =
+          shared_data.prefix_bits[index] + mpz_sizeinbase(numbers[index], 2);
+    }
+    reduction_node_t* root = &shared_data.nodes[0];
+    root->begin = 0;
+    root->end = count;
+    root->parent = NULL;
+    mpz_init(root->value);
+    atomic_init(&shared_data.next_node, 1);
+    atomic_init(&shared_data.done, false);
+    atomic_init(&shared_data.pushes, 0);
+    shared_data.idle_threads = 0;
+    shared_data.deques[0].nodes[shared_data.deques[0].bottom++] = root;
+    // Calling thread is the first one
+    size_t created = 1;
+    for (; created < thread_count; ++created) {
+      private_data[created].thread_number = created;
+      private_data[created].shared_data = &shared_data;
+      if (pthread_create(&threads[created], NULL, reduction_run_thread,
+                         &private_data[created]) != 0) {
+        // Deques of missing threads stay empty, the rest do their work
+        fprintf(stderr, "error: cannot create thread %zu\n", created);
+        break;
+      }
+    }
+    private_data[0].thread_number = 0;
+    private_data[0].shared_data = &shared_data;
+    reduction_run_thread(&private_data[0]);
+    for (size_t thread_number = 1; thread_number < created; ++thread_number) {
+      pthread_join(threads[thread_number], NULL);
+    }
+    mpz_swap(result, root->value);
+    mpz_clear(root->value);
+  } else {
+    fprintf(stderr, "%s", "error: cannot allocate reduction\n");
+    error = EXIT_FAILURE;
+  }
+  for (size_t index = 0; index < deque_count; ++index) {
+    pthread_mutex_destroy(&shared_data.deques[index].mutex);
+    free(shared_data.deques[index].nodes);
+  }
+  if (idle_ready) {
+    pthread_cond_destroy(&shared_data.work_available);
+    pthread_mutex_destroy(&shared_data.idle_mutex);
+  }
+  free(private_data);
+  free(threads);
+  free(shared_data.deques);
+  free(shared_data.nodes);
+  free(shared_data.prefix_bits);
+  return error;
+}
+
+static size_t reduction_split(const shared_data_t* shared_data, size_t begin,
+                              size_t end) {
+  assert(end - begin >= 2);
+  const uint64_t* prefix_bits = shared_data->prefix_bits;
+  const uint64_t middle =
+      prefix_bits[begin] + (prefix_bits[end] - prefix_bits[begin]) / 2;
+  // First split whose first half has at least half of the bits
+  size_t low = begin + 1;
+  size_t high = end - 1;
+  while (low < high) {
+    const size_t split = low + (high - low) / 2;
+    if (prefix_bits[split] < middle) {
+      low = split + 1;
+    } else {
+      high = split;
+    }
+  }
+  // The previous split may be closer to the middle
+  if (low > begin + 1 && prefix_bits[low] >= middle &&
+      middle - prefix_bits[low - 1] < prefix_bits[low] - middle) {
+    --low;
+  }
+  return low;
+}
+
+static void reduction_serial(const shared_data_t* shared_data, mpz_ptr result,
+                             size_t begin, size_t end) {
+  mpz_t* numbers = shared_data->numbers;
+  if (end - begin == 1) {
+    mpz_set(result, numbers[begin]);
+  } else if (end - begin == 2) {
+    shared_data->operation(result, numbers[begin], numbers[begin + 1]);
+  } else {
+    const size_t split = reduction_split(shared_data, begin, end);
+    mpz_t second;
+    mpz_init(second);
+    reduction_serial(shared_data, result, begin, split);
+    reduction_serial(shared_data, second, split, end);
+    shared_data->operation(result, result, second);
+    mpz_clear(second);
+  }
+}
+
+static void reduction_run(shared_data_t* shared_data, reduction_deque_t* deque,
+                          reduction_node_t* node) {
+  const uint64_t* prefix_bits = shared_data->prefix_bits;
+  // Split while the node is large and its second half can be pushed. If the
+  // deque cannot grow, the rest of the node is calculated by this thread
+  while (node->end - node->begin > 1 &&
+         prefix_bits[node->end] - prefix_bits[node->begin] >
+             REDUCTION_LEAF_BITS &&
+         reduction_deque_reserve(deque) == EXIT_SUCCESS) {
+    const size_t split = reduction_split(shared_data, node->begin, node->end);
+    const size_t index = atomic_fetch_add(&shared_data->next_node, 2);
+    reduction_node_t* first = &shared_data->nodes[index];
+    reduction_node_t* second = &shared_data->nodes[index + 1];
+    first->begin = node->begin;
+    first->end = split;
+    second->begin = split;
+    second->end = node->end;
+    first->parent = second->parent = node;
+    mpz_init(first->value);
+    mpz_init(second->value);
+    node->children[0] = first;
+    node->children[1] = second;
+    atomic_init(&node->pending, 2);
+    pthread_mutex_lock(&deque->mutex);
+    deque->nodes[deque->bottom++] = second;
+    pthread_mutex_unlock(&deque->mutex);
+    // Wake an idle thread to steal the pushed half
+    pthread_mutex_lock(&shared_data->idle_mutex);
+    atomic_fetch_add(&shared_data->pushes, 1);
+    if (shared_data->idle_threads > 0) {
+      pthread_cond_signal(&shared_data->work_available);
+    }
+    pthread_mutex_unlock(&shared_data->idle_mutex);
+    node = first;
+  }
+  reduction_serial(shared_data, node->value, node->begin, node->end);
+  reduction_complete(shared_data, node);
+}
+
+static void reduction_complete(shared_data_t* shared_data,
+                               reduction_node_t* node) {
+  while (node->parent != NULL) {
+    reduction_node_t* parent = node->parent;
+    // The first half to finish leaves the combination to the other one
+    if (atomic_fetch_sub(&parent->pending, 1) != 1) {
+      return;
+    }
+    reduction_node_t* first = parent->children[0];
+    reduction_node_t* second = parent->children[1];
+    shared_data->operation(parent->value, first->value, second->value);
+    mpz_clear(first->value);
+    mpz_clear(second->value);
+    node = parent;
+  }
+  pthread_mutex_lock(&shared_data->idle_mutex);
+  atomic_store(&shared_data->done, true);
+  pthread_cond_broadcast(&shared_data->work_available);
+  pthread_mutex_unlock(&shared_data->idle_mutex);
+}
+
+static int reduction_deque_reserve(reduction_deque_t* deque) {
+  int error = EXIT_SUCCESS;
+  pthread_mutex_lock(&deque->mutex);
+  if (deque->bottom == deque->capacity) {
+    if (deque->top > 0) {
+      // Reuse room of stolen nodes
+      memmove(deque->nodes, deque->nodes + deque->top,
+              (deque->bottom - deque->top) * sizeof(reduction_node_t*));
+      deque->bottom -= deque->top;
+      deque->top = 0;
+    } else {
+      reduction_node_t** nodes = realloc(
+          deque->nodes, 2 * deque->capacity * sizeof(reduction_node_t*));
+      if (nodes) {
+        deque->nodes = nodes;
+        deque->capacity *= 2;
+      } else {
+        error = EXIT_FAILURE;
+      }
+    }
+  }
+  pthread_mutex_unlock(&deque->mutex);
+  return error;
+}
+
+static reduction_node_t* reduction_deque_pop(reduction_deque_t* deque) {
+  reduction_node_t* node = NULL;
+  pthread_mutex_lock(&deque->mutex);
+  if (deque->top < deque->bottom) {
+    node = deque->nodes[--deque->bottom];
+    if (deque->top == deque->bottom) {
+      deque->top = deque->bottom = 0;
+    }
+  }
+  pthread_mutex_unlock(&deque->mutex);
+  return node;
+}
+
+static reduction_node_t* reduction_deque_steal(reduction_deque_t* deque) {
+  reduction_node_t* node = NULL;
+  pthread_mutex_lock(&deque->mutex);
+  if (deque->top < deque->bottom) {
+    node = deque->nodes[deque->top++];
+    if (deque->top == deque->bottom) {
+      deque->top = deque->bottom = 0;
+    }
+  }
+  pthread_mutex_unlock(&deque->mutex);
+  return node;
+}
+
+static void* reduction_run_thread(void* data) {
+  assert(data);
+  private_data_t* private_data = (private_data_t*)data;
+  shared_data_t* shared_data = private_data->shared_data;
+  const size_t thread_number = private_data->thread_number;
+  reduction_deque_t* deque = &shared_data->deques[thread_number];
+  while (!atomic_load(&shared_data->done)) {
+    // A push after this load is not missed: the thread does not wait
+    const size_t pushes = atomic_load(&shared_data->pushes);
+    reduction_node_t* node = reduction_deque_pop(deque);
+    // Steal from the other threads in turn, starting from the next one
+    for (size_t offset = 1; node == NULL && offset < shared_data->thread_count;
+         ++offset) {
+      const size_t victim = (thread_number + offset) %
+                            shared_data->thread_count;
+      node = reduction_deque_steal(&shared_data->deques[victim]);
+    }
+    if (node) {
+      reduction_run(shared_data, deque, node);
+    } else {
+      // Wait for a push or the end, instead of spinning while the last
+      // operations of the tree are calculated by fewer threads
+      pthread_mutex_lock(&shared_data->idle_mutex);
+      ++shared_data->idle_threads;
+      while (!atomic_load(&shared_data->done) &&
+             atomic_load(&shared_data->pushes) == pushes) {
+        pthread_cond_wait(&shared_data->work_available,
+                          &shared_data->idle_mutex);
+      }
+      --shared_data->idle_threads;
+      pthread_mutex_unlock(&shared_data->idle_mutex);
+    }
+  }
+  return NULL;
+}
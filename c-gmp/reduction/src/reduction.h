@@ -0,0 +1,74 @@
+/**
+ * @file reduction.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Parallel product and sum of arrays of big integers. Header.
+ * @version 1.0.0
+ * @date 2022-06-27
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+#include <gmp.h>
+#include <stddef.h>
+
+/// Ranges of numbers with up to this many bits are combined by one thread
+#define REDUCTION_LEAF_BITS 65536
+
+/// Operation that combines the numbers of a reduction
+enum reduction_operation {
+  /// Product, with mpz_mul. The product of no numbers is 1
+  REDUCTION_PRODUCT,
+  /// Sum, with mpz_add. The sum of no numbers is 0
+  REDUCTION_SUM,
+};
+
+/**
+ * @brief Combine an array of numbers with a tree of operations calculated by
+ * threads.
+ * @remark Each node of the tree combines a range of numbers, and is split
+ * where the bits of both halves are about the same. So operands of each
+ * operation have similar sizes, and the last multiplications of a product
+ * are large and balanced, where GMP uses its fastest (FFT) algorithms.
+ * Ranges of up to REDUCTION_LEAF_BITS bits are combined by one thread.
+ * Each thread splits its node, keeps one half and pushes the other one to
+ * its own deque, so idle threads steal the largest pending ranges. The last
+ * thread to finish a half combines both halves, so no thread waits for
+ * another one. Threads without ranges to steal sleep until one is pushed.
+ *
+ * @param result Initialized result
+ * @param numbers Numbers to combine. They are not modified
+ * @param count Number of numbers
+ * @param operation Operation
+ * @param thread_count Threads, including the calling one. If 0, one per CPU
+ * @return Error code
+ */
+int reduction_reduce(mpz_t result, mpz_t numbers[], size_t count,
+                     enum reduction_operation operation, size_t thread_count);
+
+/**
+ * @brief Multiply an array of numbers with threads.
+ *
+ * @see reduction_reduce
+ */
+static inline int reduction_product(mpz_t result, mpz_t numbers[],
+                                    size_t count, size_t thread_count) {
+  return reduction_reduce(result, numbers, count, REDUCTION_PRODUCT,
+                          thread_count);
+}
+
+/**
+ * @brief Add an array of numbers with threads.
+ *
+ * @see reduction_reduce
+ */
+static inline int reduction_sum(mpz_t result, mpz_t numbers[], size_t count,
+                                size_t thread_count) {
+  return reduction_reduce(result, numbers, count, REDUCTION_SUM,
+                          thread_count);
+}
+
+#endif  // REDUCTION_H
@@ -0,0 +1,15 @@
+# Benchmarks. Each bench/*.c file is a program linked with the small_integers
+# objects, except the one that contains the main program.
+BENCH_DIR=bench
+BENCHSRC=$(wildcard $(BENCH_DIR)/*.c)
+BENCHEXE=$(BENCHSRC:$(BENCH_DIR)/%.c=$(BIN_DIR)/%)
+BENCHOBJ=$(filter-out $(OBJ_DIR)/small_integers.o,$(OBJECTS))
+
+.PHONY: bench
+# Megabytes per second of mpz_inp_str and of the reader, as CSV
+bench: FLAGS += -O3 -DNDEBUG
+bench: $(BENCHEXE)
+	$(BIN_DIR)/bench_number_reader $(BENCHARGS)
+
+$(BENCHEXE): $(BIN_DIR)/%: $(BENCH_DIR)/%.c $(BENCHOBJ) | $(BIN_DIR)/.
+	$(CC) $(FLAGC) $(INCLUDE) $^ -o $@ $(LIBS)
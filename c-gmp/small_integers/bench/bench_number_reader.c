@@ -0,0 +1,233 @@
+/**
+ * @file bench_number_reader.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Benchmark of the number reader against mpz_inp_str.
+ * @details Writes two temporary files of random decimal numbers: many short
+ * numbers, and a single long one. Each file is read with mpz_inp_str, as
+ * small_integers.c did, and then with the reader, mapped from the file and
+ * buffered from a pipe, with 1, 2, 4... threads up to thread_count. Prints a
+ * CSV row per input, source and thread count, with seconds, megabytes per
+ * second and speedup over mpz_inp_str. A checksum of the numbers read must
+ * match the one of mpz_inp_str.
+ * @version 1.0.0
+ * @date 2022-07-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <gmp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "number_reader.h"
+
+/// Default count of short numbers
+#define DEFAULT_COUNT 1000000
+
+/// Default digits of each short number
+#define DEFAULT_DIGITS 20
+
+/// Default digits of the long number
+#define DEFAULT_LONG_DIGITS 1000000
+
+/// Seed of random digits, so every run uses the same ones
+#define RANDOM_SEED 2022
+
+/// Prime whose remainders are combined in checksums
+#define CHECKSUM_PRIME 4294967291UL
+
+double get_duration(struct timespec stop_time, struct timespec start_time);
+
+/**
+ * @brief Write a temporary file of random decimal numbers, one per line.
+ *
+ * @param path Template of path, whose XXXXXX is replaced
+ * @param count Number count
+ * @param digits Digits of each number
+ * @return Byte count of file, or 0 on error
+ */
+size_t write_numbers(char* path, size_t count, size_t digits);
+
+/// Add a number to a checksum
+static inline uint64_t add_checksum(uint64_t checksum, mpz_t number) {
+  return checksum * 1000003 + mpz_fdiv_ui(number, CHECKSUM_PRIME);
+}
+
+/**
+ * @brief Read all numbers of a file with mpz_inp_str.
+ *
+ * @param path Path of file
+ * @param checksum Where the checksum of numbers is stored
+ * @return Elapsed seconds, or a negative value on error
+ */
+double read_mpz_inp_str(const char* path, uint64_t* checksum);
+
+/**
+ * @brief Read all numbers of a file with a number reader.
+ *
+ * @param path Path of file
+ * @param piped Read the file through a pipe, instead of mapping it
+ * @param thread_count Threads of the reader
+ * @param checksum Where the checksum of numbers is stored
+ * @return Elapsed seconds, or a negative value on error
+ */
+double read_number_reader(const char* path, bool piped, size_t thread_count,
+                          uint64_t* checksum);
+
+int main(int argc, char* argv[]) {
+  size_t count = DEFAULT_COUNT;
+  size_t digits = DEFAULT_DIGITS;
+  size_t long_digits = DEFAULT_LONG_DIGITS;
+  const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t max_threads = cpu_count > 1 ? (size_t)cpu_count : 2;
+  if ((argc >= 2 && sscanf(argv[1], "%zu", &count) != 1) ||
+      (argc >= 3 && sscanf(argv[2], "%zu", &digits) != 1) ||
+      (argc >= 4 && sscanf(argv[3], "%zu", &long_digits) != 1) ||
+      (argc >= 5 && sscanf(argv[4], "%zu", &max_threads) != 1) ||
+      count == 0 || digits == 0 || long_digits == 0 || max_threads == 0) {
+    fprintf(stderr,
+            "usage: %s [count] [digits] [long_digits] [thread_count]\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  char many_path[] = "/tmp/bench_number_reader_many_XXXXXX";
+  char long_path[] = "/tmp/bench_number_reader_long_XXXXXX";
+  const char* const paths[] = {many_path, long_path};
+  const char* const inputs[] = {"many", "long"};
+  size_t sizes[2] = {0, 0};
+  sizes[0] = write_numbers(many_path, count, digits);
+  sizes[1] = sizes[0] ? write_numbers(long_path, 1, long_digits) : 0;
+  int error = sizes[0] && sizes[1] ? EXIT_SUCCESS : EXIT_FAILURE;
+
+  printf("input,source,threads,bytes,seconds,mb_per_second,speedup\n");
+  for (size_t input = 0; input < 2 && error == EXIT_SUCCESS; ++input) {
+    uint64_t expected = 0;
+    const double baseline = read_mpz_inp_str(paths[input], &expected);
+    if (baseline < 0) {
+      error = EXIT_FAILURE;
+      break;
+    }
+    printf("%s,mpz_inp_str,1,%zu,%.6f,%.3f,1.000\n", inputs[input],
+           sizes[input], baseline, 1e-6 * sizes[input] / baseline);
+    fflush(stdout);
+    for (int piped = 0; piped < 2 && error == EXIT_SUCCESS; ++piped) {
+      // 1, 2, 4... threads, and then max_threads
+      for (size_t threads = 1; error == EXIT_SUCCESS;
+           threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+        uint64_t checksum = 0;
+        const double elapsed =
+            read_number_reader(paths[input], piped, threads, &checksum);
+        if (elapsed < 0 || checksum != expected) {
+          fprintf(stderr, "error: %s numbers read with %zu threads differ\n",
+                  inputs[input], threads);
+          error = EXIT_FAILURE;
+          break;
+        }
+        printf("%s,%s,%zu,%zu,%.6f,%.3f,%.3f\n", inputs[input],
+               piped ? "pipe" : "mmap", threads, sizes[input], elapsed,
+               1e-6 * sizes[input] / elapsed, baseline / elapsed);
+        fflush(stdout);
+        if (threads == max_threads) {
+          break;
+        }
+      }
+    }
+  }
+  for (size_t input = 0; input < 2; ++input) {
+    if (sizes[input]) {
+      unlink(paths[input]);
+    }
+  }
+  return error;
+}
+
+size_t write_numbers(char* path, size_t count, size_t digits) {
+  const int fd = mkstemp(path);
+  FILE* file = fd >= 0 ? fdopen(fd, "w") : NULL;
+  if (file == NULL) {
+    fprintf(stderr, "error: cannot create %s\n", path);
+    return 0;
+  }
+  srandom(RANDOM_SEED);
+  for (size_t number = 0; number < count; ++number) {
+    // No leading zeros, since they would make numbers octal
+    fputc('1' + random() % 9, file);
+    for (size_t digit = 1; digit < digits; ++digit) {
+      fputc('0' + random() % 10, file);
+    }
+    fputc('\n', file);
+  }
+  const long size = ftell(file);
+  if (fclose(file) != 0 || size <= 0) {
+    fprintf(stderr, "error: cannot write %s\n", path);
+    unlink(path);
+    return 0;
+  }
+  return (size_t)size;
+}
+
+double read_mpz_inp_str(const char* path, uint64_t* checksum) {
+  FILE* file = fopen(path, "r");
+  if (file == NULL) {
+    fprintf(stderr, "error: cannot open %s\n", path);
+    return -1.0;
+  }
+  struct timespec start, stop;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  mpz_t number;
+  mpz_init(number);
+  *checksum = 0;
+  while (mpz_inp_str(number, file, 0)) {
+    *checksum = add_checksum(*checksum, number);
+  }
+  mpz_clear(number);
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  fclose(file);
+  return get_duration(stop, start);
+}
+
+double read_number_reader(const char* path, bool piped, size_t thread_count,
+                          uint64_t* checksum) {
+  char command[128];
+  snprintf(command, sizeof(command), "cat %s", path);
+  FILE* file = piped ? popen(command, "r") : fopen(path, "r");
+  if (file == NULL) {
+    fprintf(stderr, "error: cannot open %s\n", path);
+    return -1.0;
+  }
+  // Creating the threads of the reader is timed too
+  struct timespec start, stop;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  number_reader_t* reader = number_reader_create(file, 0, thread_count);
+  bool failed = reader == NULL;
+  *checksum = 0;
+  size_t count = 0;
+  while (reader && (count = number_reader_next(reader)) > 0) {
+    for (size_t index = 0; index < count; ++index) {
+      *checksum = add_checksum(*checksum, reader->numbers[index]);
+    }
+  }
+  if (reader) {
+    failed = number_reader_failed(reader);
+    number_reader_destroy(reader);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  if (piped) {
+    pclose(file);
+  } else {
+    fclose(file);
+  }
+  return failed ? -1.0 : get_duration(stop, start);
+}
+
+// https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
+double get_duration(struct timespec stop_time, struct timespec start_time) {
+  return (stop_time.tv_sec + 1e-9 * stop_time.tv_nsec) -
+         (start_time.tv_sec + 1e-9 * start_time.tv_nsec);
+}
@@ -0,0 +1,616 @@
+/**
+ * @file number_reader.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Bulk reader of big integers from a stream. Implementation.
+ * @version 1.0.0
+ * @date 2022-07-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "number_reader.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Digits converted on the stack, longer numbers use the heap
+#define STACK_DIGITS 256
+
+/// Tokens taken at once by a thread
+#define TOKEN_CHUNK 64
+
+/// Minimum digits of each chunk of a long number
+#define MIN_CHUNK_DIGITS 16384
+
+/**
+ * @brief Chunks of a long number converted in parallel.
+ *
+ */
+typedef struct long_number {
+  /// Digits of the number, after sign and prefix
+  const char* text;
+  /// Digit count
+  size_t digits;
+  /// Base
+  int base;
+  /// Chunk count, a power of two
+  size_t chunk_count;
+  /// Digits of each chunk, except the most significant one that may be
+  /// shorter
+  size_t chunk_digits;
+  /// Value of each chunk, the least significant first. Then partial sums
+  mpz_t* chunks;
+  /// base^(chunk_digits * 2^level) for each level of the combination tree
+  mpz_t* powers;
+  /// Levels of the combination tree
+  size_t level_count;
+  /// Level being combined
+  size_t level;
+  /// Set if a chunk could not be converted
+  atomic_bool failed;
+} long_number_t;
+
+/**
+ * @brief Run a task on all threads of the pool, including the calling one,
+ * and wait until all of its items are done.
+ *
+ * @param reader Reader
+ * @param task Function that runs one item
+ * @param item_count Item count
+ * @param chunk_size Items taken at once by a thread
+ * @param context Context of the task
+ */
+static void number_reader_run(number_reader_t* reader,
+                              void (*task)(number_reader_t*, size_t),
+                              size_t item_count, size_t chunk_size,
+                              void* context);
+
+/**
+ * @brief Run items of the current task until there are no more.
+ *
+ * @param reader Reader
+ */
+static void number_reader_work(number_reader_t* reader);
+
+/**
+ * @brief Wait for tasks and run their items, until the reader stops.
+ *
+ * @param data Reader
+ * @return NULL
+ */
+static void* number_reader_run_thread(void* data);
+
+/**
+ * @brief Read more input into the buffer, keeping unread bytes. Waits for
+ * the first read only, then reads while input is already available.
+ *
+ * @param reader Reader whose data is buffered
+ * @return Error code
+ */
+static int number_reader_fill(number_reader_t* reader);
+
+/// Check if a character is white space, as isspace in the C locale
+static inline bool number_reader_is_space(char character) {
+  return character == ' ' || (character >= '\t' && character <= '\r');
+}
+
+/**
+ * @brief Value of an ASCII digit, as mpz_inp_str reads it.
+ *
+ * @param digit Digit
+ * @param base Base
+ * @return Value of digit, or base if it is not a digit of base
+ */
+static inline int number_reader_digit_value(char digit, int base);
+
+/**
+ * @brief Find the number that starts at a position, as mpz_inp_str reads it:
+ * an optional minus sign, a base prefix if base is 0, and the longest run of
+ * digits of the base. Characters after it start the next number.
+ *
+ * @param data Input
+ * @param start Position of number
+ * @param size Byte count of input
+ * @param base Base of reader, 0 to detect it from a prefix
+ * @param token Where significant digits, base and sign are stored
+ * @return Position after the number, or start if there is no number there
+ */
+static size_t number_reader_parse(const char* data, size_t start, size_t size,
+                                  int base, number_token_t* token);
+
+/**
+ * @brief Convert valid digits to a non-negative number with mpn_set_str.
+ *
+ * @param number Result
+ * @param text Digits, without leading zeros
+ * @param length Digit count
+ * @param base Base
+ * @return true on success, false if digits could not be allocated
+ */
+static bool number_reader_convert_digits(mpz_ptr number, const char* text,
+                                         size_t length, int base);
+
+/// Task that converts the token of each item, unless it is long
+static void number_reader_convert_token(number_reader_t* reader, size_t item);
+
+/// Task that converts chunk item of a long number, or computes powers of the
+/// base if item is the chunk count
+static void number_reader_convert_chunk(number_reader_t* reader, size_t item);
+
+/// Task that combines pair item of the current level of a long number
+static void number_reader_combine_chunks(number_reader_t* reader,
+                                         size_t item);
+
+/**
+ * @brief Convert the long number of a token with all threads.
+ *
+ * @param reader Reader
+ * @param item Index of token
+ * @return true on success, false if chunks could not be allocated
+ */
+static bool number_reader_convert_long(number_reader_t* reader, size_t item);
+
+number_reader_t* number_reader_create(FILE* stream, int base,
+                                      size_t thread_count) {
+  assert(stream);
+  assert(base == 0 || (base >= 2 && base <= 62));
+  number_reader_t* reader = calloc(1, sizeof(number_reader_t));
+  if (reader == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate reader\n");
+    return NULL;
+  }
+  if (thread_count == 0) {
+    const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    thread_count = cpu_count > 0 ? (size_t)cpu_count : 1;
+  }
+  reader->fd = fileno(stream);
+  reader->base = base;
+  for (size_t index = 0; index < NUMBER_READER_BATCH_NUMBERS; ++index) {
+    mpz_init(reader->numbers[index]);
+  }
+  // Map regular files, from the current position
+  struct stat status;
+  const off_t offset = lseek(reader->fd, 0, SEEK_CUR);
+  if (fstat(reader->fd, &status) == 0 && S_ISREG(status.st_mode) &&
+      offset >= 0 && status.st_size > offset) {
+    void* data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE,
+                      reader->fd, 0);
+    if (data != MAP_FAILED) {
+      madvise(data, status.st_size, MADV_SEQUENTIAL);
+      reader->data = data;
+      reader->mapped = true;
+      reader->size = status.st_size;
+      reader->position = offset;
+      reader->end_of_input = true;
+    }
+  }
+  if (!reader->mapped) {
+    reader->capacity = NUMBER_READER_BUFFER_SIZE;
+    reader->data = malloc(reader->capacity);
+  }
+  reader->thread_count = 1;
+  if (reader->data == NULL || pthread_mutex_init(&reader->mutex, NULL) != 0 ||
+      pthread_cond_init(&reader->task_started, NULL) != 0 ||
+      pthread_cond_init(&reader->task_finished, NULL) != 0) {
+    fprintf(stderr, "%s", "error: cannot allocate reader\n");
+    number_reader_destroy(reader);
+    return NULL;
+  }
+  reader->threads = malloc(thread_count * sizeof(pthread_t));
+  for (; reader->threads && reader->thread_count < thread_count;
+       ++reader->thread_count) {
+    if (pthread_create(&reader->threads[reader->thread_count - 1], NULL,
+                       number_reader_run_thread, reader) != 0) {
+      // Numbers are converted by the threads already created
+      fprintf(stderr, "error: cannot create thread %zu\n",
+              reader->thread_count);
+      break;
+    }
+  }
+  return reader;
+}
+
+void number_reader_destroy(number_reader_t* reader) {
+  if (reader == NULL) {
+    return;
+  }
+  if (reader->thread_count > 1) {
+    pthread_mutex_lock(&reader->mutex);
+    reader->stopping = true;
+    pthread_cond_broadcast(&reader->task_started);
+    pthread_mutex_unlock(&reader->mutex);
+    for (size_t index = 0; index + 1 < reader->thread_count; ++index) {
+      pthread_join(reader->threads[index], NULL);
+    }
+  }
+  if (reader->data) {
+    pthread_cond_destroy(&reader->task_finished);
+    pthread_cond_destroy(&reader->task_started);
+    pthread_mutex_destroy(&reader->mutex);
+  }
+  free(reader->threads);
+  if (reader->mapped) {
+    munmap(reader->data, reader->size);
+  } else {
+    free(reader->data);
+  }
+  for (size_t index = 0; index < NUMBER_READER_BATCH_NUMBERS; ++index) {
+    mpz_clear(reader->numbers[index]);
+  }
+  free(reader);
+}
+
+size_t number_reader_next(number_reader_t* reader) {
+  assert(reader);
+  if (reader->failed) {
+    return 0;
+  }
+  size_t count = 0;
+  bool incomplete = false;
+  bool invalid = false;
+  do {
+    // Refill when less than half of the buffer is left, or when the only
+    // number of the batch does not fit in the buffer
+    if (!reader->end_of_input &&
+        (incomplete ||
+         reader->size - reader->position < reader->capacity / 2)) {
+      if (number_reader_fill(reader) != EXIT_SUCCESS) {
+        reader->failed = true;
+        return 0;
+      }
+    }
+    incomplete = false;
+    const char* data = reader->data;
+    size_t position = reader->position;
+    while (count < NUMBER_READER_BATCH_NUMBERS) {
+      while (position < reader->size &&
+             number_reader_is_space(data[position])) {
+        ++position;
+      }
+      if (position == reader->size) {
+        incomplete = !reader->end_of_input;
+        break;
+      }
+      const size_t start = position;
+      position = number_reader_parse(data, start, reader->size, reader->base,
+                                     &reader->tokens[count]);
+      // A number at the end of data may continue in the next read
+      size_t end = position;
+      while (end < reader->size && !number_reader_is_space(data[end])) {
+        ++end;
+      }
+      if (end == reader->size && !reader->end_of_input) {
+        incomplete = true;
+        position = start;
+        break;
+      }
+      if (position == start) {
+        invalid = true;
+        break;
+      }
+      ++count;
+    }
+    reader->position = position;
+  } while (count == 0 && incomplete);
+
+  number_reader_run(reader, number_reader_convert_token, count, TOKEN_CHUNK,
+                    NULL);
+  for (size_t index = 0; index < count; ++index) {
+    // Long numbers are converted one at a time, each one by all threads
+    if (reader->tokens[index].length > NUMBER_READER_PARALLEL_DIGITS) {
+      reader->valid[index] = number_reader_convert_long(reader, index);
+    }
+    // Stop before the first number that could not be converted
+    if (!reader->valid[index]) {
+      reader->failed = true;
+      return index;
+    }
+  }
+  // Stop after the numbers before an invalid one
+  reader->failed = invalid;
+  return count;
+}
+
+static int number_reader_fill(number_reader_t* reader) {
+  assert(!reader->mapped);
+  memmove(reader->data, reader->data + reader->position,
+          reader->size - reader->position);
+  reader->size -= reader->position;
+  reader->position = 0;
+  if (reader->size == reader->capacity) {
+    char* data = realloc(reader->data, 2 * reader->capacity);
+    if (data == NULL) {
+      fprintf(stderr, "%s", "error: cannot allocate input buffer\n");
+      return EXIT_FAILURE;
+    }
+    reader->data = data;
+    reader->capacity *= 2;
+  }
+  // Numbers typed or written slowly to a pipe are converted as they come,
+  // while fast producers still fill the buffer
+  bool available = true;
+  while (available && reader->size < reader->capacity) {
+    const ssize_t bytes = read(reader->fd, reader->data + reader->size,
+                               reader->capacity - reader->size);
+    if (bytes < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("error: cannot read input");
+      return EXIT_FAILURE;
+    }
+    if (bytes == 0) {
+      reader->end_of_input = true;
+      break;
+    }
+    reader->size += bytes;
+    struct pollfd input = {reader->fd, POLLIN, 0};
+    available = poll(&input, 1, 0) > 0;
+  }
+  return EXIT_SUCCESS;
+}
+
+static inline int number_reader_digit_value(char digit, int base) {
+  if (digit >= '0' && digit <= '9') {
+    return digit - '0';
+  }
+  if (digit >= 'A' && digit <= 'Z') {
+    return digit - 'A' + 10;
+  }
+  if (digit >= 'a' && digit <= 'z') {
+    // Lower case digits are the same as upper case ones up to base 36
+    return digit - 'a' + (base <= 36 ? 10 : 36);
+  }
+  return base;
+}
+
+static size_t number_reader_parse(const char* data, size_t start, size_t size,
+                                  int base, number_token_t* token) {
+  size_t position = start;
+  token->negative = position < size && data[position] == '-';
+  if (token->negative) {
+    ++position;
+  }
+  token->base = base == 0 ? 10 : base;
+  if (position == size ||
+      number_reader_digit_value(data[position], token->base) >= token->base) {
+    return start;
+  }
+  if (base == 0 && data[position] == '0') {
+    token->base = 8;
+    ++position;
+    if (position < size && (data[position] == 'x' || data[position] == 'X')) {
+      token->base = 16;
+      ++position;
+    } else if (position < size &&
+               (data[position] == 'b' || data[position] == 'B')) {
+      token->base = 2;
+      ++position;
+    }
+  }
+  // Leading zeros do not change the value
+  while (position < size && data[position] == '0') {
+    ++position;
+  }
+  token->start = position;
+  while (position < size &&
+         number_reader_digit_value(data[position], token->base) <
+             token->base) {
+    ++position;
+  }
+  token->length = position - token->start;
+  return position;
+}
+
+static bool number_reader_convert_digits(mpz_ptr number, const char* text,
+                                         size_t length, int base) {
+  if (length == 0) {
+    mpz_set_ui(number, 0);
+    return true;
+  }
+  unsigned char stack_values[STACK_DIGITS];
+  unsigned char* values =
+      length <= STACK_DIGITS ? stack_values : malloc(length);
+  if (values == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate digits\n");
+    return false;
+  }
+  for (size_t index = 0; index < length; ++index) {
+    values[index] = (unsigned char)number_reader_digit_value(text[index], base);
+  }
+  // Room for the largest number of length digits, plus one limb
+  size_t bits_per_digit = 1;
+  while ((1 << bits_per_digit) < base) {
+    ++bits_per_digit;
+  }
+  const mp_size_t limb_count = length * bits_per_digit / GMP_NUMB_BITS + 2;
+  mp_limb_t* limbs = mpz_limbs_write(number, limb_count);
+  mpz_limbs_finish(number, mpn_set_str(limbs, values, length, base));
+  if (values != stack_values) {
+    free(values);
+  }
+  return true;
+}
+
+static void number_reader_convert_token(number_reader_t* reader,
+                                        size_t item) {
+  const number_token_t* token = &reader->tokens[item];
+  if (token->length > NUMBER_READER_PARALLEL_DIGITS) {
+    return;
+  }
+  mpz_ptr number = reader->numbers[item];
+  reader->valid[item] = number_reader_convert_digits(
+      number, reader->data + token->start, token->length, token->base);
+  if (token->negative) {
+    mpz_neg(number, number);
+  }
+}
+
+static bool number_reader_convert_long(number_reader_t* reader, size_t item) {
+  const number_token_t* token = &reader->tokens[item];
+  mpz_ptr number = reader->numbers[item];
+  long_number_t long_number;
+  long_number.text = reader->data + token->start;
+  long_number.digits = token->length;
+  long_number.base = token->base;
+  // A power of two of chunks, two per thread, of at least MIN_CHUNK_DIGITS
+  long_number.chunk_count = 1;
+  long_number.level_count = 0;
+  while (long_number.chunk_count < 2 * reader->thread_count &&
+         long_number.digits / (2 * long_number.chunk_count) >=
+             MIN_CHUNK_DIGITS) {
+    long_number.chunk_count *= 2;
+    ++long_number.level_count;
+  }
+  bool converted = true;
+  if (long_number.chunk_count == 1) {
+    converted = number_reader_convert_digits(number, long_number.text,
+                                             long_number.digits, token->base);
+  } else {
+    long_number.chunk_digits =
+        (long_number.digits + long_number.chunk_count - 1) /
+        long_number.chunk_count;
+    long_number.chunks = malloc(long_number.chunk_count * sizeof(mpz_t));
+    long_number.powers = malloc(long_number.level_count * sizeof(mpz_t));
+    if (long_number.chunks == NULL || long_number.powers == NULL) {
+      fprintf(stderr, "%s", "error: cannot allocate chunks\n");
+      free(long_number.chunks);
+      free(long_number.powers);
+      return false;
+    }
+    for (size_t chunk = 0; chunk < long_number.chunk_count; ++chunk) {
+      mpz_init(long_number.chunks[chunk]);
+    }
+    for (size_t level = 0; level < long_number.level_count; ++level) {
+      mpz_init(long_number.powers[level]);
+    }
+    atomic_init(&long_number.failed, false);
+    // Chunks and, meanwhile, powers of the base
+    number_reader_run(reader, number_reader_convert_chunk,
+                      long_number.chunk_count + 1, 1, &long_number);
+    // Each level adds the higher chunk of each pair times a power of the
+    // base to the lower one, halving the chunk count
+    for (size_t level = 0; level < long_number.level_count; ++level) {
+      long_number.level = level;
+      number_reader_run(reader, number_reader_combine_chunks,
+                        long_number.chunk_count >> (level + 1), 1,
+                        &long_number);
+    }
+    mpz_swap(number, long_number.chunks[0]);
+    for (size_t chunk = 0; chunk < long_number.chunk_count; ++chunk) {
+      mpz_clear(long_number.chunks[chunk]);
+    }
+    for (size_t level = 0; level < long_number.level_count; ++level) {
+      mpz_clear(long_number.powers[level]);
+    }
+    free(long_number.chunks);
+    free(long_number.powers);
+    converted = !atomic_load(&long_number.failed);
+  }
+  if (token->negative) {
+    mpz_neg(number, number);
+  }
+  return converted;
+}
+
+static void number_reader_convert_chunk(number_reader_t* reader,
+                                        size_t item) {
+  long_number_t* long_number = (long_number_t*)reader->context;
+  if (item == long_number->chunk_count) {
+    mpz_ui_pow_ui(long_number->powers[0], long_number->base,
+                  long_number->chunk_digits);
+    for (size_t level = 1; level < long_number->level_count; ++level) {
+      mpz_mul(long_number->powers[level], long_number->powers[level - 1],
+              long_number->powers[level - 1]);
+    }
+    return;
+  }
+  // Chunk 0 holds the least significant digits
+  const size_t end = long_number->digits - item * long_number->chunk_digits;
+  const size_t start =
+      end > long_number->chunk_digits ? end - long_number->chunk_digits : 0;
+  if (!number_reader_convert_digits(long_number->chunks[item],
+                                    long_number->text + start, end - start,
+                                    long_number->base)) {
+    atomic_store(&long_number->failed, true);
+  }
+}
+
+static void number_reader_combine_chunks(number_reader_t* reader,
+                                         size_t item) {
+  long_number_t* long_number = (long_number_t*)reader->context;
+  const size_t level = long_number->level;
+  const size_t lower = item << (level + 1);
+  const size_t higher = lower + ((size_t)1 << level);
+  mpz_addmul(long_number->chunks[lower], long_number->chunks[higher],
+             long_number->powers[level]);
+}
+
+static void number_reader_run(number_reader_t* reader,
+                              void (*task)(number_reader_t*, size_t),
+                              size_t item_count, size_t chunk_size,
+                              void* context) {
+  pthread_mutex_lock(&reader->mutex);
+  reader->task = task;
+  reader->item_count = item_count;
+  reader->context = context;
+  atomic_store(&reader->next_item, 0);
+  reader->chunk_size = chunk_size;
+  reader->busy_threads = reader->thread_count - 1;
+  ++reader->generation;
+  pthread_cond_broadcast(&reader->task_started);
+  pthread_mutex_unlock(&reader->mutex);
+  number_reader_work(reader);
+  pthread_mutex_lock(&reader->mutex);
+  while (reader->busy_threads > 0) {
+    pthread_cond_wait(&reader->task_finished, &reader->mutex);
+  }
+  pthread_mutex_unlock(&reader->mutex);
+}
+
+static void number_reader_work(number_reader_t* reader) {
+  const size_t chunk_size = reader->chunk_size;
+  size_t start = 0;
+  while ((start = atomic_fetch_add(&reader->next_item, chunk_size)) <
+         reader->item_count) {
+    const size_t stop = start + chunk_size < reader->item_count
+                            ? start + chunk_size
+                            : reader->item_count;
+    for (size_t item = start; item < stop; ++item) {
+      reader->task(reader, item);
+    }
+  }
+}
+
+static void* number_reader_run_thread(void* data) {
+  number_reader_t* reader = (number_reader_t*)data;
+  size_t generation = 0;
+  pthread_mutex_lock(&reader->mutex);
+  while (true) {
+    while (!reader->stopping && reader->generation == generation) {
+      pthread_cond_wait(&reader->task_started, &reader->mutex);
+    }
+    if (reader->stopping) {
+      break;
+    }
+    generation = reader->generation;
+    pthread_mutex_unlock(&reader->mutex);
+    number_reader_work(reader);
+    pthread_mutex_lock(&reader->mutex);
+    if (--reader->busy_threads == 0) {
+      pthread_cond_signal(&reader->task_finished);
+    }
+  }
+  pthread_mutex_unlock(&reader->mutex);
+  return NULL;
+}
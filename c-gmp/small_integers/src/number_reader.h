@@ -0,0 +1,146 @@
+/**
+ * @file number_reader.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Bulk reader of big integers from a stream. Header.
+ * @version 1.0.0
+ * @date 2022-07-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef NUMBER_READER_H
+#define NUMBER_READER_H
+
+#include <gmp.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/// Largest number of numbers in a batch
+#define NUMBER_READER_BATCH_NUMBERS 65536
+
+/// Bytes read at once when the input cannot be mapped, e.g. a pipe
+#define NUMBER_READER_BUFFER_SIZE (16 * 1024 * 1024)
+
+/// Numbers with more digits are converted by all threads
+#define NUMBER_READER_PARALLEL_DIGITS 200000
+
+/// Location of a number in the input
+typedef struct number_token {
+  /// First significant digit
+  size_t start;
+  /// Significant digit count
+  size_t length;
+  /// Base of digits
+  int base;
+  /// True if the number has a minus sign
+  bool negative;
+} number_token_t;
+
+/**
+ * @brief Reader of whitespace-separated numbers, in batches converted by a
+ * pool of threads.
+ * @remark Regular files are mapped to memory, other inputs are read in
+ * buffers of NUMBER_READER_BUFFER_SIZE bytes, that take the input available
+ * so far. Numbers of a batch are converted at once, each one by a thread,
+ * with mpn_set_str, which is subquadratic for long numbers. Numbers longer
+ * than NUMBER_READER_PARALLEL_DIGITS are split in chunks converted in
+ * parallel and combined with powers of the base.
+ *
+ */
+typedef struct number_reader {
+  /// File descriptor of input
+  int fd;
+  /// Base of numbers, from 2 to 62, or 0 to detect it as mpz_inp_str
+  int base;
+  /// Input bytes, mapped or buffered
+  char* data;
+  /// True if data is mapped to memory
+  bool mapped;
+  /// Bytes in data
+  size_t size;
+  /// Capacity of data, when it is buffered
+  size_t capacity;
+  /// Index of the first byte not tokenized yet
+  size_t position;
+  /// True when all input is in data
+  bool end_of_input;
+  /// True if an invalid number or an input error stopped the reader
+  bool failed;
+  /// Numbers of the last batch
+  mpz_t numbers[NUMBER_READER_BATCH_NUMBERS];
+  /// Tokens of the current batch
+  number_token_t tokens[NUMBER_READER_BATCH_NUMBERS];
+  /// Whether each number of the current batch could be converted
+  bool valid[NUMBER_READER_BATCH_NUMBERS];
+  /// Threads of the pool, besides the calling one
+  pthread_t* threads;
+  /// Thread count, including the calling one
+  size_t thread_count;
+  /// Protects the task fields below
+  pthread_mutex_t mutex;
+  /// Signaled when a task starts or the pool stops
+  pthread_cond_t task_started;
+  /// Signaled when the threads of a task finish
+  pthread_cond_t task_finished;
+  /// Incremented for each task, so threads know there is a new one
+  size_t generation;
+  /// Threads that have not finished the current task
+  size_t busy_threads;
+  /// True when threads must exit
+  bool stopping;
+  /// Runs one item of the current task
+  void (*task)(struct number_reader* reader, size_t item);
+  /// Item count of the current task
+  size_t item_count;
+  /// Items taken at once by a thread
+  size_t chunk_size;
+  /// Next item of the current task
+  atomic_size_t next_item;
+  /// Context of the current task
+  void* context;
+} number_reader_t;
+
+/**
+ * @brief Create a reader of numbers from a stream. The stream must not have
+ * been read, since the reader reads its file descriptor directly.
+ *
+ * @param stream Input stream
+ * @param base Base of numbers, from 2 to 62, or 0 to detect it from a prefix
+ * @param thread_count Threads, including the calling one. If 0, one per CPU
+ * @return Reader, or NULL on error
+ */
+number_reader_t* number_reader_create(FILE* stream, int base,
+                                      size_t thread_count);
+
+/**
+ * @brief Read the next batch of numbers into reader->numbers, in input order.
+ * Reading stops before the first invalid number, as mpz_inp_str.
+ *
+ * @param reader Reader
+ * @return Number count of the batch, 0 at end of input or on error
+ */
+size_t number_reader_next(number_reader_t* reader);
+
+/**
+ * @brief Check if reading stopped because of an invalid number or an input
+ * error, instead of the end of input.
+ *
+ * @param reader Reader
+ * @return true on error
+ */
+static inline bool number_reader_failed(const number_reader_t* reader) {
+  return reader->failed;
+}
+
+/**
+ * @brief Stop threads and release a reader.
+ *
+ * @param reader Reader
+ */
+void number_reader_destroy(number_reader_t* reader);
+
+#endif  // NUMBER_READER_H
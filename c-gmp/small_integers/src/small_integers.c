@@ -0,0 +1,45 @@
+/**
+ * @file small_integers.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief GMP example using small integers.
+ * @version 0.1
+ * @date 2022-05-03
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "number_reader.h"
+
+int main(int argc, char* argv[]) {
+  size_t thread_count = 0;
+  if (argc >= 2 && sscanf(argv[1], "%zu", &thread_count) != 1) {
+    fprintf(stderr, "usage: %s [thread_count] < numbers\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  // Numbers are read in batches, converted by thread_count threads
+  number_reader_t* reader = number_reader_create(stdin, 0, thread_count);
+  if (reader == NULL) {
+    return EXIT_FAILURE;
+  }
+  mp_size_t limb_count;
+  size_t count = 0;
+  while ((count = number_reader_next(reader)) > 0) {
+    for (size_t index = 0; index < count; ++index) {
+      mpz_ptr small_number = reader->numbers[index];
+      printf("number: ");
+      mpz_out_str(stdout, 10, small_number);
+      limb_count = mpz_size(small_number);
+      printf("\nsize: %zu limbs\n", limb_count);
+      for (mp_size_t limb = 0; limb < limb_count; ++limb) {
+        printf("limb %3zu: %lu\n", limb, mpz_getlimbn(small_number, limb));
+      }
+    }
+  }
+  number_reader_destroy(reader);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,434 @@
+/**
+ * @file bench_smallint.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Benchmark of smallint against int64 and mpz on arrays of mostly
+ * small values.
+ * @details Each operation is applied to count pairs of operands, storing
+ * every result. Operands are random 32-bit values, except a fraction of them
+ * per thousand that are of about 100 bits. int64 is only timed without big
+ * operands, and gives the lower bound of each operation. Prints a CSV row
+ * per operation, representation and fraction of big operands.
+ * @version 1.0.0
+ * @date 2022-06-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "smallint.h"
+
+/// Default number of operand pairs
+#define DEFAULT_COUNT 1000000
+
+/// Default timed runs of each operation
+#define DEFAULT_REPETITIONS 11
+
+/// Seed of random operands, so every run uses the same ones
+#define RANDOM_SEED 2022
+
+/// Bits of big operands
+#define BIG_BITS 100
+
+/// Operand pairs of arrays checked against mpz
+#define CHECK_COUNT 100000
+
+/// Benchmarked operations
+enum operation { ADD, SUB, MUL, DIV, MOD, OPERATION_COUNT };
+
+/// Names of operations
+static const char* const operation_names[] = {"add", "sub", "mul", "div",
+                                              "mod"};
+
+/// Big operands per thousand of each run
+static const size_t big_permilles[] = {0, 1, 10, 100};
+
+/// Operands and results in every representation
+typedef struct arrays {
+  /// Operand pair count
+  size_t count;
+  int64_t* first64;
+  int64_t* second64;
+  int64_t* result64;
+  smallint_t* first;
+  smallint_t* second;
+  smallint_t* result;
+  mpz_t* first_mpz;
+  mpz_t* second_mpz;
+  mpz_t* result_mpz;
+} arrays_t;
+
+double get_duration(struct timespec stop_time, struct timespec start_time);
+int arrays_init(arrays_t* arrays, size_t count);
+void arrays_fill(arrays_t* arrays, size_t big_permille,
+                 gmp_randstate_t random);
+void arrays_destroy(arrays_t* arrays);
+
+/**
+ * @brief Check smallint operations against mpz, on edge values and on the
+ * operands of arrays.
+ *
+ * @param arrays Arrays filled with operands
+ * @return Error code
+ */
+int check(arrays_t* arrays);
+
+/**
+ * @brief Apply an operation to every operand pair.
+ *
+ * @param arrays Arrays
+ * @param operation Operation
+ * @param representation 0 for int64, 1 for smallint, 2 for mpz
+ */
+void run(arrays_t* arrays, enum operation operation, int representation);
+
+int compare_doubles(const void* first, const void* second);
+
+int main(int argc, char* argv[]) {
+  size_t count = DEFAULT_COUNT;
+  size_t repetitions = DEFAULT_REPETITIONS;
+  if ((argc >= 2 && sscanf(argv[1], "%zu", &count) != 1) ||
+      (argc >= 3 && sscanf(argv[2], "%zu", &repetitions) != 1) ||
+      count == 0 || repetitions == 0) {
+    fprintf(stderr, "usage: %s [count] [repetitions]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  arrays_t arrays;
+  double* times = malloc(repetitions * sizeof(double));
+  if (times == NULL || arrays_init(&arrays, count) != EXIT_SUCCESS) {
+    fprintf(stderr, "%s", "error: cannot allocate operands\n");
+    free(times);
+    return EXIT_FAILURE;
+  }
+  gmp_randstate_t random;
+  gmp_randinit_default(random);
+  gmp_randseed_ui(random, RANDOM_SEED);
+  static const char* const representations[] = {"int64", "smallint", "mpz"};
+  int error = EXIT_SUCCESS;
+  printf("operation,representation,big_permille,count,min_ns,median_ns,"
+         "max_ns\n");
+  const size_t run_count = sizeof(big_permilles) / sizeof(big_permilles[0]);
+  for (size_t run_index = 0; run_index < run_count && error == EXIT_SUCCESS;
+       ++run_index) {
+    const size_t big_permille = big_permilles[run_index];
+    arrays_fill(&arrays, big_permille, random);
+    error = check(&arrays);
+    for (int operation = 0; operation < OPERATION_COUNT; ++operation) {
+      // Native integers cannot hold big operands
+      for (int representation = big_permille == 0 ? 0 : 1;
+           representation < 3; ++representation) {
+        for (size_t repetition = 0; repetition < repetitions; ++repetition) {
+          struct timespec start, stop;
+          clock_gettime(CLOCK_MONOTONIC, &start);
+          run(&arrays, operation, representation);
+          clock_gettime(CLOCK_MONOTONIC, &stop);
+          times[repetition] = 1e9 * get_duration(stop, start) / count;
+        }
+        qsort(times, repetitions, sizeof(double), compare_doubles);
+        printf("%s,%s,%zu,%zu,%.3f,%.3f,%.3f\n", operation_names[operation],
+               representations[representation], big_permille, count,
+               times[0], times[repetitions / 2], times[repetitions - 1]);
+        fflush(stdout);
+      }
+    }
+  }
+  gmp_randclear(random);
+  arrays_destroy(&arrays);
+  free(times);
+  return error;
+}
+
+int arrays_init(arrays_t* arrays, size_t count) {
+  memset(arrays, 0, sizeof(arrays_t));
+  arrays->count = count;
+  arrays->first64 = malloc(count * sizeof(int64_t));
+  arrays->second64 = malloc(count * sizeof(int64_t));
+  arrays->result64 = malloc(count * sizeof(int64_t));
+  arrays->first = malloc(count * sizeof(smallint_t));
+  arrays->second = malloc(count * sizeof(smallint_t));
+  arrays->result = malloc(count * sizeof(smallint_t));
+  arrays->first_mpz = malloc(count * sizeof(mpz_t));
+  arrays->second_mpz = malloc(count * sizeof(mpz_t));
+  arrays->result_mpz = malloc(count * sizeof(mpz_t));
+  if (arrays->first64 == NULL || arrays->second64 == NULL ||
+      arrays->result64 == NULL || arrays->first == NULL ||
+      arrays->second == NULL || arrays->result == NULL ||
+      arrays->first_mpz == NULL || arrays->second_mpz == NULL ||
+      arrays->result_mpz == NULL) {
+    arrays->count = 0;
+    arrays_destroy(arrays);
+    return EXIT_FAILURE;
+  }
+  for (size_t index = 0; index < count; ++index) {
+    smallint_init(&arrays->first[index]);
+    smallint_init(&arrays->second[index]);
+    smallint_init(&arrays->result[index]);
+    mpz_init(arrays->first_mpz[index]);
+    mpz_init(arrays->second_mpz[index]);
+    // Results of mpz have room for any result, so they do not reallocate
+    mpz_init2(arrays->result_mpz[index], 2 * BIG_BITS);
+  }
+  return EXIT_SUCCESS;
+}
+
+void arrays_fill(arrays_t* arrays, size_t big_permille,
+                 gmp_randstate_t random) {
+  mpz_t value;
+  mpz_init(value);
+  for (size_t index = 0; index < 2 * arrays->count; ++index) {
+    const size_t pair = index / 2;
+    if (gmp_urandomm_ui(random, 1000) < big_permille) {
+      mpz_urandomb(value, random, BIG_BITS);
+      mpz_setbit(value, BIG_BITS - 1);
+    } else {
+      // Nonzero values, so they can be divisors
+      mpz_set_si(value, (int32_t)gmp_urandomb_ui(random, 32) | 1);
+    }
+    if (gmp_urandomb_ui(random, 1)) {
+      mpz_neg(value, value);
+    }
+    int64_t* native = index % 2 ? &arrays->second64[pair]
+                                : &arrays->first64[pair];
+    *native = mpz_fits_slong_p(value) ? mpz_get_si(value) : 1;
+    smallint_set_mpz(index % 2 ? &arrays->second[pair] : &arrays->first[pair],
+                     value);
+    mpz_set(index % 2 ? arrays->second_mpz[pair] : arrays->first_mpz[pair],
+            value);
+  }
+  mpz_clear(value);
+}
+
+void arrays_destroy(arrays_t* arrays) {
+  for (size_t index = 0; index < arrays->count; ++index) {
+    smallint_clear(&arrays->first[index]);
+    smallint_clear(&arrays->second[index]);
+    smallint_clear(&arrays->result[index]);
+    mpz_clear(arrays->first_mpz[index]);
+    mpz_clear(arrays->second_mpz[index]);
+    mpz_clear(arrays->result_mpz[index]);
+  }
+  free(arrays->first64);
+  free(arrays->second64);
+  free(arrays->result64);
+  free(arrays->first);
+  free(arrays->second);
+  free(arrays->result);
+  free(arrays->first_mpz);
+  free(arrays->second_mpz);
+  free(arrays->result_mpz);
+}
+
+/**
+ * @brief Check one smallint operation against mpz, with a separate result
+ * and with the result being the first operand.
+ *
+ * @param operation Operation
+ * @param first First operand
+ * @param second Second operand
+ * @return Error code
+ */
+static int check_operation(enum operation operation, const smallint_t* first,
+                           const smallint_t* second) {
+  if (operation >= DIV && smallint_is_small(second) && second->small == 0) {
+    return EXIT_SUCCESS;
+  }
+  mpz_t first_mpz, second_mpz, expected, actual;
+  mpz_inits(first_mpz, second_mpz, expected, actual, NULL);
+  smallint_get_mpz(first_mpz, first);
+  smallint_get_mpz(second_mpz, second);
+  smallint_t result, aliased;
+  smallint_init(&result);
+  smallint_init(&aliased);
+  smallint_set(&aliased, first);
+  switch (operation) {
+    case ADD:
+      mpz_add(expected, first_mpz, second_mpz);
+      smallint_add(&result, first, second);
+      smallint_add(&aliased, &aliased, second);
+      break;
+    case SUB:
+      mpz_sub(expected, first_mpz, second_mpz);
+      smallint_sub(&result, first, second);
+      smallint_sub(&aliased, &aliased, second);
+      break;
+    case MUL:
+      mpz_mul(expected, first_mpz, second_mpz);
+      smallint_mul(&result, first, second);
+      smallint_mul(&aliased, &aliased, second);
+      break;
+    case DIV:
+      mpz_div(expected, first_mpz, second_mpz);
+      smallint_div(&result, first, second);
+      smallint_div(&aliased, &aliased, second);
+      break;
+    default:
+      mpz_mod(expected, first_mpz, second_mpz);
+      smallint_mod(&result, first, second);
+      smallint_mod(&aliased, &aliased, second);
+      break;
+  }
+  int error = EXIT_SUCCESS;
+  smallint_t expected_small;
+  smallint_init(&expected_small);
+  smallint_set_mpz(&expected_small, expected);
+  for (int index = 0; index < 2; ++index) {
+    const smallint_t* checked = index == 0 ? &result : &aliased;
+    smallint_get_mpz(actual, checked);
+    // Results that fit in int64 must be stored inline
+    if (mpz_cmp(actual, expected) != 0 ||
+        smallint_is_small(checked) != smallint_is_small(&expected_small)) {
+      gmp_fprintf(stderr, "error: %Zd %s %Zd is %Zd, expected %Zd\n",
+                  first_mpz, operation_names[operation], second_mpz, actual,
+                  expected);
+      error = EXIT_FAILURE;
+    }
+  }
+  smallint_clear(&expected_small);
+  smallint_clear(&aliased);
+  smallint_clear(&result);
+  mpz_clears(first_mpz, second_mpz, expected, actual, NULL);
+  return error;
+}
+
+int check(arrays_t* arrays) {
+  static const char* const edges[] = {
+      "0", "1", "-1", "2", "-2", "3", "-3", "4294967296", "-4294967296",
+      "9223372036854775807", "-9223372036854775807", "-9223372036854775808",
+      "9223372036854775808", "-9223372036854775809", "18446744073709551616",
+      "-18446744073709551616", "85070591730234615865843651857942052864"};
+  const size_t edge_count = sizeof(edges) / sizeof(edges[0]);
+  int error = EXIT_SUCCESS;
+  smallint_t first, second;
+  smallint_init(&first);
+  smallint_init(&second);
+  for (size_t index = 0; index < edge_count * edge_count; ++index) {
+    smallint_set_str(&first, edges[index / edge_count], 10);
+    smallint_set_str(&second, edges[index % edge_count], 10);
+    for (int operation = 0; operation < OPERATION_COUNT; ++operation) {
+      if (check_operation(operation, &first, &second) != EXIT_SUCCESS) {
+        error = EXIT_FAILURE;
+      }
+    }
+  }
+  smallint_clear(&first);
+  smallint_clear(&second);
+  for (size_t index = 0; index < arrays->count && index < CHECK_COUNT &&
+                         error == EXIT_SUCCESS;
+       ++index) {
+    for (int operation = 0; operation < OPERATION_COUNT; ++operation) {
+      if (check_operation(operation, &arrays->first[index],
+                          &arrays->second[index]) != EXIT_SUCCESS) {
+        error = EXIT_FAILURE;
+      }
+    }
+  }
+  return error;
+}
+
+void run(arrays_t* arrays, enum operation operation, int representation) {
+  const size_t count = arrays->count;
+  const int64_t* first64 = arrays->first64;
+  const int64_t* second64 = arrays->second64;
+  int64_t* result64 = arrays->result64;
+  const smallint_t* first = arrays->first;
+  const smallint_t* second = arrays->second;
+  smallint_t* result = arrays->result;
+  switch (representation * OPERATION_COUNT + operation) {
+    case ADD:
+      for (size_t index = 0; index < count; ++index) {
+        result64[index] = first64[index] + second64[index];
+      }
+      break;
+    case SUB:
+      for (size_t index = 0; index < count; ++index) {
+        result64[index] = first64[index] - second64[index];
+      }
+      break;
+    case MUL:
+      for (size_t index = 0; index < count; ++index) {
+        result64[index] = first64[index] * second64[index];
+      }
+      break;
+    case DIV:
+      for (size_t index = 0; index < count; ++index) {
+        result64[index] = first64[index] / second64[index];
+      }
+      break;
+    case MOD:
+      for (size_t index = 0; index < count; ++index) {
+        result64[index] = first64[index] % second64[index];
+      }
+      break;
+    case OPERATION_COUNT + ADD:
+      for (size_t index = 0; index < count; ++index) {
+        smallint_add(&result[index], &first[index], &second[index]);
+      }
+      break;
+    case OPERATION_COUNT + SUB:
+      for (size_t index = 0; index < count; ++index) {
+        smallint_sub(&result[index], &first[index], &second[index]);
+      }
+      break;
+    case OPERATION_COUNT + MUL:
+      for (size_t index = 0; index < count; ++index) {
+        smallint_mul(&result[index], &first[index], &second[index]);
+      }
+      break;
+    case OPERATION_COUNT + DIV:
+      for (size_t index = 0; index < count; ++index) {
+        smallint_div(&result[index], &first[index], &second[index]);
+      }
+      break;
+    case OPERATION_COUNT + MOD:
+      for (size_t index = 0; index < count; ++index) {
+        smallint_mod(&result[index], &first[index], &second[index]);
+      }
+      break;
+    case 2 * OPERATION_COUNT + ADD:
+      for (size_t index = 0; index < count; ++index) {
+        mpz_add(arrays->result_mpz[index], arrays->first_mpz[index],
+                arrays->second_mpz[index]);
+      }
+      break;
+    case 2 * OPERATION_COUNT + SUB:
+      for (size_t index = 0; index < count; ++index) {
+        mpz_sub(arrays->result_mpz[index], arrays->first_mpz[index],
+                arrays->second_mpz[index]);
+      }
+      break;
+    case 2 * OPERATION_COUNT + MUL:
+      for (size_t index = 0; index < count; ++index) {
+        mpz_mul(arrays->result_mpz[index], arrays->first_mpz[index],
+                arrays->second_mpz[index]);
+      }
+      break;
+    case 2 * OPERATION_COUNT + DIV:
+      for (size_t index = 0; index < count; ++index) {
+        mpz_div(arrays->result_mpz[index], arrays->first_mpz[index],
+                arrays->second_mpz[index]);
+      }
+      break;
+    default:
+      for (size_t index = 0; index < count; ++index) {
+        mpz_mod(arrays->result_mpz[index], arrays->first_mpz[index],
+                arrays->second_mpz[index]);
+      }
+      break;
+  }
+}
+
+int compare_doubles(const void* first, const void* second) {
+  const double difference = *(const double*)first - *(const double*)second;
+  return (difference > 0) - (difference < 0);
+}
+
+// https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
+double get_duration(struct timespec stop_time, struct timespec start_time) {
+  return (stop_time.tv_sec + 1e-9 * stop_time.tv_nsec) -
+         (start_time.tv_sec + 1e-9 * start_time.tv_nsec);
+}
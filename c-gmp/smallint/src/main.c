@@ -0,0 +1,75 @@
+/**
+ * @file main.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Arithmetic with integers that are int64 until they overflow, as the
+ * mpz operations of example/gmp.c.
+ * @version 1.0.0
+ * @date 2022-06-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "smallint.h"
+
+/// Test basic operations: +, -, *, div, mod
+void test_operations(smallint_t* num1, smallint_t* num2);
+/// Prints num1 operator num2 == result, and whether result is small
+void print_result(smallint_t* num1, const char* operator, smallint_t* num2,
+                  smallint_t* result);
+
+int main(void) {
+  int error = EXIT_SUCCESS;
+  smallint_t num1, num2;
+  smallint_init(&num1);
+  smallint_init(&num2);
+
+  smallint_set_si(&num1, -101);
+  smallint_set_si(&num2, 2);
+  test_operations(&num1, &num2);
+
+  // Read two arbitrary precision numbers as strings from stdin
+  char num1text[1024], num2text[1024];
+  if (scanf("%1023s %1023s", num1text, num2text) == 2) {
+    error += smallint_set_str(&num1, num1text, /*base*/ 10);
+    error += smallint_set_str(&num2, num2text, /*base*/ 10);
+    if (error == 0) {
+      test_operations(&num1, &num2);
+    } else {
+      fprintf(stderr, "invalid number\n");
+    }
+  }
+
+  smallint_clear(&num1);
+  smallint_clear(&num2);
+  return error;
+}
+
+void test_operations(smallint_t* num1, smallint_t* num2) {
+  smallint_t result;
+  smallint_init(&result);
+  smallint_add(&result, num1, num2);
+  print_result(num1, "+", num2, &result);
+  smallint_sub(&result, num1, num2);
+  print_result(num1, "-", num2, &result);
+  smallint_mul(&result, num1, num2);
+  print_result(num1, "*", num2, &result);
+  smallint_div(&result, num1, num2);
+  print_result(num1, "/", num2, &result);
+  smallint_mod(&result, num1, num2);
+  print_result(num1, "mod", num2, &result);
+  smallint_clear(&result);
+}
+
+void print_result(smallint_t* num1, const char* operator, smallint_t* num2,
+                  smallint_t* result) {
+  smallint_out_str(stdout, /*base*/ 10, num1);
+  fprintf(stdout, " %s ", operator);
+  smallint_out_str(stdout, /*base*/ 10, num2);
+  fprintf(stdout, " == ");
+  smallint_out_str(stdout, /*base*/ 10, result);
+  fprintf(stdout, " (%s)\n", smallint_is_small(result) ? "small" : "big");
+}
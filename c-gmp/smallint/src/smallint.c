@@ -0,0 +1,220 @@
+/**
+ * @file smallint.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Integers stored inline as int64 until they overflow, then as mpz.
+ * Implementation.
+ * @version 1.0.0
+ * @date 2022-06-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "smallint.h"
+
+#include <assert.h>
+
+/// Limbs needed to hold the magnitude of an int64 value
+#define SMALLINT_LIMBS ((64 + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS)
+
+/// An mpz operation with two operands, e.g. mpz_add
+typedef void (*mpz_operation_t)(mpz_ptr rop, mpz_srcptr op1, mpz_srcptr op2);
+
+/**
+ * @brief Get an mpz that can be read as the value of an integer. Small values
+ * are exposed with mpz_roinit_n, so no memory is allocated.
+ *
+ * @param number Integer
+ * @param view Storage of the mpz of a small value
+ * @param limbs Storage of the limbs of a small value
+ * @return Read-only mpz. It is valid while view, limbs and number are
+ */
+static mpz_srcptr smallint_view(const smallint_t* number, mpz_ptr view,
+                                mp_limb_t limbs[SMALLINT_LIMBS]) {
+  if (number->big != NULL) {
+    return number->big;
+  }
+  uint64_t magnitude = number->small < 0 ? 0 - (uint64_t)number->small
+                                         : (uint64_t)number->small;
+  mp_size_t size = 0;
+#if GMP_NUMB_BITS >= 64
+  if (magnitude != 0) {
+    limbs[size++] = magnitude;
+  }
+#else
+  for (; magnitude != 0; magnitude >>= GMP_NUMB_BITS) {
+    limbs[size++] = magnitude & GMP_NUMB_MASK;
+  }
+#endif
+  return mpz_roinit_n(view, limbs, number->small < 0 ? -size : size);
+}
+
+/**
+ * @brief Get the value of an mpz if it fits in int64.
+ *
+ * @param number Value
+ * @param value Where the int64 value is stored, if it fits
+ * @return Non-zero if the value fits in int64
+ */
+static int smallint_fits(mpz_srcptr number, int64_t* value) {
+  if (mpz_sizeinbase(number, 2) > 64) {
+    return 0;
+  }
+  uint64_t magnitude = 0;
+#if GMP_NUMB_BITS >= 64
+  magnitude = mpz_getlimbn(number, 0);
+#else
+  for (mp_size_t limb = mpz_size(number); limb-- > 0;) {
+    magnitude = magnitude << GMP_NUMB_BITS | mpz_getlimbn(number, limb);
+  }
+#endif
+  if (mpz_sgn(number) < 0) {
+    if (magnitude > (uint64_t)INT64_MAX + 1) {
+      return 0;
+    }
+    *value = magnitude == (uint64_t)INT64_MAX + 1 ? INT64_MIN
+                                                  : -(int64_t)magnitude;
+  } else {
+    if (magnitude > (uint64_t)INT64_MAX) {
+      return 0;
+    }
+    *value = (int64_t)magnitude;
+  }
+  return 1;
+}
+
+/**
+ * @brief Get the mpz of an integer, allocating it if the integer is small.
+ * The value of a newly allocated mpz is zero, not the small value.
+ *
+ * @param number Integer
+ * @return mpz owned by the integer
+ */
+static mpz_ptr smallint_promote(smallint_t* number) {
+  if (number->big == NULL) {
+    void* (*allocate)(size_t) = NULL;
+    mp_get_memory_functions(&allocate, NULL, NULL);
+    // GMP allocation functions do not return on failure
+    number->big = allocate(sizeof(__mpz_struct));
+    mpz_init(number->big);
+  }
+  return number->big;
+}
+
+/**
+ * @brief Store the value of an integer inline if it fits in int64.
+ *
+ * @param number Integer with a big value
+ */
+static void smallint_demote(smallint_t* number) {
+  int64_t value = 0;
+  if (smallint_fits(number->big, &value)) {
+    smallint_set_si(number, value);
+  }
+}
+
+/**
+ * @brief Apply an mpz operation to two integers, and store the result inline
+ * if it fits.
+ *
+ * @param rop Result. It may be an operand
+ * @param op1 First operand
+ * @param op2 Second operand
+ * @param operation mpz operation
+ */
+static void smallint_apply(smallint_t* rop, const smallint_t* op1,
+                           const smallint_t* op2, mpz_operation_t operation) {
+  mpz_t view1, view2;
+  mp_limb_t limbs1[SMALLINT_LIMBS], limbs2[SMALLINT_LIMBS];
+  // Views are taken before promoting rop, since rop may be an operand
+  mpz_srcptr value1 = smallint_view(op1, view1, limbs1);
+  mpz_srcptr value2 = smallint_view(op2, view2, limbs2);
+  operation(smallint_promote(rop), value1, value2);
+  smallint_demote(rop);
+}
+
+void smallint_release(smallint_t* number) {
+  assert(number->big != NULL);
+  void (*release)(void*, size_t) = NULL;
+  mp_get_memory_functions(NULL, NULL, &release);
+  mpz_clear(number->big);
+  release(number->big, sizeof(__mpz_struct));
+  number->big = NULL;
+  number->small = 0;
+}
+
+void smallint_set(smallint_t* rop, const smallint_t* op) {
+  if (op->big == NULL) {
+    smallint_set_si(rop, op->small);
+  } else if (rop != op) {
+    mpz_set(smallint_promote(rop), op->big);
+  }
+}
+
+void smallint_set_mpz(smallint_t* rop, mpz_srcptr op) {
+  int64_t value = 0;
+  if (smallint_fits(op, &value)) {
+    smallint_set_si(rop, value);
+  } else {
+    mpz_set(smallint_promote(rop), op);
+  }
+}
+
+void smallint_get_mpz(mpz_ptr rop, const smallint_t* op) {
+  mpz_t view;
+  mp_limb_t limbs[SMALLINT_LIMBS];
+  mpz_set(rop, smallint_view(op, view, limbs));
+}
+
+int smallint_set_str(smallint_t* rop, const char* str, int base) {
+  const int error = mpz_set_str(smallint_promote(rop), str, base);
+  smallint_demote(rop);
+  return error;
+}
+
+int smallint_cmp(const smallint_t* op1, const smallint_t* op2) {
+  if (op1->big == NULL && op2->big == NULL) {
+    return (op1->small > op2->small) - (op1->small < op2->small);
+  }
+  mpz_t view1, view2;
+  mp_limb_t limbs1[SMALLINT_LIMBS], limbs2[SMALLINT_LIMBS];
+  return mpz_cmp(smallint_view(op1, view1, limbs1),
+                 smallint_view(op2, view2, limbs2));
+}
+
+void smallint_add_big(smallint_t* rop, const smallint_t* op1,
+                      const smallint_t* op2) {
+  smallint_apply(rop, op1, op2, mpz_add);
+}
+
+void smallint_sub_big(smallint_t* rop, const smallint_t* op1,
+                      const smallint_t* op2) {
+  smallint_apply(rop, op1, op2, mpz_sub);
+}
+
+void smallint_mul_big(smallint_t* rop, const smallint_t* op1,
+                      const smallint_t* op2) {
+  smallint_apply(rop, op1, op2, mpz_mul);
+}
+
+void smallint_div_big(smallint_t* rop, const smallint_t* op1,
+                      const smallint_t* op2) {
+  smallint_apply(rop, op1, op2, mpz_fdiv_q);
+}
+
+void smallint_mod_big(smallint_t* rop, const smallint_t* op1,
+                      const smallint_t* op2) {
+  smallint_apply(rop, op1, op2, mpz_mod);
+}
+
+size_t smallint_inp_str(smallint_t* rop, FILE* stream, int base) {
+  const size_t read = mpz_inp_str(smallint_promote(rop), stream, base);
+  smallint_demote(rop);
+  return read;
+}
+
+size_t smallint_out_str(FILE* stream, int base, const smallint_t* op) {
+  mpz_t view;
+  mp_limb_t limbs[SMALLINT_LIMBS];
+  return mpz_out_str(stream, base, smallint_view(op, view, limbs));
+}
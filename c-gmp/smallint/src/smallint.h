@@ -0,0 +1,264 @@
+/**
+ * @file smallint.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Integers stored inline as int64 until they overflow, then as mpz.
+ * Header.
+ * @version 1.0.0
+ * @date 2022-06-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef SMALLINT_H
+#define SMALLINT_H
+
+#include <gmp.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Arbitrary precision integer with a fast path for small values.
+ * @remark Values that fit in int64 are stored in small and big is NULL.
+ * Operations on small values check overflow with __builtin_*_overflow, and
+ * only when it happens the result is promoted to a heap mpz_t. Results of
+ * operations on big values are demoted back to small when they fit, so
+ * later operations take the fast path again. Memory of big values comes
+ * from the GMP memory functions.
+ *
+ */
+typedef struct smallint {
+  /// Value, if big is NULL
+  int64_t small;
+  /// Value, if it does not fit in int64
+  mpz_ptr big;
+} smallint_t;
+
+/**
+ * @brief Initialize an integer to zero, as mpz_init. It does not allocate.
+ *
+ * @param number Integer
+ */
+static inline void smallint_init(smallint_t* number) {
+  number->small = 0;
+  number->big = NULL;
+}
+
+/**
+ * @brief Release memory of a big value, and leave the integer small.
+ *
+ * @param number Integer with a big value
+ */
+void smallint_release(smallint_t* number);
+
+/**
+ * @brief Release memory of an integer, as mpz_clear.
+ *
+ * @param number Integer
+ */
+static inline void smallint_clear(smallint_t* number) {
+  if (number->big != NULL) {
+    smallint_release(number);
+  }
+}
+
+/**
+ * @brief Check if an integer is stored inline.
+ *
+ * @param number Integer
+ * @return Non-zero if value fits in int64
+ */
+static inline int smallint_is_small(const smallint_t* number) {
+  return number->big == NULL;
+}
+
+/**
+ * @brief Set an integer from an int64 value, as mpz_set_si.
+ *
+ * @param rop Result
+ * @param value Value
+ */
+static inline void smallint_set_si(smallint_t* rop, int64_t value) {
+  if (rop->big != NULL) {
+    smallint_release(rop);
+  }
+  rop->small = value;
+}
+
+/**
+ * @brief Copy an integer, as mpz_set.
+ *
+ * @param rop Result
+ * @param op Integer
+ */
+void smallint_set(smallint_t* rop, const smallint_t* op);
+
+/**
+ * @brief Set an integer from an mpz value, as mpz_set.
+ *
+ * @param rop Result
+ * @param op Value
+ */
+void smallint_set_mpz(smallint_t* rop, mpz_srcptr op);
+
+/**
+ * @brief Copy the value of an integer to an mpz, as mpz_set.
+ *
+ * @param rop Initialized mpz result
+ * @param op Integer
+ */
+void smallint_get_mpz(mpz_ptr rop, const smallint_t* op);
+
+/**
+ * @brief Set an integer from a string, as mpz_set_str.
+ *
+ * @param rop Result
+ * @param str Null-terminated string
+ * @param base Base from 2 to 62, or 0 to detect it from a prefix
+ * @return 0 if the string is a valid number, -1 otherwise
+ */
+int smallint_set_str(smallint_t* rop, const char* str, int base);
+
+/**
+ * @brief Compare two integers, as mpz_cmp.
+ *
+ * @param op1 First integer
+ * @param op2 Second integer
+ * @return Positive if op1 > op2, zero if op1 == op2, or negative otherwise
+ */
+int smallint_cmp(const smallint_t* op1, const smallint_t* op2);
+
+/// Slow paths of operations, when an operand is big or the result overflows
+void smallint_add_big(smallint_t* rop, const smallint_t* op1,
+                      const smallint_t* op2);
+void smallint_sub_big(smallint_t* rop, const smallint_t* op1,
+                      const smallint_t* op2);
+void smallint_mul_big(smallint_t* rop, const smallint_t* op1,
+                      const smallint_t* op2);
+void smallint_div_big(smallint_t* rop, const smallint_t* op1,
+                      const smallint_t* op2);
+void smallint_mod_big(smallint_t* rop, const smallint_t* op1,
+                      const smallint_t* op2);
+
+/**
+ * @brief Set rop to op1 + op2, as mpz_add.
+ *
+ * @param rop Result. It may be an operand
+ * @param op1 First operand
+ * @param op2 Second operand
+ */
+static inline void smallint_add(smallint_t* rop, const smallint_t* op1,
+                                const smallint_t* op2) {
+  int64_t result;
+  if (op1->big == NULL && op2->big == NULL &&
+      !__builtin_add_overflow(op1->small, op2->small, &result)) {
+    smallint_set_si(rop, result);
+  } else {
+    smallint_add_big(rop, op1, op2);
+  }
+}
+
+/**
+ * @brief Set rop to op1 - op2, as mpz_sub.
+ *
+ * @param rop Result. It may be an operand
+ * @param op1 First operand
+ * @param op2 Second operand
+ */
+static inline void smallint_sub(smallint_t* rop, const smallint_t* op1,
+                                const smallint_t* op2) {
+  int64_t result;
+  if (op1->big == NULL && op2->big == NULL &&
+      !__builtin_sub_overflow(op1->small, op2->small, &result)) {
+    smallint_set_si(rop, result);
+  } else {
+    smallint_sub_big(rop, op1, op2);
+  }
+}
+
+/**
+ * @brief Set rop to op1 * op2, as mpz_mul.
+ *
+ * @param rop Result. It may be an operand
+ * @param op1 First operand
+ * @param op2 Second operand
+ */
+static inline void smallint_mul(smallint_t* rop, const smallint_t* op1,
+                                const smallint_t* op2) {
+  int64_t result;
+  if (op1->big == NULL && op2->big == NULL &&
+      !__builtin_mul_overflow(op1->small, op2->small, &result)) {
+    smallint_set_si(rop, result);
+  } else {
+    smallint_mul_big(rop, op1, op2);
+  }
+}
+
+/**
+ * @brief Set rop to op1 / op2 rounded towards minus infinity, as mpz_div.
+ *
+ * @param rop Result. It may be an operand
+ * @param op1 Dividend
+ * @param op2 Divisor. Must not be zero
+ */
+static inline void smallint_div(smallint_t* rop, const smallint_t* op1,
+                                const smallint_t* op2) {
+  // INT64_MIN / -1 is the only quotient of int64 values that overflows
+  if (op1->big == NULL && op2->big == NULL &&
+      (op1->small != INT64_MIN || op2->small != -1)) {
+    const int64_t quotient = op1->small / op2->small;
+    const int64_t remainder = op1->small % op2->small;
+    smallint_set_si(rop, quotient - (remainder != 0 &&
+                                     (remainder < 0) != (op2->small < 0)));
+  } else {
+    smallint_div_big(rop, op1, op2);
+  }
+}
+
+/**
+ * @brief Set rop to op1 mod op2, always non-negative, as mpz_mod.
+ *
+ * @param rop Result. It may be an operand
+ * @param op1 Dividend
+ * @param op2 Divisor. Must not be zero
+ */
+static inline void smallint_mod(smallint_t* rop, const smallint_t* op1,
+                                const smallint_t* op2) {
+  if (op2->big == NULL && op2->small == -1) {
+    // Any integer mod -1 is zero, and INT64_MIN % -1 overflows
+    smallint_set_si(rop, 0);
+  } else if (op1->big == NULL && op2->big == NULL) {
+    const int64_t remainder = op1->small % op2->small;
+    // Add |op2| to negative remainders without a branch, since signs are
+    // hard to predict. It cannot overflow, since remainder > -|op2|
+    const uint64_t magnitude = op2->small < 0 ? 0 - (uint64_t)op2->small
+                                              : (uint64_t)op2->small;
+    smallint_set_si(rop, (int64_t)((uint64_t)remainder +
+                                   ((uint64_t)(remainder >> 63) & magnitude)));
+  } else {
+    smallint_mod_big(rop, op1, op2);
+  }
+}
+
+/**
+ * @brief Read an integer from a stream, as mpz_inp_str.
+ *
+ * @param rop Result
+ * @param stream Input stream
+ * @param base Base from 2 to 62, or 0 to detect it from a prefix
+ * @return Bytes read, or 0 on error
+ */
+size_t smallint_inp_str(smallint_t* rop, FILE* stream, int base);
+
+/**
+ * @brief Write an integer to a stream, as mpz_out_str.
+ *
+ * @param stream Output stream
+ * @param base Base from 2 to 62, or from -2 to -36 for upper case digits
+ * @param op Integer
+ * @return Bytes written, or 0 on error
+ */
+size_t smallint_out_str(FILE* stream, int base, const smallint_t* op);
+
+#endif  // SMALLINT_H
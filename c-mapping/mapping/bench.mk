@@ -0,0 +1,29 @@
+# Benchmarks. Each bench/*.c file is a program linked with the simulation
+# objects, except the one that contains the main program.
+BENCH_DIR=bench
+BENCHSRC=$(wildcard $(BENCH_DIR)/*.c)
+BENCHEXE=$(BENCHSRC:$(BENCH_DIR)/%.c=$(BIN_DIR)/%)
+BENCHOBJ=$(filter-out $(OBJ_DIR)/main.o,$(OBJECTS))
+
+.PHONY: bench bench_mapping bench_evaluate bench_load_search
+bench: FLAGS += -O3 -DNDEBUG
+bench: $(BENCHEXE)
+	$(BIN_DIR)/bench_dynamic $(BENCHARGS)
+
+# Throughput of the simulation on synthetic workloads, as CSV
+bench_mapping: FLAGS += -O3 -DNDEBUG
+bench_mapping: $(BENCHEXE)
+	$(BIN_DIR)/bench_mapping $(BENCHARGS)
+
+# Evaluations per second of the library API, reusing mapping data or not
+bench_evaluate: FLAGS += -O3 -DNDEBUG
+bench_evaluate: $(BENCHEXE)
+	$(BIN_DIR)/bench_evaluate $(BENCHARGS)
+
+# Searches per second of argmin and argmax kernels, for each worker count
+bench_load_search: FLAGS += -O3 -DNDEBUG
+bench_load_search: $(BENCHEXE)
+	$(BIN_DIR)/bench_load_search $(BENCHARGS)
+
+$(BENCHEXE): $(BIN_DIR)/%: $(BENCH_DIR)/%.c $(BENCHOBJ) | $(BIN_DIR)/.
+	$(CC) $(FLAGC) $(INCLUDE) $^ -o $@ $(LIBS)
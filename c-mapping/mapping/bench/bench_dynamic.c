@@ -0,0 +1,118 @@
+/**
+ * @file bench_dynamic.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Benchmark of dynamic mapping: linear argmin versus worker heap.
+ * @details Linear argmin uses the load search kernel selected for this CPU.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "load_search.h"
+#include "worker_heap.h"
+
+/// Default number of units to map
+#define DEFAULT_UNIT_COUNT 100000
+
+/// Minimum worker count
+#define MIN_WORKER_COUNT 4
+
+/// Maximum worker count
+#define MAX_WORKER_COUNT 65536
+
+/// Maximum value of a random unit
+#define MAX_UNIT_VALUE 100
+
+double get_duration(struct timespec stop_time, struct timespec start_time);
+double map_linear(const size_t* units, size_t unit_count, size_t* loads,
+                  size_t worker_count, size_t* units_workers);
+double map_heap(const size_t* units, size_t unit_count, size_t* loads,
+                size_t worker_count, size_t* units_workers);
+
+int main(int argc, char* argv[]) {
+  size_t unit_count = DEFAULT_UNIT_COUNT;
+  if (argc >= 2 && sscanf(argv[1], "%zu", &unit_count) != 1) {
+    fprintf(stderr, "usage: %s [unit_count]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  size_t* units = malloc(unit_count * sizeof(size_t));
+  size_t* linear_workers = malloc(unit_count * sizeof(size_t));
+  size_t* heap_workers = malloc(unit_count * sizeof(size_t));
+  size_t* loads = malloc(MAX_WORKER_COUNT * sizeof(size_t));
+  if (!units || !linear_workers || !heap_workers || !loads) {
+    fprintf(stderr, "%s", "error: cannot allocate benchmark arrays\n");
+    return EXIT_FAILURE;
+  }
+  unsigned int seed = 1;
+  for (size_t unit_index = 0; unit_index < unit_count; ++unit_index) {
+    units[unit_index] = 1 + rand_r(&seed) % MAX_UNIT_VALUE;
+  }
+  printf("%zu units\n", unit_count);
+  printf("%10s %12s %12s %8s\n", "workers", "linear (s)", "heap (s)",
+         "ratio");
+  int error = EXIT_SUCCESS;
+  for (size_t worker_count = MIN_WORKER_COUNT;
+       worker_count <= MAX_WORKER_COUNT; worker_count *= 2) {
+    double linear = map_linear(units, unit_count, loads, worker_count,
+                               linear_workers);
+    double heap = map_heap(units, unit_count, loads, worker_count,
+                           heap_workers);
+    printf("%10zu %12.6f %12.6f %8.2f\n", worker_count, linear, heap,
+           linear / heap);
+    if (memcmp(linear_workers, heap_workers, unit_count * sizeof(size_t))) {
+      fprintf(stderr, "error: mappings differ for %zu workers\n",
+              worker_count);
+      error = EXIT_FAILURE;
+    }
+  }
+  free(loads);
+  free(heap_workers);
+  free(linear_workers);
+  free(units);
+  return error;
+}
+
+double map_linear(const size_t* units, size_t unit_count, size_t* loads,
+                  size_t worker_count, size_t* units_workers) {
+  struct timespec start, stop;
+  memset(loads, 0, worker_count * sizeof(size_t));
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t unit_index = 0; unit_index < unit_count; ++unit_index) {
+    const size_t argmin = load_search_argmin(loads, worker_count);
+    units_workers[unit_index] = argmin;
+    loads[argmin] += units[unit_index];
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  return get_duration(stop, start);
+}
+
+double map_heap(const size_t* units, size_t unit_count, size_t* loads,
+                size_t worker_count, size_t* units_workers) {
+  struct timespec start, stop;
+  worker_heap_t heap;
+  memset(loads, 0, worker_count * sizeof(size_t));
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  if (worker_heap_init(&heap, loads, worker_count) == EXIT_SUCCESS) {
+    for (size_t unit_index = 0; unit_index < unit_count; ++unit_index) {
+      units_workers[unit_index] =
+          worker_heap_add_to_top(&heap, units[unit_index]);
+    }
+    worker_heap_destroy(&heap);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  return get_duration(stop, start);
+}
+
+// https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
+double get_duration(struct timespec stop_time, struct timespec start_time) {
+  return (stop_time.tv_sec + 1e-9 * stop_time.tv_nsec) -
+         (start_time.tv_sec + 1e-9 * start_time.tv_nsec);
+}
@@ -0,0 +1,134 @@
+/**
+ * @file bench_evaluate.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Benchmark of in-process evaluations: reused versus new mapping data.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mapping.h"
+#include "workload.h"
+
+/// Default number of units of each evaluation
+#define DEFAULT_UNIT_COUNT 1000
+
+/// Default worker count
+#define DEFAULT_WORKER_COUNT 16
+
+/// Minimum duration of each measurement, in seconds
+#define MIN_DURATION 0.5
+
+double get_duration(struct timespec stop_time, struct timespec start_time);
+
+/**
+ * @brief Evaluate units repeatedly until MIN_DURATION elapses.
+ *
+ * @param units Unit array
+ * @param unit_count Unit count
+ * @param params Parameters
+ * @param reuse True to reuse mapping data, false to create it every time
+ * @param rate Where evaluations per second are stored
+ * @return Error code
+ */
+int measure(const size_t* units, size_t unit_count,
+            const mapping_params_t* params, int reuse, double* rate);
+
+int main(int argc, char* argv[]) {
+  size_t unit_count = DEFAULT_UNIT_COUNT;
+  mapping_params_t params;
+  mapping_init_params(&params);
+  params.worker_count = DEFAULT_WORKER_COUNT;
+  if ((argc >= 2 && sscanf(argv[1], "%zu", &unit_count) != 1) ||
+      (argc >= 3 && sscanf(argv[2], "%zu", &params.worker_count) != 1)) {
+    fprintf(stderr, "usage: %s [unit_count] [worker_count]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  size_t* units = malloc((unit_count + 1) * sizeof(size_t));
+  if (units == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate units\n");
+    return EXIT_FAILURE;
+  }
+  printf("%zu units, %zu workers\n", unit_count, params.worker_count);
+  printf("%12s %16s %16s %8s\n", "distribution", "new (eval/s)",
+         "reused (eval/s)", "ratio");
+  int error = EXIT_SUCCESS;
+  for (size_t distribution = 0;
+       distribution < WORKLOAD_DISTRIBUTION_COUNT && error == EXIT_SUCCESS;
+       ++distribution) {
+    workload_t workload;
+    error = workload_init(&workload, distribution, unit_count, 1);
+    if (error == EXIT_SUCCESS) {
+      for (size_t unit_index = 0; unit_index < unit_count; ++unit_index) {
+        units[unit_index] = workload_next(&workload);
+      }
+      workload_destroy(&workload);
+    }
+    double fresh = 0.0;
+    double reused = 0.0;
+    if (error == EXIT_SUCCESS) {
+      error = measure(units, unit_count, &params, 0, &fresh);
+    }
+    if (error == EXIT_SUCCESS) {
+      error = measure(units, unit_count, &params, 1, &reused);
+    }
+    if (error == EXIT_SUCCESS) {
+      printf("%12s %16.0f %16.0f %8.2f\n", workload_name(distribution), fresh,
+             reused, reused / fresh);
+    }
+  }
+  free(units);
+  return error;
+}
+
+int measure(const size_t* units, size_t unit_count,
+            const mapping_params_t* params, int reuse, double* rate) {
+  const size_t mapping_count = mapping_get_count();
+  mapping_outcome_t* outcomes =
+      calloc(mapping_count, sizeof(mapping_outcome_t));
+  mapping_t* mapping = reuse ? mapping_create() : NULL;
+  if (outcomes == NULL || (reuse && mapping == NULL)) {
+    fprintf(stderr, "%s", "error: cannot allocate evaluation\n");
+    free(outcomes);
+    return EXIT_FAILURE;
+  }
+  int error = EXIT_SUCCESS;
+  size_t evaluations = 0;
+  double duration = 0.0;
+  struct timespec start, stop;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  while (duration < MIN_DURATION && error == EXIT_SUCCESS) {
+    if (!reuse) {
+      mapping = mapping_create();
+    }
+    error = mapping
+                ? mapping_evaluate(mapping, units, unit_count, params, outcomes)
+                : EXIT_FAILURE;
+    if (!reuse && mapping) {
+      mapping_destroy(mapping);
+      mapping = NULL;
+    }
+    ++evaluations;
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    duration = get_duration(stop, start);
+  }
+  if (mapping) {
+    mapping_destroy(mapping);
+  }
+  free(outcomes);
+  *rate = evaluations / duration;
+  return error;
+}
+
+// https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
+double get_duration(struct timespec stop_time, struct timespec start_time) {
+  return (stop_time.tv_sec + 1e-9 * stop_time.tv_nsec) -
+         (start_time.tv_sec + 1e-9 * start_time.tv_nsec);
+}
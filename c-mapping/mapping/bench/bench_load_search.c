@@ -0,0 +1,158 @@
+/**
+ * @file bench_load_search.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Benchmark of argmin and argmax kernels over worker loads.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "load_search.h"
+
+/// Default number of searches for each worker count and kernel
+#define DEFAULT_SEARCH_COUNT 1000000
+
+/// Minimum worker count
+#define MIN_WORKER_COUNT 4
+
+/// Maximum worker count
+#define MAX_WORKER_COUNT 65536
+
+/// Number of random arrays checked against the scalar kernel
+#define CHECK_COUNT 10000
+
+/// Loads of checked arrays are small, so there are many ties
+#define CHECK_MAX_LOAD 8
+
+double get_duration(struct timespec stop_time, struct timespec start_time);
+
+/**
+ * @brief Check that a kernel finds the same workers as the scalar kernel.
+ *
+ * @param kernel Kernel
+ * @param loads Array of MAX_WORKER_COUNT loads
+ * @return Error code
+ */
+int check(enum load_search_kernel kernel, size_t* loads);
+
+/**
+ * @brief Measure searches of a kernel over loads.
+ *
+ * @param kernel Kernel
+ * @param loads Load array
+ * @param worker_count Worker count
+ * @param search_count Number of argmin and of argmax searches
+ * @return Searches per second
+ */
+double measure(enum load_search_kernel kernel, size_t* loads,
+               size_t worker_count, size_t search_count);
+
+int main(int argc, char* argv[]) {
+  size_t search_count = DEFAULT_SEARCH_COUNT;
+  if (argc >= 2 && sscanf(argv[1], "%zu", &search_count) != 1) {
+    fprintf(stderr, "usage: %s [search_count]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  size_t* loads = malloc(MAX_WORKER_COUNT * sizeof(size_t));
+  if (loads == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate loads\n");
+    return EXIT_FAILURE;
+  }
+  const enum load_search_kernel selected = load_search_get_kernel();
+  printf("selected kernel: %s\n", load_search_get_name(selected));
+  int error = EXIT_SUCCESS;
+  size_t kernel_count = 0;
+  enum load_search_kernel kernels[LOAD_SEARCH_KERNEL_COUNT];
+  for (int kernel = 0; kernel < LOAD_SEARCH_KERNEL_COUNT; ++kernel) {
+    if (load_search_set_kernel(kernel) == EXIT_SUCCESS) {
+      kernels[kernel_count++] = kernel;
+      if (check(kernel, loads) != EXIT_SUCCESS) {
+        error = EXIT_FAILURE;
+      }
+    }
+  }
+  printf("%10s", "workers");
+  for (size_t index = 0; index < kernel_count; ++index) {
+    printf(" %16s", load_search_get_name(kernels[index]));
+  }
+  printf("  (searches/s)\n");
+  unsigned int seed = 1;
+  for (size_t worker_index = 0; worker_index < MAX_WORKER_COUNT;
+       ++worker_index) {
+    loads[worker_index] = rand_r(&seed);
+  }
+  for (size_t worker_count = MIN_WORKER_COUNT;
+       worker_count <= MAX_WORKER_COUNT; worker_count *= 2) {
+    // Same amount of loads visited for every worker count
+    size_t searches = search_count * MIN_WORKER_COUNT / worker_count;
+    searches = searches > 0 ? searches : 1;
+    printf("%10zu", worker_count);
+    for (size_t index = 0; index < kernel_count; ++index) {
+      printf(" %16.0f", measure(kernels[index], loads, worker_count, searches));
+    }
+    putchar('\n');
+  }
+  load_search_set_kernel(selected);
+  free(loads);
+  return error;
+}
+
+int check(enum load_search_kernel kernel, size_t* loads) {
+  int error = EXIT_SUCCESS;
+  unsigned int seed = 2;
+  for (size_t check_index = 0; check_index < CHECK_COUNT; ++check_index) {
+    const size_t worker_count = 1 + rand_r(&seed) % 100;
+    for (size_t worker_index = 0; worker_index < worker_count;
+         ++worker_index) {
+      // Some loads use the highest bit, to check unsigned comparisons
+      loads[worker_index] = rand_r(&seed) % CHECK_MAX_LOAD;
+      if (check_index % 2) {
+        loads[worker_index] += SIZE_MAX - CHECK_MAX_LOAD;
+      }
+    }
+    load_search_set_kernel(LOAD_SEARCH_SCALAR);
+    const size_t argmin = load_search_argmin(loads, worker_count);
+    const size_t argmax = load_search_argmax(loads, worker_count);
+    load_search_set_kernel(kernel);
+    if (load_search_argmin(loads, worker_count) != argmin ||
+        load_search_argmax(loads, worker_count) != argmax) {
+      fprintf(stderr, "error: %s kernel differs for %zu workers\n",
+              load_search_get_name(kernel), worker_count);
+      error = EXIT_FAILURE;
+      break;
+    }
+  }
+  return error;
+}
+
+double measure(enum load_search_kernel kernel, size_t* loads,
+               size_t worker_count, size_t search_count) {
+  load_search_set_kernel(kernel);
+  struct timespec start, stop;
+  size_t sink = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t search = 0; search < search_count; ++search) {
+    // Change a load so searches cannot be hoisted out of the loop
+    loads[search % worker_count] += sink & 1;
+    sink += load_search_argmin(loads, worker_count);
+    sink += load_search_argmax(loads, worker_count);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  if (sink == SIZE_MAX) {
+    putchar(' ');
+  }
+  return 2.0 * search_count / get_duration(stop, start);
+}
+
+// https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
+double get_duration(struct timespec stop_time, struct timespec start_time) {
+  return (stop_time.tv_sec + 1e-9 * stop_time.tv_nsec) -
+         (start_time.tv_sec + 1e-9 * start_time.tv_nsec);
+}
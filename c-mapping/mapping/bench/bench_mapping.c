@@ -0,0 +1,262 @@
+/**
+ * @file bench_mapping.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Throughput benchmark of the mapping simulation on synthetic
+ * workloads.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mapping.h"
+#include "workload.h"
+#include "writer.h"
+
+/// Smallest unit count is 10^MIN_EXPONENT
+#define MIN_EXPONENT 3
+
+/// Default largest unit count is 10^DEFAULT_MAX_EXPONENT
+#define DEFAULT_MAX_EXPONENT 6
+
+/// Largest unit count that can be requested is 10^MAX_EXPONENT
+#define MAX_EXPONENT 9
+
+/// Seed of generated workloads
+#define SEED 1
+
+/// Maximum number of arguments passed to the simulation
+#define MAX_ARGUMENTS 64
+
+/// Size of buffer for profile reports of one run
+#define REPORT_CAPACITY 8192
+
+/// Maximum number of profiled phases
+#define MAX_PHASES 32
+
+/// Maximum length of a phase name
+#define MAX_PHASE_NAME 48
+
+/**
+ * @brief Result of one run of the simulation.
+ *
+ */
+typedef struct run {
+  /// Wall-clock time of the whole run, in seconds
+  double elapsed;
+  /// Peak resident set size, in KiB
+  long peak_rss;
+  /// Number of profiled phases
+  size_t phase_count;
+  /// Phase names, e.g. "read" or "assign_BLOCK"
+  char phases[MAX_PHASES][MAX_PHASE_NAME];
+  /// Elapsed time of each phase, in seconds
+  double seconds[MAX_PHASES];
+} run_t;
+
+double get_duration(struct timespec stop_time, struct timespec start_time);
+int write_workload(int fd, enum workload_distribution distribution,
+                   size_t unit_count);
+int run_mapping(int fd, int argc, char* argv[], run_t* run);
+void parse_report(char* report, run_t* run);
+void print_run(const char* distribution, size_t unit_count, const run_t* run,
+               bool header);
+
+int main(int argc, char* argv[]) {
+  int max_exponent = DEFAULT_MAX_EXPONENT;
+  if ((argc >= 2 && sscanf(argv[1], "%d", &max_exponent) != 1) ||
+      max_exponent < MIN_EXPONENT || max_exponent > MAX_EXPONENT ||
+      argc > MAX_ARGUMENTS) {
+    fprintf(stderr, "usage: %s [max_exponent] [mapping options...]\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  // Simulation arguments: program name, --profile, and the rest
+  char* arguments[MAX_ARGUMENTS + 1] = {"mapping", "--profile"};
+  int argument_count = 2;
+  for (int index = 2; index < argc; ++index) {
+    arguments[argument_count++] = argv[index];
+  }
+  arguments[argument_count] = NULL;
+  char path[] = "/tmp/bench_mapping_XXXXXX";
+  const int fd = mkstemp(path);
+  if (fd < 0) {
+    perror("error: cannot create workload file");
+    return EXIT_FAILURE;
+  }
+  unlink(path);
+  int error = EXIT_SUCCESS;
+  bool header = true;
+  for (size_t distribution = 0;
+       distribution < WORKLOAD_DISTRIBUTION_COUNT && error == EXIT_SUCCESS;
+       ++distribution) {
+    size_t unit_count = 1;
+    for (int exponent = 0; exponent < MIN_EXPONENT; ++exponent) {
+      unit_count *= 10;
+    }
+    for (int exponent = MIN_EXPONENT;
+         exponent <= max_exponent && error == EXIT_SUCCESS;
+         ++exponent, unit_count *= 10) {
+      run_t run;
+      error = write_workload(fd, distribution, unit_count);
+      if (error == EXIT_SUCCESS) {
+        error = run_mapping(fd, argument_count, arguments, &run);
+      }
+      if (error == EXIT_SUCCESS) {
+        print_run(workload_name(distribution), unit_count, &run, header);
+        header = false;
+      }
+    }
+  }
+  close(fd);
+  return error;
+}
+
+int write_workload(int fd, enum workload_distribution distribution,
+                   size_t unit_count) {
+  workload_t workload;
+  writer_t writer;
+  if (ftruncate(fd, 0) != 0 || lseek(fd, 0, SEEK_SET) != 0) {
+    perror("error: cannot truncate workload file");
+    return EXIT_FAILURE;
+  }
+  int error = workload_init(&workload, distribution, unit_count, SEED);
+  if (error == EXIT_SUCCESS) {
+    error = writer_open(&writer, fd);
+    for (size_t unit_index = 0;
+         unit_index < unit_count && writer.error == EXIT_SUCCESS;
+         ++unit_index) {
+      writer_put_size(&writer, workload_next(&workload));
+      writer_put_char(&writer, '\n');
+    }
+    if (writer_close(&writer) != EXIT_SUCCESS) {
+      error = EXIT_FAILURE;
+    }
+    workload_destroy(&workload);
+  }
+  // The simulation reads the file from its current offset
+  if (lseek(fd, 0, SEEK_SET) != 0) {
+    error = EXIT_FAILURE;
+  }
+  return error;
+}
+
+int run_mapping(int fd, int argc, char* argv[], run_t* run) {
+  int report_pipe[2];
+  if (pipe(report_pipe) != 0) {
+    perror("error: cannot create pipe");
+    return EXIT_FAILURE;
+  }
+  struct timespec start, stop;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  // A child process runs the simulation, so its peak RSS can be measured
+  const pid_t pid = fork();
+  if (pid == 0) {
+    const int null_fd = open("/dev/null", O_WRONLY);
+    dup2(fd, STDIN_FILENO);
+    dup2(null_fd, STDOUT_FILENO);
+    dup2(report_pipe[1], STDERR_FILENO);
+    close(report_pipe[0]);
+    close(report_pipe[1]);
+    int error = EXIT_FAILURE;
+    mapping_t* mapping = mapping_create();
+    if (mapping) {
+      error = mapping_run(mapping, argc, argv);
+      mapping_destroy(mapping);
+    }
+    fflush(stderr);
+    _exit(error);
+  }
+  close(report_pipe[1]);
+  if (pid < 0) {
+    perror("error: cannot create process");
+    close(report_pipe[0]);
+    return EXIT_FAILURE;
+  }
+  char report[REPORT_CAPACITY];
+  size_t size = 0;
+  ssize_t bytes = 0;
+  while ((bytes = read(report_pipe[0], report + size,
+                       REPORT_CAPACITY - 1 - size)) > 0) {
+    size += bytes;
+  }
+  report[size] = '\0';
+  close(report_pipe[0]);
+  int status = 0;
+  struct rusage usage;
+  wait4(pid, &status, 0, &usage);
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  run->elapsed = get_duration(stop, start);
+  run->peak_rss = usage.ru_maxrss;
+  parse_report(report, run);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+    fprintf(stderr, "%s", report);
+    fprintf(stderr, "%s", "error: simulation failed\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+void parse_report(char* report, run_t* run) {
+  run->phase_count = 0;
+  for (char* line = strtok(report, "\n"); line; line = strtok(NULL, "\n")) {
+    // Lines are "profile <phase> [<mapping>] <seconds>"
+    char phase[MAX_PHASE_NAME / 2] = "";
+    char name[MAX_PHASE_NAME / 2] = "";
+    char seconds[MAX_PHASE_NAME] = "";
+    const int fields = sscanf(line, "profile %23s %23s %47s", phase, name,
+                              seconds);
+    if (fields < 2 || run->phase_count == MAX_PHASES) {
+      fprintf(stderr, "%s\n", line);
+      continue;
+    }
+    char* phase_name = run->phases[run->phase_count];
+    if (fields == 2) {
+      snprintf(phase_name, MAX_PHASE_NAME, "%s", phase);
+      run->seconds[run->phase_count] = atof(name);
+    } else {
+      snprintf(phase_name, MAX_PHASE_NAME, "%s_%s", phase, name);
+      run->seconds[run->phase_count] = atof(seconds);
+    }
+    ++run->phase_count;
+  }
+}
+
+void print_run(const char* distribution, size_t unit_count, const run_t* run,
+               bool header) {
+  // Columns of phases are taken from the first run
+  if (header) {
+    printf("%s", "distribution,units,seconds,units_per_second,peak_rss_kib");
+    for (size_t phase = 0; phase < run->phase_count; ++phase) {
+      printf(",%s", run->phases[phase]);
+    }
+    printf("\n");
+  }
+  printf("%s,%zu,%.6lf,%.0lf,%ld", distribution, unit_count, run->elapsed,
+         unit_count / run->elapsed, run->peak_rss);
+  for (size_t phase = 0; phase < run->phase_count; ++phase) {
+    printf(",%.6lf", run->seconds[phase]);
+  }
+  printf("\n");
+  fflush(stdout);
+}
+
+// https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
+double get_duration(struct timespec stop_time, struct timespec start_time) {
+  return (stop_time.tv_sec + 1e-9 * stop_time.tv_nsec) -
+         (start_time.tv_sec + 1e-9 * start_time.tv_nsec);
+}
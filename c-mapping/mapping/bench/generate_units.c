@@ -0,0 +1,69 @@
+/**
+ * @file generate_units.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Generator of synthetic workloads for the mapping simulation.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "workload.h"
+#include "writer.h"
+
+/// Default seed of pseudo-random number generator
+#define DEFAULT_SEED 1
+
+/**
+ * @brief Print usage and available distributions.
+ *
+ * @param program Program name
+ */
+void print_usage(const char* program);
+
+int main(int argc, char* argv[]) {
+  size_t unit_count = 0;
+  unsigned long long seed = DEFAULT_SEED;
+  enum workload_distribution distribution = WORKLOAD_DISTRIBUTION_COUNT;
+  if (argc >= 3) {
+    distribution = workload_find(argv[1]);
+  }
+  if (distribution == WORKLOAD_DISTRIBUTION_COUNT ||
+      sscanf(argv[2], "%zu", &unit_count) != 1 ||
+      (argc >= 4 && sscanf(argv[3], "%llu", &seed) != 1)) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  workload_t workload;
+  writer_t writer;
+  int error = workload_init(&workload, distribution, unit_count, seed);
+  if (error == EXIT_SUCCESS) {
+    error = writer_open(&writer, STDOUT_FILENO);
+    for (size_t unit_index = 0;
+         unit_index < unit_count && writer.error == EXIT_SUCCESS;
+         ++unit_index) {
+      writer_put_size(&writer, workload_next(&workload));
+      writer_put_char(&writer, '\n');
+    }
+    if (writer_close(&writer) != EXIT_SUCCESS) {
+      error = EXIT_FAILURE;
+    }
+    workload_destroy(&workload);
+  }
+  return error;
+}
+
+void print_usage(const char* program) {
+  fprintf(stderr, "usage: %s distribution unit_count [seed]\n", program);
+  fprintf(stderr, "%s", "distributions:");
+  for (size_t distribution = 0; distribution < WORKLOAD_DISTRIBUTION_COUNT;
+       ++distribution) {
+    fprintf(stderr, " %s", workload_name(distribution));
+  }
+  fprintf(stderr, "%s", "\n");
+}
@@ -0,0 +1,101 @@
+/**
+ * @file event_queue.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Discrete-event simulation of workers. Implementation.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "event_queue.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Compare two workers by idle time, then by index.
+ *
+ * @param queue Queue
+ * @param first First worker index
+ * @param second Second worker index
+ * @return true if first worker goes before second worker
+ */
+static inline bool event_queue_less(const event_queue_t* queue, size_t first,
+                                    size_t second) {
+  return queue->times[first] < queue->times[second] ||
+         (queue->times[first] == queue->times[second] && first < second);
+}
+
+/**
+ * @brief Move worker at heap position down until heap order is restored.
+ *
+ * @param queue Queue
+ * @param position Heap position
+ */
+static void event_queue_sift_down(event_queue_t* queue, size_t position) {
+  size_t* workers = queue->workers;
+  const size_t worker = workers[position];
+  while (true) {
+    size_t child = 2 * position + 1;
+    if (child >= queue->worker_count) {
+      break;
+    }
+    if (child + 1 < queue->worker_count &&
+        event_queue_less(queue, workers[child + 1], workers[child])) {
+      ++child;
+    }
+    if (!event_queue_less(queue, workers[child], worker)) {
+      break;
+    }
+    workers[position] = workers[child];
+    position = child;
+  }
+  workers[position] = worker;
+}
+
+int event_queue_init(event_queue_t* queue, double* times, const double* speeds,
+                     size_t worker_count, double overhead) {
+  assert(queue);
+  assert(times);
+  assert(speeds);
+  assert(worker_count > 0);
+  int error = EXIT_SUCCESS;
+  queue->worker_count = worker_count;
+  queue->times = times;
+  queue->speeds = speeds;
+  queue->overhead = overhead;
+  queue->workers = malloc(worker_count * sizeof(size_t));
+  if (queue->workers) {
+    for (size_t worker_index = 0; worker_index < worker_count;
+         ++worker_index) {
+      queue->workers[worker_index] = worker_index;
+    }
+    for (size_t position = worker_count / 2; position > 0; --position) {
+      event_queue_sift_down(queue, position - 1);
+    }
+  } else {
+    fprintf(stderr, "%s", "error: cannot allocate event queue\n");
+    error = EXIT_FAILURE;
+  }
+  return error;
+}
+
+size_t event_queue_dispatch(event_queue_t* queue, size_t work) {
+  assert(queue);
+  // Next event: worker on top becomes idle and takes the work
+  const size_t worker = queue->workers[0];
+  queue->times[worker] +=
+      queue->overhead + (double)work / queue->speeds[worker];
+  event_queue_sift_down(queue, 0);
+  return worker;
+}
+
+void event_queue_destroy(event_queue_t* queue) {
+  assert(queue);
+  free(queue->workers);
+  queue->workers = NULL;
+}
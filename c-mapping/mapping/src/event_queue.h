@@ -0,0 +1,67 @@
+/**
+ * @file event_queue.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Discrete-event simulation of workers. Header.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stddef.h>
+
+/**
+ * @brief Queue of events "worker becomes idle", ordered by time.
+ * @details The next dispatch goes to the worker that becomes idle first,
+ * lowest index on ties. A dispatch of work w keeps the worker busy for
+ * overhead + w / speed. With unit speeds and no overhead, times are the
+ * loads of the workers and the choice is the same as a worker heap.
+ *
+ */
+typedef struct event_queue {
+  /// Worker count
+  size_t worker_count;
+  /// Time at which each worker becomes idle. Not owned by the queue
+  double* times;
+  /// Speed factor of each worker. Not owned by the queue
+  const double* speeds;
+  /// Time spent by a worker on each dispatch, besides its work
+  double overhead;
+  /// Worker indexes in heap order
+  size_t* workers;
+} event_queue_t;
+
+/**
+ * @brief Initialize a queue over existing worker times.
+ *
+ * @param queue Queue to initialize
+ * @param times Time array of worker_count elements. It must outlive the queue
+ * @param speeds Speed array of worker_count positive elements
+ * @param worker_count Worker count. Must be greater than zero
+ * @param overhead Time of each dispatch
+ * @return Error code
+ */
+int event_queue_init(event_queue_t* queue, double* times, const double* speeds,
+                     size_t worker_count, double overhead);
+
+/**
+ * @brief Dispatch work to the worker that becomes idle first.
+ *
+ * @param queue Queue
+ * @param work Work, in time units of a worker of speed 1
+ * @return Index of the worker that received the work
+ */
+size_t event_queue_dispatch(event_queue_t* queue, size_t work);
+
+/**
+ * @brief Release queue memory. Times and speeds are not released.
+ *
+ * @param queue Queue
+ */
+void event_queue_destroy(event_queue_t* queue);
+
+#endif  // EVENT_QUEUE_H
@@ -0,0 +1,339 @@
+/**
+ * @file executor.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Execution of mappings with threads. Implementation.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "executor.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "worker_ids.h"
+
+/// Minimum duration of calibration, in seconds
+#define CALIBRATION_DURATION 0.01
+
+/**
+ * @brief Data shared by all threads of an execution.
+ *
+ */
+typedef struct shared_data {
+  /// Executor
+  const executor_t* executor;
+  /// Protects start condition
+  pthread_mutex_t start_mutex;
+  /// Signaled when threads can start
+  pthread_cond_t start_condition;
+  /// True when threads can start
+  bool started;
+  /// True if threads must finish without doing any work
+  bool cancelled;
+  /// Start of units of each worker in unit order, for static mappings
+  size_t* offsets;
+  /// Unit indexes grouped by worker, for static mappings
+  size_t* order;
+  /// Index of next unit to take, for dynamic mapping
+  atomic_size_t next_unit;
+  /// Number of units taken at once, for dynamic mapping
+  size_t chunk_size;
+} shared_data_t;
+
+/**
+ * @brief Data of each thread.
+ *
+ */
+typedef struct private_data {
+  /// Thread number, i.e., worker index
+  size_t thread_number;
+  /// Shared data
+  shared_data_t* shared_data;
+  /// Result of busy work, so it cannot be optimized away
+  size_t sink;
+} private_data_t;
+
+/// Results of busy work are added here
+static volatile size_t executor_sink = 0;
+
+/**
+ * @brief Busy work of a number of dependent iterations.
+ *
+ * @param iterations Iteration count
+ * @return Value that depends on every iteration
+ */
+static size_t executor_spin(size_t iterations);
+
+/**
+ * @brief Wait until all threads are created and the timer starts.
+ *
+ * @param shared_data Shared data
+ * @return true if thread must do its work
+ */
+static bool executor_wait_start(shared_data_t* shared_data);
+
+/**
+ * @brief Run threads and measure wall-clock time until all of them finish.
+ *
+ * @param shared_data Shared data
+ * @param routine Thread routine
+ * @param elapsed Where elapsed time in seconds is stored
+ * @return Error code
+ */
+static int executor_run_threads(shared_data_t* shared_data,
+                                void* (*routine)(void*), double* elapsed);
+
+/**
+ * @brief Execute units of one worker of a static mapping.
+ *
+ * @param data Private data
+ * @return NULL
+ */
+static void* executor_run_static_thread(void* data);
+
+/**
+ * @brief Execute chunks of units taken from the shared counter.
+ *
+ * @param data Private data
+ * @return NULL
+ */
+static void* executor_run_dynamic_thread(void* data);
+
+static double get_duration(struct timespec stop_time,
+                           struct timespec start_time);
+
+static size_t executor_spin(size_t iterations) {
+  size_t value = iterations;
+  for (size_t iteration = 0; iteration < iterations; ++iteration) {
+    value = value * 6364136223846793005u + 1442695040888963407u;
+  }
+  return value;
+}
+
+void executor_init(executor_t* executor, const size_t* units,
+                   size_t unit_count, size_t worker_count, double unit_time) {
+  assert(executor);
+  executor->units = units;
+  executor->unit_count = unit_count;
+  executor->worker_count = worker_count;
+  // Double iterations until busy work takes long enough to be measured
+  struct timespec start, stop;
+  double duration = 0.0;
+  size_t iterations = 1024;
+  while (true) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    executor_sink += executor_spin(iterations);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    duration = get_duration(stop, start);
+    if (duration >= CALIBRATION_DURATION) {
+      break;
+    }
+    iterations *= 2;
+  }
+  double iterations_per_unit = unit_time * 1e-9 * iterations / duration;
+  executor->iterations_per_unit =
+      iterations_per_unit < 1.0 ? 1 : (size_t)(iterations_per_unit + 0.5);
+}
+
+double executor_run_serial(const executor_t* executor) {
+  assert(executor);
+  struct timespec start, stop;
+  size_t sink = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t unit_index = 0; unit_index < executor->unit_count;
+       ++unit_index) {
+    sink += executor_spin(executor->units[unit_index] *
+                          executor->iterations_per_unit);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  executor_sink += sink;
+  return get_duration(stop, start);
+}
+
+int executor_run_static(const executor_t* executor, const void* units_workers,
+                        size_t worker_width, double* elapsed) {
+  assert(executor);
+  assert(units_workers);
+  int error = EXIT_SUCCESS;
+  shared_data_t shared_data;
+  shared_data.executor = executor;
+  shared_data.offsets = calloc(executor->worker_count + 1, sizeof(size_t));
+  shared_data.order = malloc((executor->unit_count + 1) * sizeof(size_t));
+  if (shared_data.offsets && shared_data.order) {
+    // Group units by worker (counting sort), so each thread only visits
+    // its own units
+    size_t* offsets = shared_data.offsets;
+    for (size_t unit_index = 0; unit_index < executor->unit_count;
+         ++unit_index) {
+      ++offsets[worker_ids_get(units_workers, worker_width, unit_index) + 1];
+    }
+    for (size_t worker_index = 0; worker_index < executor->worker_count;
+         ++worker_index) {
+      offsets[worker_index + 1] += offsets[worker_index];
+    }
+    for (size_t unit_index = 0; unit_index < executor->unit_count;
+         ++unit_index) {
+      const size_t worker_index =
+          worker_ids_get(units_workers, worker_width, unit_index);
+      shared_data.order[offsets[worker_index]++] = unit_index;
+    }
+    // Offsets were moved to the end of each group, shift them back
+    for (size_t worker_index = executor->worker_count; worker_index > 0;
+         --worker_index) {
+      offsets[worker_index] = offsets[worker_index - 1];
+    }
+    offsets[0] = 0;
+    error = executor_run_threads(&shared_data, executor_run_static_thread,
+                                 elapsed);
+  } else {
+    fprintf(stderr, "%s", "error: cannot allocate execution order\n");
+    error = EXIT_FAILURE;
+  }
+  free(shared_data.order);
+  free(shared_data.offsets);
+  return error;
+}
+
+int executor_run_dynamic(const executor_t* executor, size_t chunk_size,
+                         double* elapsed) {
+  assert(executor);
+  assert(chunk_size > 0);
+  shared_data_t shared_data;
+  shared_data.executor = executor;
+  shared_data.offsets = NULL;
+  shared_data.order = NULL;
+  atomic_init(&shared_data.next_unit, 0);
+  shared_data.chunk_size = chunk_size;
+  return executor_run_threads(&shared_data, executor_run_dynamic_thread,
+                              elapsed);
+}
+
+static int executor_run_threads(shared_data_t* shared_data,
+                                void* (*routine)(void*), double* elapsed) {
+  assert(shared_data);
+  int error = EXIT_SUCCESS;
+  const size_t thread_count = shared_data->executor->worker_count;
+  pthread_t* threads = malloc(thread_count * sizeof(pthread_t));
+  private_data_t* private_data = calloc(thread_count, sizeof(private_data_t));
+  shared_data->started = false;
+  shared_data->cancelled = false;
+  bool start_ready = false;
+  if (threads && private_data) {
+    start_ready = pthread_mutex_init(&shared_data->start_mutex, NULL) == 0;
+    if (start_ready &&
+        pthread_cond_init(&shared_data->start_condition, NULL) != 0) {
+      pthread_mutex_destroy(&shared_data->start_mutex);
+      start_ready = false;
+    }
+  }
+  if (start_ready) {
+    size_t created = 0;
+    for (; created < thread_count; ++created) {
+      private_data[created].thread_number = created;
+      private_data[created].shared_data = shared_data;
+      if (pthread_create(&threads[created], NULL, routine,
+                         &private_data[created]) != 0) {
+        fprintf(stderr, "error: cannot create thread %zu\n", created);
+        error = EXIT_FAILURE;
+        break;
+      }
+    }
+    // Release threads already created, all of them should be waiting
+    struct timespec start, stop;
+    pthread_mutex_lock(&shared_data->start_mutex);
+    shared_data->started = true;
+    shared_data->cancelled = error != EXIT_SUCCESS;
+    pthread_cond_broadcast(&shared_data->start_condition);
+    pthread_mutex_unlock(&shared_data->start_mutex);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t thread_number = 0; thread_number < created; ++thread_number) {
+      pthread_join(threads[thread_number], NULL);
+      executor_sink += private_data[thread_number].sink;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    *elapsed = get_duration(stop, start);
+    pthread_cond_destroy(&shared_data->start_condition);
+    pthread_mutex_destroy(&shared_data->start_mutex);
+  } else {
+    fprintf(stderr, "%s", "error: cannot allocate threads\n");
+    error = EXIT_FAILURE;
+  }
+  free(private_data);
+  free(threads);
+  return error;
+}
+
+static bool executor_wait_start(shared_data_t* shared_data) {
+  pthread_mutex_lock(&shared_data->start_mutex);
+  while (!shared_data->started) {
+    pthread_cond_wait(&shared_data->start_condition,
+                      &shared_data->start_mutex);
+  }
+  const bool cancelled = shared_data->cancelled;
+  pthread_mutex_unlock(&shared_data->start_mutex);
+  return !cancelled;
+}
+
+static void* executor_run_static_thread(void* data) {
+  assert(data);
+  private_data_t* private_data = (private_data_t*)data;
+  shared_data_t* shared_data = private_data->shared_data;
+  const executor_t* executor = shared_data->executor;
+  const size_t start = shared_data->offsets[private_data->thread_number];
+  const size_t stop = shared_data->offsets[private_data->thread_number + 1];
+  size_t sink = 0;
+  if (!executor_wait_start(shared_data)) {
+    return NULL;
+  }
+  for (size_t index = start; index < stop; ++index) {
+    sink += executor_spin(executor->units[shared_data->order[index]] *
+                          executor->iterations_per_unit);
+  }
+  private_data->sink = sink;
+  return NULL;
+}
+
+static void* executor_run_dynamic_thread(void* data) {
+  assert(data);
+  private_data_t* private_data = (private_data_t*)data;
+  shared_data_t* shared_data = private_data->shared_data;
+  const executor_t* executor = shared_data->executor;
+  const size_t chunk_size = shared_data->chunk_size;
+  size_t sink = 0;
+  if (!executor_wait_start(shared_data)) {
+    return NULL;
+  }
+  while (true) {
+    size_t start = atomic_fetch_add(&shared_data->next_unit, chunk_size);
+    if (start >= executor->unit_count) {
+      break;
+    }
+    size_t stop = start + chunk_size < executor->unit_count
+                      ? start + chunk_size
+                      : executor->unit_count;
+    for (size_t unit_index = start; unit_index < stop; ++unit_index) {
+      sink += executor_spin(executor->units[unit_index] *
+                            executor->iterations_per_unit);
+    }
+  }
+  private_data->sink = sink;
+  return NULL;
+}
+
+// https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
+static double get_duration(struct timespec stop_time,
+                           struct timespec start_time) {
+  return (stop_time.tv_sec + 1e-9 * stop_time.tv_nsec) -
+         (start_time.tv_sec + 1e-9 * start_time.tv_nsec);
+}
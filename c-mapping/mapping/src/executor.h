@@ -0,0 +1,78 @@
+/**
+ * @file executor.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Execution of mappings with threads. Header.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <stddef.h>
+
+/**
+ * @brief Work to execute.
+ * @details Each unit becomes busy work that takes about unit value times
+ * the calibrated unit time.
+ *
+ */
+typedef struct executor {
+  /// Unit array
+  const size_t* units;
+  /// Unit count
+  size_t unit_count;
+  /// Worker (thread) count
+  size_t worker_count;
+  /// Busy-work iterations per unit value
+  size_t iterations_per_unit;
+} executor_t;
+
+/**
+ * @brief Initialize executor and calibrate busy work.
+ *
+ * @param executor Executor to initialize
+ * @param units Unit array
+ * @param unit_count Unit count
+ * @param worker_count Worker count
+ * @param unit_time Nanoseconds of busy work per unit value
+ */
+void executor_init(executor_t* executor, const size_t* units,
+                   size_t unit_count, size_t worker_count, double unit_time);
+
+/**
+ * @brief Execute all units in the calling thread.
+ *
+ * @param executor Executor
+ * @return Elapsed wall-clock time in seconds
+ */
+double executor_run_serial(const executor_t* executor);
+
+/**
+ * @brief Execute units in threads following a static mapping.
+ *
+ * @param executor Executor
+ * @param units_workers Worker index of each unit
+ * @param worker_width Bytes per worker index, see worker_ids.h
+ * @param elapsed Where elapsed wall-clock time in seconds is stored
+ * @return Error code
+ */
+int executor_run_static(const executor_t* executor, const void* units_workers,
+                        size_t worker_width, double* elapsed);
+
+/**
+ * @brief Execute units in threads that take chunks of consecutive units
+ * from a shared atomic counter.
+ *
+ * @param executor Executor
+ * @param chunk_size Number of units taken at once
+ * @param elapsed Where elapsed wall-clock time in seconds is stored
+ * @return Error code
+ */
+int executor_run_dynamic(const executor_t* executor, size_t chunk_size,
+                         double* elapsed);
+
+#endif  // EXECUTOR_H
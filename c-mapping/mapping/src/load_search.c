@@ -0,0 +1,349 @@
+/**
+ * @file load_search.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Vectorized search of minimum and maximum worker loads.
+ * Implementation.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "load_search.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define LOAD_SEARCH_X86 1
+#endif
+
+/**
+ * @brief Search function of a kernel.
+ *
+ */
+typedef size_t (*load_search_function_t)(const size_t* loads,
+                                         size_t worker_count);
+
+/**
+ * @brief Kernel functions.
+ *
+ */
+typedef struct load_search_kernel_functions {
+  /// Name of kernel
+  const char* name;
+  /// Minimum search
+  load_search_function_t argmin;
+  /// Maximum search
+  load_search_function_t argmax;
+} load_search_kernel_functions_t;
+
+/**
+ * @brief Continue a minimum search from a worker index.
+ *
+ * @param loads Load array
+ * @param start First worker index to visit
+ * @param stop Worker index after last one to visit
+ * @param argmin Worker with minimum load before start
+ * @return Worker with minimum load before stop, lowest index on ties
+ */
+static inline size_t load_search_argmin_range(const size_t* loads,
+                                              size_t start, size_t stop,
+                                              size_t argmin) {
+  for (size_t worker_index = start; worker_index < stop; ++worker_index) {
+    if (loads[worker_index] < loads[argmin]) {
+      argmin = worker_index;
+    }
+  }
+  return argmin;
+}
+
+/**
+ * @brief Continue a maximum search from a worker index.
+ *
+ * @param loads Load array
+ * @param start First worker index to visit
+ * @param stop Worker index after last one to visit
+ * @param argmax Worker with maximum load before start
+ * @return Worker with maximum load before stop, lowest index on ties
+ */
+static inline size_t load_search_argmax_range(const size_t* loads,
+                                              size_t start, size_t stop,
+                                              size_t argmax) {
+  for (size_t worker_index = start; worker_index < stop; ++worker_index) {
+    if (loads[worker_index] > loads[argmax]) {
+      argmax = worker_index;
+    }
+  }
+  return argmax;
+}
+
+static size_t load_search_argmin_scalar(const size_t* loads,
+                                        size_t worker_count) {
+  return load_search_argmin_range(loads, 0, worker_count, 0);
+}
+
+static size_t load_search_argmax_scalar(const size_t* loads,
+                                        size_t worker_count) {
+  return load_search_argmax_range(loads, 0, worker_count, 0);
+}
+
+#ifdef LOAD_SEARCH_X86
+
+/**
+ * @brief Choose among the best worker of each lane.
+ * @details Each lane keeps its first best worker, so among lanes with the
+ * same load the lowest worker index wins.
+ *
+ * @param loads Load array
+ * @param indexes Best worker of each lane
+ * @param lane_count Lane count
+ * @param maximum True to choose the maximum load, false for the minimum
+ * @return Best worker index
+ */
+static inline size_t load_search_reduce(const size_t* loads,
+                                        const uint64_t* indexes,
+                                        size_t lane_count, bool maximum) {
+  size_t best = indexes[0];
+  for (size_t lane = 1; lane < lane_count; ++lane) {
+    const size_t worker_index = indexes[lane];
+    const bool better = maximum ? loads[worker_index] > loads[best]
+                                : loads[worker_index] < loads[best];
+    if (better || (loads[worker_index] == loads[best] && worker_index < best)) {
+      best = worker_index;
+    }
+  }
+  return best;
+}
+
+// There are only signed 64-bit comparisons. Flipping the sign bit of both
+// operands makes a signed comparison give the unsigned order.
+
+__attribute__((target("sse4.2"))) static size_t load_search_argmin_sse42(
+    const size_t* loads, size_t worker_count) {
+  if (worker_count < 4) {
+    return load_search_argmin_scalar(loads, worker_count);
+  }
+  const __m128i bias = _mm_set1_epi64x(INT64_MIN);
+  const __m128i step = _mm_set1_epi64x(2);
+  __m128i index = _mm_set_epi64x(1, 0);
+  __m128i best_index = index;
+  __m128i best =
+      _mm_xor_si128(_mm_loadu_si128((const __m128i*)loads), bias);
+  size_t worker_index = 2;
+  for (; worker_index + 2 <= worker_count; worker_index += 2) {
+    index = _mm_add_epi64(index, step);
+    const __m128i value = _mm_xor_si128(
+        _mm_loadu_si128((const __m128i*)(loads + worker_index)), bias);
+    // Only a strictly lower load replaces the first one of the lane
+    const __m128i less = _mm_cmpgt_epi64(best, value);
+    best = _mm_blendv_epi8(best, value, less);
+    best_index = _mm_blendv_epi8(best_index, index, less);
+  }
+  uint64_t indexes[2];
+  _mm_storeu_si128((__m128i*)indexes, best_index);
+  const size_t argmin = load_search_reduce(loads, indexes, 2, false);
+  return load_search_argmin_range(loads, worker_index, worker_count, argmin);
+}
+
+__attribute__((target("sse4.2"))) static size_t load_search_argmax_sse42(
+    const size_t* loads, size_t worker_count) {
+  if (worker_count < 4) {
+    return load_search_argmax_scalar(loads, worker_count);
+  }
+  const __m128i bias = _mm_set1_epi64x(INT64_MIN);
+  const __m128i step = _mm_set1_epi64x(2);
+  __m128i index = _mm_set_epi64x(1, 0);
+  __m128i best_index = index;
+  __m128i best =
+      _mm_xor_si128(_mm_loadu_si128((const __m128i*)loads), bias);
+  size_t worker_index = 2;
+  for (; worker_index + 2 <= worker_count; worker_index += 2) {
+    index = _mm_add_epi64(index, step);
+    const __m128i value = _mm_xor_si128(
+        _mm_loadu_si128((const __m128i*)(loads + worker_index)), bias);
+    const __m128i greater = _mm_cmpgt_epi64(value, best);
+    best = _mm_blendv_epi8(best, value, greater);
+    best_index = _mm_blendv_epi8(best_index, index, greater);
+  }
+  uint64_t indexes[2];
+  _mm_storeu_si128((__m128i*)indexes, best_index);
+  const size_t argmax = load_search_reduce(loads, indexes, 2, true);
+  return load_search_argmax_range(loads, worker_index, worker_count, argmax);
+}
+
+__attribute__((target("avx2"))) static size_t load_search_argmin_avx2(
+    const size_t* loads, size_t worker_count) {
+  if (worker_count < 16) {
+    return load_search_argmin_scalar(loads, worker_count);
+  }
+  // Two accumulators of four lanes each hide the latency of blends
+  const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i step = _mm256_set1_epi64x(8);
+  __m256i index0 = _mm256_set_epi64x(3, 2, 1, 0);
+  __m256i index1 = _mm256_set_epi64x(7, 6, 5, 4);
+  __m256i best_index0 = index0;
+  __m256i best_index1 = index1;
+  __m256i best0 =
+      _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)loads), bias);
+  __m256i best1 =
+      _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(loads + 4)), bias);
+  size_t worker_index = 8;
+  for (; worker_index + 8 <= worker_count; worker_index += 8) {
+    index0 = _mm256_add_epi64(index0, step);
+    index1 = _mm256_add_epi64(index1, step);
+    const __m256i value0 = _mm256_xor_si256(
+        _mm256_loadu_si256((const __m256i*)(loads + worker_index)), bias);
+    const __m256i value1 = _mm256_xor_si256(
+        _mm256_loadu_si256((const __m256i*)(loads + worker_index + 4)), bias);
+    const __m256i less0 = _mm256_cmpgt_epi64(best0, value0);
+    const __m256i less1 = _mm256_cmpgt_epi64(best1, value1);
+    best0 = _mm256_blendv_epi8(best0, value0, less0);
+    best1 = _mm256_blendv_epi8(best1, value1, less1);
+    best_index0 = _mm256_blendv_epi8(best_index0, index0, less0);
+    best_index1 = _mm256_blendv_epi8(best_index1, index1, less1);
+  }
+  uint64_t indexes[8];
+  _mm256_storeu_si256((__m256i*)indexes, best_index0);
+  _mm256_storeu_si256((__m256i*)(indexes + 4), best_index1);
+  const size_t argmin = load_search_reduce(loads, indexes, 8, false);
+  return load_search_argmin_range(loads, worker_index, worker_count, argmin);
+}
+
+__attribute__((target("avx2"))) static size_t load_search_argmax_avx2(
+    const size_t* loads, size_t worker_count) {
+  if (worker_count < 16) {
+    return load_search_argmax_scalar(loads, worker_count);
+  }
+  // Two accumulators of four lanes each hide the latency of blends
+  const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i step = _mm256_set1_epi64x(8);
+  __m256i index0 = _mm256_set_epi64x(3, 2, 1, 0);
+  __m256i index1 = _mm256_set_epi64x(7, 6, 5, 4);
+  __m256i best_index0 = index0;
+  __m256i best_index1 = index1;
+  __m256i best0 =
+      _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)loads), bias);
+  __m256i best1 =
+      _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(loads + 4)), bias);
+  size_t worker_index = 8;
+  for (; worker_index + 8 <= worker_count; worker_index += 8) {
+    index0 = _mm256_add_epi64(index0, step);
+    index1 = _mm256_add_epi64(index1, step);
+    const __m256i value0 = _mm256_xor_si256(
+        _mm256_loadu_si256((const __m256i*)(loads + worker_index)), bias);
+    const __m256i value1 = _mm256_xor_si256(
+        _mm256_loadu_si256((const __m256i*)(loads + worker_index + 4)), bias);
+    const __m256i greater0 = _mm256_cmpgt_epi64(value0, best0);
+    const __m256i greater1 = _mm256_cmpgt_epi64(value1, best1);
+    best0 = _mm256_blendv_epi8(best0, value0, greater0);
+    best1 = _mm256_blendv_epi8(best1, value1, greater1);
+    best_index0 = _mm256_blendv_epi8(best_index0, index0, greater0);
+    best_index1 = _mm256_blendv_epi8(best_index1, index1, greater1);
+  }
+  uint64_t indexes[8];
+  _mm256_storeu_si256((__m256i*)indexes, best_index0);
+  _mm256_storeu_si256((__m256i*)(indexes + 4), best_index1);
+  const size_t argmax = load_search_reduce(loads, indexes, 8, true);
+  return load_search_argmax_range(loads, worker_index, worker_count, argmax);
+}
+
+#endif  // LOAD_SEARCH_X86
+
+/// Kernels, indexed by enum load_search_kernel. NULL if not compiled
+static const load_search_kernel_functions_t load_search_kernels[] = {
+    [LOAD_SEARCH_SCALAR] = {"scalar", load_search_argmin_scalar,
+                            load_search_argmax_scalar},
+#ifdef LOAD_SEARCH_X86
+    [LOAD_SEARCH_SSE42] = {"sse4.2", load_search_argmin_sse42,
+                           load_search_argmax_sse42},
+    [LOAD_SEARCH_AVX2] = {"avx2", load_search_argmin_avx2,
+                          load_search_argmax_avx2},
+#else
+    [LOAD_SEARCH_SSE42] = {"sse4.2", NULL, NULL},
+    [LOAD_SEARCH_AVX2] = {"avx2", NULL, NULL},
+#endif
+};
+
+/// Kernel used by searches
+static enum load_search_kernel load_search_kernel = LOAD_SEARCH_SCALAR;
+
+/// Selects the default kernel once
+static pthread_once_t load_search_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Check whether the CPU can run a kernel.
+ *
+ * @param kernel Kernel
+ * @return true if supported
+ */
+static bool load_search_is_supported(enum load_search_kernel kernel) {
+  switch (kernel) {
+    case LOAD_SEARCH_SCALAR:
+      return true;
+#ifdef LOAD_SEARCH_X86
+    case LOAD_SEARCH_SSE42:
+      return __builtin_cpu_supports("sse4.2");
+    case LOAD_SEARCH_AVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Select the widest kernel supported by the CPU.
+ *
+ */
+static void load_search_select(void) {
+#ifdef LOAD_SEARCH_X86
+  __builtin_cpu_init();
+#endif
+  load_search_kernel = LOAD_SEARCH_SCALAR;
+  for (int kernel = LOAD_SEARCH_KERNEL_COUNT - 1; kernel > LOAD_SEARCH_SCALAR;
+       --kernel) {
+    if (load_search_is_supported(kernel)) {
+      load_search_kernel = kernel;
+      break;
+    }
+  }
+}
+
+size_t load_search_argmin(const size_t* loads, size_t worker_count) {
+  assert(loads);
+  pthread_once(&load_search_once, load_search_select);
+  return load_search_kernels[load_search_kernel].argmin(loads, worker_count);
+}
+
+size_t load_search_argmax(const size_t* loads, size_t worker_count) {
+  assert(loads);
+  pthread_once(&load_search_once, load_search_select);
+  return load_search_kernels[load_search_kernel].argmax(loads, worker_count);
+}
+
+enum load_search_kernel load_search_get_kernel(void) {
+  pthread_once(&load_search_once, load_search_select);
+  return load_search_kernel;
+}
+
+int load_search_set_kernel(enum load_search_kernel kernel) {
+  pthread_once(&load_search_once, load_search_select);
+  int error = EXIT_SUCCESS;
+  if (kernel < LOAD_SEARCH_KERNEL_COUNT && load_search_is_supported(kernel)) {
+    load_search_kernel = kernel;
+  } else {
+    error = EXIT_FAILURE;
+  }
+  return error;
+}
+
+const char* load_search_get_name(enum load_search_kernel kernel) {
+  assert(kernel < LOAD_SEARCH_KERNEL_COUNT);
+  return load_search_kernels[kernel].name;
+}
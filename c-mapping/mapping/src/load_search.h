@@ -0,0 +1,77 @@
+/**
+ * @file load_search.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Vectorized search of minimum and maximum worker loads. Header.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef LOAD_SEARCH_H
+#define LOAD_SEARCH_H
+
+#include <stddef.h>
+
+/**
+ * @brief Kernels that search load arrays.
+ * @remark Every kernel returns the same index: the lowest one on ties.
+ *
+ */
+enum load_search_kernel {
+  /// Portable loop, available on every CPU
+  LOAD_SEARCH_SCALAR,
+  /// Two loads at once, with SSE4.2 64-bit comparisons
+  LOAD_SEARCH_SSE42,
+  /// Four loads at once, with AVX2
+  LOAD_SEARCH_AVX2,
+  /// Kernel count
+  LOAD_SEARCH_KERNEL_COUNT
+};
+
+/**
+ * @brief Find the worker with minimum load, lowest index on ties.
+ * @details The first call selects the widest kernel supported by the CPU.
+ *
+ * @param loads Load array
+ * @param worker_count Worker count
+ * @return Worker index, or zero if there are no workers
+ */
+size_t load_search_argmin(const size_t* loads, size_t worker_count);
+
+/**
+ * @brief Find the worker with maximum load, lowest index on ties.
+ * @details The first call selects the widest kernel supported by the CPU.
+ *
+ * @param loads Load array
+ * @param worker_count Worker count
+ * @return Worker index, or zero if there are no workers
+ */
+size_t load_search_argmax(const size_t* loads, size_t worker_count);
+
+/**
+ * @brief Get the kernel used by searches.
+ *
+ * @return Kernel
+ */
+enum load_search_kernel load_search_get_kernel(void);
+
+/**
+ * @brief Use a kernel for the next searches, e.g. to compare kernels.
+ * @remark Not thread-safe: call it while no search is running.
+ *
+ * @param kernel Kernel
+ * @return Error code, EXIT_FAILURE if the CPU does not support the kernel
+ */
+int load_search_set_kernel(enum load_search_kernel kernel);
+
+/**
+ * @brief Get the name of a kernel.
+ *
+ * @param kernel Kernel
+ * @return Name, e.g. "avx2"
+ */
+const char* load_search_get_name(enum load_search_kernel kernel);
+
+#endif  // LOAD_SEARCH_H
@@ -12,8 +12,29 @@
 #include "mapping.h"
 
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "event_queue.h"
+#include "executor.h"
+#include "load_search.h"
+#include "unit_reader.h"
+#include "worker_heap.h"
+#include "worker_ids.h"
+#include "writer.h"
 
 /// Default number of workers
 #define DEFAULT_WORKER_COUNT 4
@@ -21,14 +42,103 @@
 /// Default block size for block-cyclic mapping
 #define DEFAULT_BLOCK_SIZE 2
 
-/// Mapping count
-#define MAPPING_COUNT 4
+/// Default chunk size for chunked-dynamic and guided mappings
+#define DEFAULT_CHUNK_SIZE 2
+
+/// Default nanoseconds of busy work per unit value when executing mappings
+#define DEFAULT_UNIT_TIME 1000.0
+
+/// Initial capacity of unit array when input size is unknown
+#define INITIAL_UNIT_CAPACITY 1024
+
+/// Unit array is sized to estimated unit count plus 1/UNIT_ESTIMATE_MARGIN
+#define UNIT_ESTIMATE_MARGIN 16
+
+/// Number of units read at once in stream mode
+#define STREAM_BUFFER_UNITS 4096
+
+/// Maximum worker count for which dynamic mapping uses a linear argmin search
+/// instead of a worker heap. See bench/bench_dynamic.c
+#define DYNAMIC_LINEAR_MAX_WORKERS 32
+
+/// Maximum worker count for a linear argmin search when it is vectorized
+#define DYNAMIC_VECTOR_LINEAR_MAX_WORKERS 128
 
 /**
  * @brief Mapping types.
  *
  */
-enum mapping_type { BLOCK, CYCLIC, BLOCK_CYCLIC, DYNAMIC };
+enum mapping_type {
+  BLOCK,
+  CYCLIC,
+  BLOCK_CYCLIC,
+  DYNAMIC,
+  CHUNKED_DYNAMIC,
+  GUIDED,
+  LPT
+};
+
+/**
+ * @brief Output formats.
+ *
+ */
+enum mapping_format { FORMAT_TEXT, FORMAT_CSV, FORMAT_JSON, FORMAT_BINARY };
+
+/// Names of output formats, as given on command line
+static const char* const mapping_format_names[] = {
+    [FORMAT_TEXT] = "text",
+    [FORMAT_CSV] = "csv",
+    [FORMAT_JSON] = "json",
+    [FORMAT_BINARY] = "binary",
+};
+
+/// Output format count
+#define FORMAT_COUNT \
+  (sizeof(mapping_format_names) / sizeof(mapping_format_names[0]))
+
+/// Identifies binary dumps of units-workers mappings
+#define BINARY_MAGIC "MAPW"
+
+/// Version of binary dump layout
+#define BINARY_VERSION 1
+
+/// Bytes reserved for each mapping name in binary dumps
+#define BINARY_NAME_SIZE 16
+
+/**
+ * @brief Header of a binary dump of units-workers mappings.
+ * @details It is followed, for each mapping, by its name in
+ * BINARY_NAME_SIZE bytes padded with zeros, and the worker of each unit in
+ * worker_width bytes. Values are in native byte order.
+ *
+ */
+typedef struct mapping_binary_header {
+  /// BINARY_MAGIC, without null terminator
+  char magic[4];
+  /// BINARY_VERSION
+  uint32_t version;
+  /// Bytes of each worker index
+  uint32_t worker_width;
+  /// Number of mappings in dump
+  uint32_t mapping_count;
+  /// Unit count
+  uint64_t unit_count;
+  /// Worker count
+  uint64_t worker_count;
+} mapping_binary_header_t;
+
+/**
+ * @brief Range of values evaluated in sweep mode.
+ *
+ */
+typedef struct mapping_sweep_range {
+  /// First value
+  size_t first;
+  /// Last value, inclusive
+  size_t last;
+  /// Increment between values, zero if range was not given
+  size_t step;
+} mapping_sweep_range_t;
 
 typedef struct mapping_result {
   /// Maximum
@@ -37,12 +147,43 @@ typedef struct mapping_result {
   double speedup;
   /// Efficiency
   double efficiency;
-  /// Units-workers array
-  size_t* units_workers;
+  /// Measured wall-clock time of execution with threads, in seconds
+  double elapsed;
+  /// Units-workers array, with worker indexes of worker_width bytes
+  void* units_workers;
   /// Units processed per worker
   size_t* units_processed;
+  /// Simulated time at which the last worker finishes, in event mode
+  double makespan;
+  /// Simulated time at which each worker finishes, NULL if not in event mode
+  double* finish_times;
 } mapping_result_t;
 
+/**
+ * @brief Hierarchical mapping of units to nodes, and then to the threads of
+ * each node, in topology mode.
+ *
+ */
+typedef struct mapping_hierarchy {
+  /// Node count, zero if workers are not hierarchical
+  size_t node_count;
+  /// Threads per node
+  size_t node_threads;
+  /// Index of mapping of units to nodes
+  size_t node_mapping;
+  /// Index of mapping of units of a node to its threads
+  size_t thread_mapping;
+  /// Units processed per node
+  size_t* node_loads;
+  /// Maximum node load divided by mean node load
+  double node_imbalance;
+  /// Maximum thread load divided by mean thread load, for each node
+  double* imbalances;
+  /// Results over all workers, where workers of node i start at
+  /// i * node_threads. Units-workers are not stored
+  mapping_result_t result;
+} mapping_hierarchy_t;
+
 /**
  * @brief Mapping data.
  *
@@ -52,18 +193,277 @@ typedef struct mapping {
   size_t worker_count;
   /// Block size for block-cyclic mapping
   size_t block_size;
+  /// Chunk size for chunked-dynamic mapping, minimum chunk size for guided
+  size_t chunk_size;
   /// Sum of serially processed units
   size_t serial_sum;
   /// Unit count
   size_t unit_count;
   /// Unit capacity
   size_t unit_capacity;
-  /// Unit array
-  size_t* units;
-  /// Mapping results
+  /// Unit array read from input, owned by the mapping
+  size_t* owned_units;
+  /// Units to map: owned units, or those given to mapping_evaluate()
+  const size_t* units;
+  /// Mappings whose results are allocated and calculated, bit i for
+  /// mapping index i
+  unsigned mappings;
+  /// Mapping results, and all their arrays, in a single allocation
   mapping_result_t* results;
+  /// Bytes allocated for results, reused by later evaluations
+  size_t results_capacity;
+  /// Bytes per worker index in units-workers arrays
+  size_t worker_width;
+  /// True to map units as they are read, without storing them
+  bool stream;
+  /// Unit count given on command line for stream mode, zero if unknown
+  size_t stream_count;
+  /// True to execute mappings with threads and measure their speedup
+  bool execute;
+  /// Nanoseconds of busy work per unit value when executing mappings
+  double unit_time;
+  /// Measured wall-clock time of serial execution, in seconds
+  double serial_elapsed;
+  /// Number of threads used to calculate mappings, 0 if --threads was not
+  /// given before arguments are parsed
+  size_t thread_count;
+  /// True to calculate only units processed per worker, without the mapping
+  /// of each unit
+  bool summary;
+  /// True to calculate prefix sums of units in summary mode
+  bool index;
+  /// Output format
+  enum mapping_format format;
+  /// True to report elapsed time of each phase on standard error
+  bool profile;
+  /// Start of current phase
+  struct timespec phase_start;
+  /// Sum of the first i units at index i, NULL if not calculated
+  size_t* prefix_sums;
+  /// Unit count that prefix sums can hold
+  size_t prefix_capacity;
+  /// Units sorted by decreasing value, NULL if not calculated
+  size_t* sorted_units;
+  /// Unit count that sorted units can hold
+  size_t sorted_capacity;
+  /// True to evaluate ranges of worker counts and block sizes
+  bool sweep;
+  /// Worker counts evaluated in sweep mode
+  mapping_sweep_range_t sweep_workers;
+  /// Block sizes evaluated in sweep mode
+  mapping_sweep_range_t sweep_blocks;
+  /// True to simulate dispatch overhead and worker speeds as events
+  bool events;
+  /// Time spent by a worker each time it takes units at run time
+  double overhead;
+  /// Speed factors given on command line, owned by the mapping
+  double* owned_speeds;
+  /// Speed factors repeated over workers: owned ones, or those given to
+  /// mapping_evaluate()
+  const double* speed_pattern;
+  /// Number of speed factors given on command line
+  size_t speed_pattern_count;
+  /// Speed factor of each worker, in event mode
+  double* speeds;
+  /// Sum of speed factors of all workers
+  double capacity;
+  /// True to replace block size by the one that minimizes the maximum load
+  /// of block-cyclic mapping
+  bool autotune;
+  /// Hierarchical mapping in topology mode
+  mapping_hierarchy_t hierarchy;
+  /// Directory or glob pattern of input files in batch mode, NULL otherwise
+  const char* batch;
 } mapping_t;
 
+/**
+ * @brief Assigns loads to the worker with minimum load, lowest index on ties.
+ * @details A linear search, vectorized if the CPU allows it, is used for few
+ * workers, a worker heap otherwise.
+ * In event mode loads go to the worker that becomes idle first instead.
+ *
+ */
+typedef struct mapping_scheduler {
+  /// Load per worker
+  size_t* loads;
+  /// Worker count
+  size_t worker_count;
+  /// True if worker heap is used
+  bool use_heap;
+  /// Workers by load
+  worker_heap_t heap;
+  /// True if event queue is used
+  bool use_events;
+  /// Workers by time at which they become idle
+  event_queue_t events;
+} mapping_scheduler_t;
+
+/**
+ * @brief State of mappings evaluated while units are read.
+ * @details Only sums per worker are kept, so memory does not depend on
+ * the unit count.
+ *
+ */
+typedef struct mapping_stream {
+  /// Index of next unit
+  size_t unit_index;
+  /// Worker of next unit in block mapping
+  size_t block_worker;
+  /// Start of next worker range in block mapping
+  size_t block_stop;
+  /// Worker of next unit in cyclic mapping
+  size_t cyclic_worker;
+  /// Worker of current block in block-cyclic mapping
+  size_t block_cyclic_worker;
+  /// Number of units in current block of block-cyclic mapping
+  size_t block_cyclic_fill;
+  /// Sum of units in current block of block-cyclic mapping
+  size_t block_cyclic_sum;
+  /// Scheduler of dynamic mapping
+  mapping_scheduler_t dynamic;
+  /// Scheduler of chunked-dynamic mapping
+  mapping_scheduler_t chunked;
+  /// Number of units in current chunk of chunked-dynamic mapping
+  size_t chunked_fill;
+  /// Sum of units in current chunk of chunked-dynamic mapping
+  size_t chunked_sum;
+  /// Scheduler of guided mapping
+  mapping_scheduler_t guided;
+  /// Length of current chunk of guided mapping
+  size_t guided_length;
+  /// Number of units in current chunk of guided mapping
+  size_t guided_fill;
+  /// Sum of units in current chunk of guided mapping
+  size_t guided_sum;
+} mapping_stream_t;
+
+/**
+ * @brief Data of a thread that calculates mappings of a range of units.
+ *
+ */
+typedef struct mapping_thread {
+  /// Mapping data, shared by all threads
+  mapping_t* mapping;
+  /// First unit index
+  size_t start;
+  /// Unit index after last unit
+  size_t stop;
+  /// Partial sum of serially processed units
+  size_t serial_sum;
+  /// Partial sums of units processed per worker, for each range mapping
+  size_t* units_processed;
+} mapping_thread_t;
+
+/**
+ * @brief Data of a thread that calculates a sequential mapping.
+ *
+ */
+typedef struct mapping_sequential_thread {
+  /// Mapping data, shared by all threads
+  mapping_t* mapping;
+  /// Index of mapping to calculate
+  size_t mapping_index;
+  /// Error code
+  int error;
+} mapping_sequential_thread_t;
+
+/**
+ * @brief Configurations evaluated in sweep mode.
+ *
+ */
+typedef struct mapping_sweep {
+  /// Mapping data, shared by all threads
+  mapping_t* mapping;
+  /// Number of worker counts
+  size_t worker_counts;
+  /// Number of block sizes
+  size_t block_sizes;
+  /// Maximum workload of each mapping, for each worker count and block size
+  size_t* maxima;
+  /// Index of next worker count to evaluate
+  atomic_size_t next_worker_count;
+} mapping_sweep_t;
+
+/**
+ * @brief Data of a thread that evaluates configurations in sweep mode.
+ *
+ */
+typedef struct mapping_sweep_thread {
+  /// Sweep shared by all threads
+  mapping_sweep_t* sweep;
+  /// Error code
+  int error;
+} mapping_sweep_thread_t;
+
+/**
+ * @brief Input files evaluated in batch mode.
+ *
+ */
+typedef struct mapping_batch {
+  /// Mapping data given on command line
+  mapping_t* mapping;
+  /// Parameters of every evaluation
+  mapping_params_t params;
+  /// Paths matched by the pattern, in name order
+  glob_t matches;
+  /// Paths of regular files, pointing into matches
+  char** paths;
+  /// Number of regular files
+  size_t file_count;
+  /// Unit count of each file
+  size_t* unit_counts;
+  /// Sum of units of each file
+  size_t* serial_sums;
+  /// Error code of each file
+  int* errors;
+  /// Outcome of each mapping, for each file
+  mapping_outcome_t* outcomes;
+  /// Index of next file to evaluate
+  atomic_size_t next_file;
+} mapping_batch_t;
+
+/**
+ * @brief Data of a thread that evaluates files in batch mode.
+ *
+ */
+typedef struct mapping_batch_thread {
+  /// Batch shared by all threads
+  mapping_batch_t* batch;
+  /// Error code
+  int error;
+} mapping_batch_thread_t;
+
+/**
+ * @brief Calculate a mapping of a range of units.
+ *
+ * @param mapping Mapping data
+ * @param start First unit index
+ * @param stop Unit index after last unit
+ * @param units_processed Sums of units processed per worker to update
+ */
+typedef void (*mapping_range_t)(mapping_t* mapping, size_t start, size_t stop,
+                                size_t* units_processed);
+
+/**
+ * @brief Mapping policy.
+ *
+ */
+typedef struct mapping_policy {
+  /// Name printed in results
+  const char* name;
+  /// Calculates the mapping of all units
+  int (*calculate)(mapping_t* mapping);
+  /// Calculates the mapping of a range of units, NULL if it is sequential
+  mapping_range_t calculate_range;
+  /// Calculates only units processed per worker, using prefix sums and
+  /// sorted units if they are available
+  int (*calculate_loads)(mapping_t* mapping);
+  /// True if the mapping can be calculated in stream mode
+  bool online;
+  /// True if workers take units at run time, paying dispatch overhead
+  bool dispatched;
+} mapping_policy_t;
+
 /**
  * @brief Parse arguments from command line.
  *
@@ -75,20 +475,60 @@ typedef struct mapping {
 int mapping_parse_arguments(mapping_t* mapping, int argc, char* argv[]);
 
 /**
- * @brief Read work units from standard input
+ * @brief Parse a positive integer.
+ *
+ * @param text Text to parse
+ * @param value Where the value is stored
+ * @return true on success
+ */
+bool mapping_parse_size(const char* text, size_t* value);
+
+/**
+ * @brief Parse a comma-separated list of positive speed factors.
+ *
+ * @param mapping Mapping data where the list is stored
+ * @param text Text to parse, e.g. "2,2,1,1"
+ * @return true on success
+ */
+bool mapping_parse_speeds(mapping_t* mapping, const char* text);
+
+/**
+ * @brief Parse a topology of nodes and threads per node, e.g. "2x16".
+ *
+ * @param text Text to parse
+ * @param hierarchy Where node count and threads per node are stored
+ * @return true on success
+ */
+bool mapping_parse_topology(const char* text, mapping_hierarchy_t* hierarchy);
+
+/**
+ * @brief Find a mapping by name, ignoring case.
+ *
+ * @param name Name, as printed in results
+ * @return Mapping index, or MAPPING_COUNT if it is not found
+ */
+size_t mapping_find_policy(const char* name);
+
+/**
+ * @brief Read work units from a file descriptor, replacing previous units
+ * @details If input is a regular file, unit array is sized from a sample of
+ * it, otherwise from INITIAL_UNIT_CAPACITY. Capacity is doubled as needed. Unused capacity is released
+ * once input ends.
  *
  * @param mapping Mapping data
- * @return int
+ * @param fd Input, e.g. STDIN_FILENO
+ * @return Error code
  */
-int mapping_read_units(mapping_t* mapping);
+int mapping_read_units(mapping_t* mapping, int fd);
 
 /**
  * @brief Resize unit array.
  *
  * @param mapping Mapping data
+ * @param new_capacity New capacity of unit array, not less than unit count
  * @return Error code
  */
-int mapping_resize_unit_array(mapping_t* mapping);
+int mapping_resize_unit_array(mapping_t* mapping, size_t new_capacity);
 
 /**
  * @brief Start mapping calculations.
@@ -98,21 +538,148 @@ int mapping_resize_unit_array(mapping_t* mapping);
  */
 int mapping_calculate(mapping_t* mapping);
 
+/**
+ * @brief Map units from standard input without storing them.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_stream(mapping_t* mapping);
+
+/**
+ * @brief Count units in input for block mapping in stream mode.
+ *
+ * @param mapping Mapping data
+ * @param reader Reader on standard input. It is rewound after counting
+ * @param buffer Buffer of STREAM_BUFFER_UNITS units
+ * @return Error code
+ */
+int mapping_stream_count(mapping_t* mapping, unit_reader_t* reader,
+                         size_t* buffer);
+
+/**
+ * @brief Map a sequence of units in stream mode.
+ *
+ * @param mapping Mapping data
+ * @param stream Stream state
+ * @param units Units read from input
+ * @param count Number of units
+ */
+void mapping_stream_units(mapping_t* mapping, mapping_stream_t* stream,
+                          const size_t* units, size_t count);
+
+/**
+ * @brief Execute mappings with threads and measure their wall-clock time.
+ * @details Each unit becomes busy work proportional to its value. Threads
+ * of dynamic mapping take units from a shared atomic counter.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_execute(mapping_t* mapping);
+
 /**
  * @brief Allocate mapping results.
+ * @details Results, units processed per worker, and units-workers arrays are
+ * stored in one zeroed block. Worker indexes take the narrowest width that
+ * fits worker count.
  *
  * @param mapping Mapping data
  * @return Error code
  */
 int mapping_allocate_results(mapping_t* mapping);
 
+/**
+ * @brief Store the worker of a unit in a units-workers array.
+ *
+ * @param mapping Mapping data
+ * @param mapping_index Index of mapping
+ * @param unit_index Unit index
+ * @param worker_index Worker index
+ */
+static inline void mapping_set_worker(mapping_t* mapping, size_t mapping_index,
+                                      size_t unit_index, size_t worker_index) {
+  worker_ids_set(mapping->results[mapping_index].units_workers,
+                 mapping->worker_width, unit_index, worker_index);
+}
+
+/**
+ * @brief Report elapsed time of a phase if profiling, and start next phase.
+ * @details Reports are lines "profile <phase> [<mapping>] <seconds>".
+ *
+ * @param mapping Mapping data
+ * @param phase Phase name
+ * @param name Mapping name, or NULL if phase is not specific to a mapping
+ */
+void mapping_report_phase(mapping_t* mapping, const char* phase,
+                          const char* name);
+
+/**
+ * @brief Calculate only units processed per worker of all mappings.
+ * @details With the prefix-sum index, block mapping costs O(worker_count)
+ * and block-cyclic mapping costs O(unit_count / block_size). With several
+ * threads, each mapping is calculated by its own thread.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_summary(mapping_t* mapping);
+
+/**
+ * @brief Calculate mappings with several threads.
+ * @details Each thread maps a range of units and keeps partial sums, which
+ * are added once all threads finish. Sequential mappings, e.g. dynamic, are
+ * calculated meanwhile, each one by its own thread.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_parallel(mapping_t* mapping);
+
+/**
+ * @brief Calculate range mappings and serial sum of a range of units.
+ *
+ * @param data Thread data
+ * @return NULL
+ */
+void* mapping_calculate_thread(void* data);
+
+/**
+ * @brief Calculate a sequential mapping, or only its units processed per
+ * worker in summary mode.
+ *
+ * @param data Thread data
+ * @return NULL
+ */
+void* mapping_calculate_sequential_thread(void* data);
+
+/**
+ * @brief Repeat speed factors given on command line over all workers.
+ * @details Without speed factors, every worker has speed 1.
+ *
+ * @param mapping Mapping data
+ * @param speeds Array of worker_count speeds to fill
+ */
+void mapping_calculate_speeds(mapping_t* mapping, double* speeds);
+
 /**
  * @brief Calculate block mapping.
  *
  * @param mapping Mapping data
  * @return Error code
  */
-void mapping_calculate_block(mapping_t* mapping);
+int mapping_calculate_block(mapping_t* mapping);
+
+/**
+ * @brief Calculate block mapping of a range of units.
+ *
+ * @param mapping Mapping data
+ * @param start First unit index
+ * @param stop Unit index after last unit
+ * @param units_processed Sums of units processed per worker to update
+ */
+void mapping_calculate_block_range(mapping_t* mapping, size_t start,
+                                   size_t stop, size_t* units_processed);
 
 /**
  * @brief Find start of range for block mapping.
@@ -122,13 +689,33 @@ void mapping_calculate_block(mapping_t* mapping);
  */
 size_t mapping_find_start(mapping_t* mapping, size_t worker_index);
 
+/**
+ * @brief Find worker of a unit in block mapping.
+ *
+ * @param mapping Mapping data
+ * @param unit_index Unit index
+ * @return Worker index
+ */
+size_t mapping_find_worker(mapping_t* mapping, size_t unit_index);
+
 /**
  * @brief Calculate cyclic mapping.
  *
  * @param mapping Mapping data
  * @return Error code
  */
-void mapping_calculate_cyclic(mapping_t* mapping);
+int mapping_calculate_cyclic(mapping_t* mapping);
+
+/**
+ * @brief Calculate cyclic mapping of a range of units.
+ *
+ * @param mapping Mapping data
+ * @param start First unit index
+ * @param stop Unit index after last unit
+ * @param units_processed Sums of units processed per worker to update
+ */
+void mapping_calculate_cyclic_range(mapping_t* mapping, size_t start,
+                                    size_t stop, size_t* units_processed);
 
 /**
  * @brief Calculate block-cyclic mapping.
@@ -136,359 +723,3284 @@ void mapping_calculate_cyclic(mapping_t* mapping);
  * @param mapping Mapping data
  * @return Error code
  */
-void mapping_calculate_block_cyclic(mapping_t* mapping);
+int mapping_calculate_block_cyclic(mapping_t* mapping);
 
 /**
- * @brief Calculate dynamic mapping.
+ * @brief Calculate block-cyclic mapping of a range of units.
+ *
+ * @param mapping Mapping data
+ * @param start First unit index
+ * @param stop Unit index after last unit
+ * @param units_processed Sums of units processed per worker to update
+ */
+void mapping_calculate_block_cyclic_range(mapping_t* mapping, size_t start,
+                                          size_t stop,
+                                          size_t* units_processed);
+
+/**
+ * @brief Replace block size by the one that minimizes the maximum load of
+ * block-cyclic mapping, smallest block size on ties.
+ * @details Every block size from 1 to unit_count is evaluated with prefix
+ * sums. A block size b costs O(unit_count / b), so the whole search costs
+ * O(unit_count log unit_count). Evaluation of a block size stops as soon as
+ * a worker reaches the best maximum found so far, and the search stops when
+ * the maximum reaches its lower bound: the largest unit, or the serial sum
+ * divided by worker count.
  *
  * @param mapping Mapping data
  * @return Error code
  */
-void mapping_calculate_dynamic(mapping_t* mapping);
+int mapping_autotune(mapping_t* mapping);
 
 /**
- * @brief Find index of worker with minimum sum of processed units.
+ * @brief Find maximum load of block-cyclic mapping with a block size.
+ *
+ * @param mapping Mapping data, with prefix sums
+ * @param block_size Block size
+ * @param loads Array of worker_count loads, overwritten
+ * @param limit Maximum that makes the block size useless
+ * @return Maximum load, or limit if it is reached
+ */
+size_t mapping_find_block_cyclic_maximum(mapping_t* mapping,
+                                         size_t block_size, size_t* loads,
+                                         size_t limit);
+
+/**
+ * @brief Calculate hierarchical mapping in topology mode.
+ * @details Units are mapped to nodes with the node mapping, as if nodes were
+ * workers. Then the units of each node, in their original order, are mapped
+ * to its threads with the thread mapping.
  *
  * @param mapping Mapping data
- * @return Worker index
+ * @return Error code
  */
-size_t mapping_find_argmin(mapping_t* mapping);
+int mapping_calculate_hierarchy(mapping_t* mapping);
 
 /**
- * @brief Calculate results for all mappings.
+ * @brief Calculate maximum of a hierarchical mapping, and imbalance of nodes
+ * and of threads of each node.
  *
  * @param mapping Mapping data
  */
-void mapping_calculate_results(mapping_t* mapping);
+void mapping_calculate_imbalance(mapping_t* mapping);
 
 /**
- * @brief Print mapping results
+ * @brief Calculate dynamic mapping.
  *
  * @param mapping Mapping data
+ * @return Error code
  */
-void mapping_print_results(mapping_t* mapping);
+int mapping_calculate_dynamic(mapping_t* mapping);
 
-mapping_t* mapping_create() {
-  mapping_t* mapping = calloc(1, sizeof(mapping_t));
-  if (mapping) {
-    mapping->worker_count = DEFAULT_WORKER_COUNT;
-    mapping->block_size = DEFAULT_BLOCK_SIZE;
-    mapping->serial_sum = 0;
-    mapping->unit_count = 0;
-    mapping->unit_capacity = 0;
-    mapping->units = NULL;
-    mapping->results = NULL;
-  }
-  return mapping;
-}
+/**
+ * @brief Calculate chunked-dynamic mapping.
+ * @details Chunks of chunk_size consecutive units are taken by the worker
+ * with minimum sum of processed units.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_chunked_dynamic(mapping_t* mapping);
 
-int mapping_run(mapping_t* mapping, int argc, char* argv[]) {
-  assert(mapping);
-  int error = EXIT_SUCCESS;
-  error = mapping_parse_arguments(mapping, argc, argv);
-  if (error == EXIT_SUCCESS) {
-    error = mapping_read_units(mapping);
-    if (error == EXIT_SUCCESS) {
-      error = mapping_calculate(mapping);
-      if (error == EXIT_SUCCESS) {
-        mapping_print_results(mapping);
-      }
-    }
-  }
-  return error;
-}
+/**
+ * @brief Calculate guided mapping.
+ * @details As OpenMP guided schedule, each chunk is the number of remaining
+ * units divided by worker count, but not less than chunk_size. Chunks are
+ * taken by the worker with minimum sum of processed units.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_guided(mapping_t* mapping);
 
-int mapping_parse_arguments(mapping_t* mapping, int argc, char* argv[]) {
-  assert(mapping);
-  int error = EXIT_SUCCESS;
-  long value = 0;
-  if (argc == 3) {
-    if (sscanf(argv[1], "%ld", &value) == 1 && value > 0) {
-      mapping->worker_count = value;
-      if (sscanf(argv[2], "%ld", &value) == 1 && value > 0) {
-        mapping->block_size = value;
-      } else {
-        fprintf(stderr, "%s", "error: invalid block size\n");
-        error = EXIT_FAILURE;
-      }
-    } else {
-      fprintf(stderr, "%s", "error: invalid worker count\n");
-      error = EXIT_FAILURE;
-    }
-  }
-  return error;
-}
+/**
+ * @brief Find length of next chunk of guided mapping.
+ *
+ * @param mapping Mapping data
+ * @param remaining Number of units not mapped yet
+ * @return Chunk length
+ */
+size_t mapping_find_guided_length(mapping_t* mapping, size_t remaining);
 
-int mapping_read_units(mapping_t* mapping) {
-  assert(mapping);
-  int error = EXIT_SUCCESS;
-  long value = 0;
-  while (scanf("%ld", &value) == 1) {
-    if (mapping->unit_count == mapping->unit_capacity) {
-      error = mapping_resize_unit_array(mapping);
-    }
-    if (error == EXIT_SUCCESS) {
-      if (value > 0) {
-        mapping->units[mapping->unit_count] = value;
-        ++mapping->unit_count;
-      }
-    } else {
-      break;
-    }
-  }
-  return error;
-}
+/**
+ * @brief Calculate Longest-Processing-Time-first mapping.
+ * @details Units are sorted by decreasing value, ties by index, and each one
+ * is taken by the worker with minimum sum of processed units. This mapping is
+ * offline: it needs all units before it starts.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_lpt(mapping_t* mapping);
 
-int mapping_resize_unit_array(mapping_t* mapping) {
-  assert(mapping);
+/**
+ * @brief Compare units for LPT mapping.
+ *
+ * @param first First unit, as value and index pair
+ * @param second Second unit, as value and index pair
+ * @return Negative if first goes before second, positive otherwise
+ */
+int mapping_compare_lpt(const void* first, const void* second);
+
+/**
+ * @brief Map a chunk of consecutive units to the least loaded worker.
+ *
+ * @param mapping Mapping data
+ * @param mapping_index Index of mapping
+ * @param scheduler Scheduler of mapping
+ * @param start First unit index
+ * @param stop Unit index after last unit
+ */
+void mapping_assign_chunk(mapping_t* mapping, size_t mapping_index,
+                          mapping_scheduler_t* scheduler, size_t start,
+                          size_t stop);
+
+/**
+ * @brief Initialize a scheduler of a mapping.
+ *
+ * @param scheduler Scheduler
+ * @param mapping Mapping data. Its results must outlive the scheduler
+ * @param mapping_index Index of mapping whose loads are assigned
+ * @return Error code
+ */
+int mapping_scheduler_init(mapping_scheduler_t* scheduler, mapping_t* mapping,
+                           size_t mapping_index);
+
+/**
+ * @brief Add load to worker with minimum load.
+ *
+ * @param scheduler Scheduler
+ * @param load Load to add
+ * @return Worker index
+ */
+size_t mapping_scheduler_assign(mapping_scheduler_t* scheduler, size_t load);
+
+/**
+ * @brief Release scheduler resources.
+ *
+ * @param scheduler Scheduler
+ */
+void mapping_scheduler_destroy(mapping_scheduler_t* scheduler);
+
+/**
+ * @brief Find index of worker with minimum sum of processed units.
+ * @details Uses the SIMD kernel selected for this CPU. See load_search.h
+ *
+ * @param loads Sum of processed units per worker
+ * @param worker_count Worker count
+ * @return Worker index, lowest one on ties
+ */
+size_t mapping_find_argmin(const size_t* loads, size_t worker_count);
+
+/**
+ * @brief Parse a range of values, as "first", "first..last", or
+ * "first..last:step".
+ *
+ * @param text Text to parse
+ * @param range Where range is stored
+ * @return true if text is a valid range
+ */
+bool mapping_parse_sweep_range(const char* text, mapping_sweep_range_t* range);
+
+/**
+ * @brief Count values of a range.
+ *
+ * @param range Range
+ * @return Value count
+ */
+size_t mapping_count_sweep_range(const mapping_sweep_range_t* range);
+
+/**
+ * @brief Evaluate all worker counts and block sizes, and print a table.
+ * @details Units are read once. Prefix sums and sorted units are calculated
+ * once and shared by all configurations, so a block mapping costs
+ * O(worker_count) and a block-cyclic mapping costs O(unit_count / block_size).
+ * Each thread takes the next worker count, and evaluates all block sizes for
+ * it.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_sweep(mapping_t* mapping);
+
+/**
+ * @brief Evaluate worker counts until there are no more left.
+ *
+ * @param data Thread data
+ * @return NULL
+ */
+void* mapping_sweep_thread(void* data);
+
+/**
+ * @brief Print speedup and efficiency of each configuration.
+ *
+ * @param sweep Evaluated sweep
+ * @return Error code
+ */
+int mapping_print_sweep(mapping_sweep_t* sweep);
+
+/**
+ * @brief Print sweep as a table.
+ *
+ * @param sweep Evaluated sweep
+ * @param writer Output
+ */
+void mapping_print_sweep_text(mapping_sweep_t* sweep, writer_t* writer);
+
+/**
+ * @brief Print sweep as CSV, one row per configuration and mapping.
+ *
+ * @param sweep Evaluated sweep
+ * @param writer Output
+ */
+void mapping_print_sweep_csv(mapping_sweep_t* sweep, writer_t* writer);
+
+/**
+ * @brief Print sweep as JSON.
+ *
+ * @param sweep Evaluated sweep
+ * @param writer Output
+ */
+void mapping_print_sweep_json(mapping_sweep_t* sweep, writer_t* writer);
+
+/**
+ * @brief Evaluate every input file of a directory or glob pattern, and print
+ * one report.
+ * @details Files are taken by a pool of thread_count threads, the calling
+ * thread included. Each thread reads and evaluates its files with its own
+ * mapping data, reused from file to file, so no file is shared. A file that
+ * cannot be read is reported on standard error and left out of the report,
+ * while the remaining files are still evaluated.
+ *
+ * @param mapping Mapping data with the parameters of every evaluation
+ * @return Error code
+ */
+int mapping_batch(mapping_t* mapping);
+
+/**
+ * @brief Find the regular files of a directory, or matched by a pattern.
+ *
+ * @param batch Batch where paths are stored
+ * @param path Directory or glob pattern
+ * @return Error code
+ */
+int mapping_find_batch_files(mapping_batch_t* batch, const char* path);
+
+/**
+ * @brief Evaluate files until there are no more left.
+ *
+ * @param data Thread data
+ * @return NULL
+ */
+void* mapping_batch_thread(void* data);
+
+/**
+ * @brief Read and evaluate one input file.
+ *
+ * @param batch Batch
+ * @param mapping Mapping data of the calling thread
+ * @param file_index Index of file to evaluate
+ * @return Error code
+ */
+int mapping_evaluate_batch_file(mapping_batch_t* batch, mapping_t* mapping,
+                                size_t file_index);
+
+/**
+ * @brief Print speedup and efficiency of each mapping, for each file.
+ *
+ * @param batch Evaluated batch
+ * @return Error code
+ */
+int mapping_print_batch(mapping_batch_t* batch);
+
+/**
+ * @brief Print batch as a table, one row per file.
+ *
+ * @param batch Evaluated batch
+ * @param writer Output
+ */
+void mapping_print_batch_text(mapping_batch_t* batch, writer_t* writer);
+
+/**
+ * @brief Print batch as CSV, one row per file and mapping.
+ *
+ * @param batch Evaluated batch
+ * @param writer Output
+ */
+void mapping_print_batch_csv(mapping_batch_t* batch, writer_t* writer);
+
+/**
+ * @brief Print batch as JSON.
+ *
+ * @param batch Evaluated batch
+ * @param writer Output
+ */
+void mapping_print_batch_json(mapping_batch_t* batch, writer_t* writer);
+
+/**
+ * @brief Print a text as a CSV field, quoted if needed.
+ *
+ * @param writer Output
+ * @param text Text
+ */
+void mapping_print_csv_field(writer_t* writer, const char* text);
+
+/**
+ * @brief Print a text as a JSON string.
+ *
+ * @param writer Output
+ * @param text Text
+ */
+void mapping_print_json_string(writer_t* writer, const char* text);
+
+/**
+ * @brief Calculate prefix sums of units.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_prefix_sums(mapping_t* mapping);
+
+/**
+ * @brief Sort a copy of units by decreasing value.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_sort_units(mapping_t* mapping);
+
+/**
+ * @brief Compare units by decreasing value.
+ *
+ * @param first First unit
+ * @param second Second unit
+ * @return Negative if first goes before second
+ */
+int mapping_compare_decreasing(const void* first, const void* second);
+
+/**
+ * @brief Sum a range of units, with prefix sums if they are available.
+ *
+ * @param mapping Mapping data
+ * @param start First unit index
+ * @param stop Unit index after last unit
+ * @return Sum of units
+ */
+size_t mapping_sum_units(mapping_t* mapping, size_t start, size_t stop);
+
+/**
+ * @brief Calculate units processed per worker of block mapping.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_block_loads(mapping_t* mapping);
+
+/**
+ * @brief Calculate units processed per worker of cyclic mapping.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_cyclic_loads(mapping_t* mapping);
+
+/**
+ * @brief Calculate units processed per worker of block-cyclic mapping.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_block_cyclic_loads(mapping_t* mapping);
+
+/**
+ * @brief Calculate units processed per worker of dynamic mapping.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_dynamic_loads(mapping_t* mapping);
+
+/**
+ * @brief Calculate units processed per worker of chunked-dynamic mapping.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_chunked_dynamic_loads(mapping_t* mapping);
+
+/**
+ * @brief Calculate units processed per worker of guided mapping.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_guided_loads(mapping_t* mapping);
+
+/**
+ * @brief Calculate units processed per worker of LPT mapping.
+ * @details Ties between units do not change the sums, so sorted units are
+ * enough. Units are sorted if they were not sorted yet.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_calculate_lpt_loads(mapping_t* mapping);
+
+/**
+ * @brief Find maximum load, with the SIMD kernel selected for this CPU.
+ *
+ * @param loads Load per worker
+ * @param worker_count Worker count
+ * @return Maximum load
+ */
+size_t mapping_find_maximum(const size_t* loads, size_t worker_count);
+
+/**
+ * @brief Calculate sum of serially processed units.
+ *
+ * @param mapping Mapping data
+ */
+void mapping_calculate_serial_sum(mapping_t* mapping);
+
+/**
+ * @brief Calculate results for all mappings.
+ * @remark Sums of units processed per worker must be already accumulated.
+ *
+ * @param mapping Mapping data
+ */
+void mapping_calculate_results(mapping_t* mapping);
+
+/**
+ * @brief Calculate simulated finish time of each worker, and the speedup
+ * and efficiency they give, in event mode.
+ *
+ * @param mapping Mapping data
+ * @param mapping_index Mapping index
+ */
+void mapping_calculate_makespan(mapping_t* mapping, size_t mapping_index);
+
+/**
+ * @brief Print mapping results in the requested format.
+ *
+ * @param mapping Mapping data
+ * @return Error code
+ */
+int mapping_print_results(mapping_t* mapping);
+
+/**
+ * @brief Print mapping results as text.
+ *
+ * @param mapping Mapping data
+ * @param writer Output
+ */
+void mapping_print_text(mapping_t* mapping, writer_t* writer);
+
+/**
+ * @brief Print hierarchical mapping results as text.
+ *
+ * @param mapping Mapping data
+ * @param writer Output
+ */
+void mapping_print_hierarchy_text(mapping_t* mapping, writer_t* writer);
+
+/**
+ * @brief Print mapping results as CSV, one row per mapping.
+ *
+ * @param mapping Mapping data
+ * @param writer Output
+ */
+void mapping_print_csv(mapping_t* mapping, writer_t* writer);
+
+/**
+ * @brief Print mapping results as JSON.
+ *
+ * @param mapping Mapping data
+ * @param writer Output
+ */
+void mapping_print_json(mapping_t* mapping, writer_t* writer);
+
+/**
+ * @brief Dump units-workers mappings in binary.
+ *
+ * @param mapping Mapping data
+ * @param writer Output
+ */
+void mapping_print_binary(mapping_t* mapping, writer_t* writer);
+
+/**
+ * @brief Print an array of sizes separated by commas.
+ *
+ * @param writer Output
+ * @param values Values
+ * @param count Value count
+ */
+void mapping_print_array(writer_t* writer, const size_t* values, size_t count);
+
+/**
+ * @brief Print a JSON number, or null if it is not finite.
+ *
+ * @param writer Output
+ * @param value Value
+ */
+void mapping_print_number(writer_t* writer, double value);
+
+static double get_duration(struct timespec stop_time,
+                           struct timespec start_time);
+
+/// Mapping policies, in the order they are reported
+static const mapping_policy_t mapping_policies[] = {
+    [BLOCK] = {"BLOCK", mapping_calculate_block, mapping_calculate_block_range,
+               mapping_calculate_block_loads, true, false},
+    [CYCLIC] = {"CYCLIC", mapping_calculate_cyclic,
+                mapping_calculate_cyclic_range, mapping_calculate_cyclic_loads,
+                true, false},
+    [BLOCK_CYCLIC] = {"BLOCK-CYCLIC", mapping_calculate_block_cyclic,
+                      mapping_calculate_block_cyclic_range,
+                      mapping_calculate_block_cyclic_loads, true, false},
+    [DYNAMIC] = {"DYNAMIC", mapping_calculate_dynamic, NULL,
+                 mapping_calculate_dynamic_loads, true, true},
+    [CHUNKED_DYNAMIC] = {"CHUNKED-DYNAMIC", mapping_calculate_chunked_dynamic,
+                         NULL, mapping_calculate_chunked_dynamic_loads, true,
+                         true},
+    [GUIDED] = {"GUIDED", mapping_calculate_guided, NULL,
+                mapping_calculate_guided_loads, true, true},
+    [LPT] = {"LPT", mapping_calculate_lpt, NULL, mapping_calculate_lpt_loads,
+             false, true},
+};
+
+/// Mapping count
+#define MAPPING_COUNT (sizeof(mapping_policies) / sizeof(mapping_policies[0]))
+
+/// Bits of all mappings
+#define MAPPING_ALL ((1u << MAPPING_COUNT) - 1)
+
+mapping_t* mapping_create() {
+  mapping_t* mapping = calloc(1, sizeof(mapping_t));
+  if (mapping) {
+    mapping->worker_count = DEFAULT_WORKER_COUNT;
+    mapping->block_size = DEFAULT_BLOCK_SIZE;
+    mapping->chunk_size = DEFAULT_CHUNK_SIZE;
+    mapping->serial_sum = 0;
+    mapping->unit_count = 0;
+    mapping->unit_capacity = 0;
+    mapping->owned_units = NULL;
+    mapping->units = NULL;
+    mapping->mappings = MAPPING_ALL;
+    mapping->results = NULL;
+    mapping->results_capacity = 0;
+    mapping->stream = false;
+    mapping->stream_count = 0;
+    mapping->execute = false;
+    mapping->unit_time = DEFAULT_UNIT_TIME;
+    mapping->serial_elapsed = 0.0;
+    mapping->thread_count = 0;
+    mapping->summary = false;
+    mapping->index = false;
+    mapping->format = FORMAT_TEXT;
+    mapping->profile = false;
+    mapping->prefix_sums = NULL;
+    mapping->prefix_capacity = 0;
+    mapping->sorted_units = NULL;
+    mapping->sorted_capacity = 0;
+    mapping->sweep = false;
+    mapping->events = false;
+    mapping->overhead = 0.0;
+    mapping->owned_speeds = NULL;
+    mapping->speed_pattern = NULL;
+    mapping->speed_pattern_count = 0;
+    mapping->speeds = NULL;
+    mapping->capacity = 0.0;
+    mapping->autotune = false;
+    mapping->hierarchy.node_count = 0;
+    mapping->hierarchy.node_mapping = BLOCK;
+    mapping->hierarchy.thread_mapping = DYNAMIC;
+    mapping->batch = NULL;
+  }
+  return mapping;
+}
+
+int mapping_run(mapping_t* mapping, int argc, char* argv[]) {
+  assert(mapping);
+  int error = EXIT_SUCCESS;
+  // Sums of units of previous evaluations must not be used by these ones
+  mapping->serial_sum = 0;
+  free(mapping->prefix_sums);
+  mapping->prefix_sums = NULL;
+  mapping->prefix_capacity = 0;
+  free(mapping->sorted_units);
+  mapping->sorted_units = NULL;
+  mapping->sorted_capacity = 0;
+  error = mapping_parse_arguments(mapping, argc, argv);
+  clock_gettime(CLOCK_MONOTONIC, &mapping->phase_start);
+  if (error == EXIT_SUCCESS && mapping->batch) {
+    error = mapping_batch(mapping);
+    mapping_report_phase(mapping, "batch", NULL);
+  } else if (error == EXIT_SUCCESS && mapping->stream) {
+    error = mapping_stream(mapping);
+    mapping_report_phase(mapping, "stream", NULL);
+    if (error == EXIT_SUCCESS) {
+      error = mapping_print_results(mapping);
+      mapping_report_phase(mapping, "print", NULL);
+    }
+  } else if (error == EXIT_SUCCESS) {
+    error = mapping_read_units(mapping, STDIN_FILENO);
+    mapping_report_phase(mapping, "read", NULL);
+    if (error == EXIT_SUCCESS && mapping->sweep) {
+      error = mapping_sweep(mapping);
+      mapping_report_phase(mapping, "sweep", NULL);
+    } else if (error == EXIT_SUCCESS) {
+      if (mapping->autotune) {
+        error = mapping_autotune(mapping);
+        mapping_report_phase(mapping, "autotune", NULL);
+      }
+      if (error == EXIT_SUCCESS) {
+        error = mapping_calculate(mapping);
+      }
+      if (error == EXIT_SUCCESS && mapping->hierarchy.node_count > 0) {
+        error = mapping_calculate_hierarchy(mapping);
+        mapping_report_phase(mapping, "hierarchy", NULL);
+      }
+      if (error == EXIT_SUCCESS && mapping->execute) {
+        error = mapping_execute(mapping);
+        mapping_report_phase(mapping, "execute", NULL);
+      }
+      if (error == EXIT_SUCCESS) {
+        error = mapping_print_results(mapping);
+        mapping_report_phase(mapping, "print", NULL);
+      }
+    }
+  }
+  return error;
+}
+
+void mapping_init_params(mapping_params_t* params) {
+  assert(params);
+  memset(params, 0, sizeof(mapping_params_t));
+  params->worker_count = DEFAULT_WORKER_COUNT;
+  params->block_size = DEFAULT_BLOCK_SIZE;
+  params->chunk_size = DEFAULT_CHUNK_SIZE;
+  params->mappings = MAPPING_ALL;
+}
+
+size_t mapping_get_count(void) {
+  return MAPPING_COUNT;
+}
+
+const char* mapping_get_name(size_t mapping_index) {
+  assert(mapping_index < MAPPING_COUNT);
+  return mapping_policies[mapping_index].name;
+}
+
+int mapping_evaluate(mapping_t* mapping, const size_t* units,
+                     size_t unit_count, const mapping_params_t* params,
+                     mapping_outcome_t* outcomes) {
+  assert(mapping);
+  assert(units || unit_count == 0);
+  assert(params);
+  assert(outcomes);
+  if (params->worker_count == 0 || params->block_size == 0 ||
+      params->chunk_size == 0 ||
+      (params->mappings & MAPPING_ALL) == 0 ||
+      (params->speeds == NULL) != (params->speed_count == 0)) {
+    fprintf(stderr, "%s", "error: invalid mapping parameters\n");
+    return EXIT_FAILURE;
+  }
+  // Settings, owned arrays and their counts are restored for later runs
+  const mapping_t settings = *mapping;
+  mapping->worker_count = params->worker_count;
+  mapping->block_size = params->block_size;
+  mapping->chunk_size = params->chunk_size;
+  mapping->events = params->events;
+  mapping->overhead = params->overhead;
+  mapping->mappings = params->mappings & MAPPING_ALL;
+  mapping->serial_sum = 0;
+  // Caller arrays are only read: borrow them instead of copying them
+  mapping->summary = true;
+  mapping->unit_count = unit_count;
+  mapping->units = units;
+  mapping->speed_pattern = params->speeds;
+  mapping->speed_pattern_count = params->speed_count;
+  // Prefix sums of previous units must not be used by these units
+  if (!params->index) {
+    free(mapping->prefix_sums);
+    mapping->prefix_sums = NULL;
+    mapping->prefix_capacity = 0;
+  }
+  int error = mapping_allocate_results(mapping);
+  if (error == EXIT_SUCCESS && params->index) {
+    error = mapping_calculate_prefix_sums(mapping);
+  }
+  // Sorted units of previous units must not be used, only LPT needs them
+  if (error == EXIT_SUCCESS && (mapping->mappings & (1u << LPT))) {
+    error = mapping_sort_units(mapping);
+  }
+  for (size_t mapping_index = 0;
+       mapping_index < MAPPING_COUNT && error == EXIT_SUCCESS;
+       ++mapping_index) {
+    if (mapping->mappings & (1u << mapping_index)) {
+      error = mapping_policies[mapping_index].calculate_loads(mapping);
+    }
+  }
+  if (error == EXIT_SUCCESS) {
+    mapping_calculate_serial_sum(mapping);
+    mapping_calculate_results(mapping);
+    for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+         ++mapping_index) {
+      if (!(mapping->mappings & (1u << mapping_index))) {
+        continue;
+      }
+      const mapping_result_t* result = &mapping->results[mapping_index];
+      mapping_outcome_t* outcome = &outcomes[mapping_index];
+      outcome->maximum = result->maximum;
+      outcome->speedup = result->speedup;
+      outcome->efficiency = result->efficiency;
+      outcome->makespan = result->makespan;
+      if (outcome->units_processed) {
+        memcpy(outcome->units_processed, result->units_processed,
+               mapping->worker_count * sizeof(size_t));
+      }
+    }
+  }
+  mapping->worker_count = settings.worker_count;
+  mapping->block_size = settings.block_size;
+  mapping->chunk_size = settings.chunk_size;
+  mapping->events = settings.events;
+  mapping->overhead = settings.overhead;
+  mapping->mappings = settings.mappings;
+  mapping->summary = settings.summary;
+  mapping->unit_count = settings.unit_count;
+  mapping->units = settings.units;
+  mapping->speed_pattern = settings.speed_pattern;
+  mapping->speed_pattern_count = settings.speed_pattern_count;
+  return error;
+}
+
+int mapping_parse_arguments(mapping_t* mapping, int argc, char* argv[]) {
+  assert(mapping);
+  int error = EXIT_SUCCESS;
+  // Options may appear anywhere, the rest are positional arguments
+  char* arguments[2] = {NULL, NULL};
+  int argument_count = 0;
+  for (int index = 1; index < argc && error == EXIT_SUCCESS; ++index) {
+    if (strcmp(argv[index], "--stream") == 0) {
+      mapping->stream = true;
+    } else if (strcmp(argv[index], "--count") == 0) {
+      if (index + 1 < argc &&
+          mapping_parse_size(argv[index + 1], &mapping->stream_count)) {
+        ++index;
+      } else {
+        fprintf(stderr, "%s", "error: invalid unit count\n");
+        error = EXIT_FAILURE;
+      }
+    } else if (strcmp(argv[index], "--chunk") == 0) {
+      if (index + 1 < argc &&
+          mapping_parse_size(argv[index + 1], &mapping->chunk_size)) {
+        ++index;
+      } else {
+        fprintf(stderr, "%s", "error: invalid chunk size\n");
+        error = EXIT_FAILURE;
+      }
+    } else if (strcmp(argv[index], "--threads") == 0) {
+      if (index + 1 < argc &&
+          mapping_parse_size(argv[index + 1], &mapping->thread_count)) {
+        ++index;
+      } else {
+        fprintf(stderr, "%s", "error: invalid thread count\n");
+        error = EXIT_FAILURE;
+      }
+    } else if (strcmp(argv[index], "--workers") == 0 ||
+               strcmp(argv[index], "--block") == 0) {
+      mapping_sweep_range_t* range = argv[index][2] == 'w'
+                                         ? &mapping->sweep_workers
+                                         : &mapping->sweep_blocks;
+      if (index + 1 < argc &&
+          mapping_parse_sweep_range(argv[index + 1], range)) {
+        mapping->sweep = true;
+        ++index;
+      } else {
+        fprintf(stderr, "error: invalid range for %s\n", argv[index]);
+        error = EXIT_FAILURE;
+      }
+    } else if (strcmp(argv[index], "--batch") == 0) {
+      if (index + 1 < argc && argv[index + 1][0] != '\0') {
+        mapping->batch = argv[++index];
+      } else {
+        fprintf(stderr, "%s", "error: missing input files for --batch\n");
+        error = EXIT_FAILURE;
+      }
+    } else if (strcmp(argv[index], "--summary") == 0) {
+      mapping->summary = true;
+    } else if (strcmp(argv[index], "--index") == 0) {
+      mapping->index = true;
+    } else if (strcmp(argv[index], "--format") == 0) {
+      size_t format = 0;
+      while (index + 1 < argc && format < FORMAT_COUNT &&
+             strcmp(argv[index + 1], mapping_format_names[format]) != 0) {
+        ++format;
+      }
+      if (index + 1 < argc && format < FORMAT_COUNT) {
+        mapping->format = format;
+        ++index;
+      } else {
+        fprintf(stderr, "%s", "error: invalid output format\n");
+        error = EXIT_FAILURE;
+      }
+    } else if (strcmp(argv[index], "--profile") == 0) {
+      mapping->profile = true;
+    } else if (strcmp(argv[index], "--execute") == 0) {
+      mapping->execute = true;
+    } else if (strcmp(argv[index], "--unit-time") == 0) {
+      if (index + 1 < argc &&
+          sscanf(argv[index + 1], "%lf", &mapping->unit_time) == 1 &&
+          mapping->unit_time > 0.0) {
+        ++index;
+      } else {
+        fprintf(stderr, "%s", "error: invalid unit time\n");
+        error = EXIT_FAILURE;
+      }
+    } else if (strcmp(argv[index], "--topology") == 0) {
+      if (index + 1 < argc &&
+          mapping_parse_topology(argv[index + 1], &mapping->hierarchy)) {
+        ++index;
+      } else {
+        fprintf(stderr, "%s", "error: invalid topology\n");
+        error = EXIT_FAILURE;
+      }
+    } else if (strcmp(argv[index], "--node-mapping") == 0 ||
+               strcmp(argv[index], "--thread-mapping") == 0) {
+      size_t* policy = argv[index][2] == 'n'
+                           ? &mapping->hierarchy.node_mapping
+                           : &mapping->hierarchy.thread_mapping;
+      if (index + 1 < argc &&
+          (*policy = mapping_find_policy(argv[index + 1])) < MAPPING_COUNT) {
+        ++index;
+      } else {
+        fprintf(stderr, "error: invalid mapping for %s\n", argv[index]);
+        error = EXIT_FAILURE;
+      }
+    } else if (strcmp(argv[index], "--autotune") == 0) {
+      mapping->autotune = true;
+    } else if (strcmp(argv[index], "--overhead") == 0) {
+      if (index + 1 < argc &&
+          sscanf(argv[index + 1], "%lf", &mapping->overhead) == 1 &&
+          mapping->overhead >= 0.0) {
+        mapping->events = true;
+        ++index;
+      } else {
+        fprintf(stderr, "%s", "error: invalid dispatch overhead\n");
+        error = EXIT_FAILURE;
+      }
+    } else if (strcmp(argv[index], "--speeds") == 0) {
+      if (index + 1 < argc && mapping_parse_speeds(mapping, argv[index + 1])) {
+        mapping->events = true;
+        ++index;
+      } else {
+        fprintf(stderr, "%s", "error: invalid worker speeds\n");
+        error = EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[index], "--", 2) == 0) {
+      fprintf(stderr, "error: unknown option %s\n", argv[index]);
+      error = EXIT_FAILURE;
+    } else {
+      if (argument_count < 2) {
+        arguments[argument_count] = argv[index];
+      }
+      ++argument_count;
+    }
+  }
+  if (error == EXIT_SUCCESS && mapping->stream && mapping->execute) {
+    fprintf(stderr, "%s", "error: stream mode cannot execute mappings\n");
+    error = EXIT_FAILURE;
+  }
+  if (error == EXIT_SUCCESS && mapping->summary && mapping->execute) {
+    fprintf(stderr, "%s", "error: summary mode cannot execute mappings\n");
+    error = EXIT_FAILURE;
+  }
+  if (error == EXIT_SUCCESS && mapping->format == FORMAT_BINARY &&
+      (mapping->stream || mapping->summary || mapping->sweep)) {
+    fprintf(stderr, "%s",
+            "error: binary format requires units-workers mappings\n");
+    error = EXIT_FAILURE;
+  }
+  if (error == EXIT_SUCCESS && mapping->sweep &&
+      (mapping->stream || mapping->execute)) {
+    fprintf(stderr, "%s",
+            "error: sweep mode cannot stream units or execute mappings\n");
+    error = EXIT_FAILURE;
+  }
+  if (error == EXIT_SUCCESS && mapping->autotune &&
+      (mapping->stream || mapping->sweep)) {
+    fprintf(stderr, "%s",
+            "error: autotune mode cannot stream units or sweep block sizes\n");
+    error = EXIT_FAILURE;
+  }
+  if (error == EXIT_SUCCESS && mapping->hierarchy.node_count > 0 &&
+      (mapping->stream || mapping->sweep || mapping->execute ||
+       mapping->events)) {
+    fprintf(stderr, "%s",
+            "error: topology mode cannot stream units, sweep, execute "
+            "mappings or simulate events\n");
+    error = EXIT_FAILURE;
+  }
+  if (error == EXIT_SUCCESS && mapping->batch &&
+      (mapping->stream || mapping->sweep || mapping->execute ||
+       mapping->autotune || mapping->hierarchy.node_count > 0 ||
+       mapping->format == FORMAT_BINARY)) {
+    fprintf(stderr, "%s",
+            "error: batch mode cannot stream units, sweep, execute, "
+            "autotune, use a topology or dump binary mappings\n");
+    error = EXIT_FAILURE;
+  }
+  if (error == EXIT_SUCCESS && mapping->sweep && mapping->events) {
+    fprintf(stderr, "%s", "error: sweep mode cannot simulate events\n");
+    error = EXIT_FAILURE;
+  }
+  if (error == EXIT_SUCCESS && argument_count == 2) {
+    if (mapping_parse_size(arguments[0], &mapping->worker_count)) {
+      if (!mapping_parse_size(arguments[1], &mapping->block_size)) {
+        fprintf(stderr, "%s", "error: invalid block size\n");
+        error = EXIT_FAILURE;
+      }
+    } else {
+      fprintf(stderr, "%s", "error: invalid worker count\n");
+      error = EXIT_FAILURE;
+    }
+  }
+  // Without --threads, batch mode evaluates a file per CPU at a time
+  if (mapping->thread_count == 0) {
+    mapping->thread_count = 1;
+    if (mapping->batch) {
+      const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+      mapping->thread_count = cpu_count > 0 ? (size_t)cpu_count : 1;
+    }
+  }
+  // Topology determines worker count
+  if (mapping->hierarchy.node_count > 0) {
+    mapping->worker_count =
+        mapping->hierarchy.node_count * mapping->hierarchy.node_threads;
+  }
+  // Without a range, sweep evaluates the single given value
+  if (mapping->sweep_workers.step == 0) {
+    mapping->sweep_workers.first = mapping->sweep_workers.last =
+        mapping->worker_count;
+    mapping->sweep_workers.step = 1;
+  }
+  if (mapping->sweep_blocks.step == 0) {
+    mapping->sweep_blocks.first = mapping->sweep_blocks.last =
+        mapping->block_size;
+    mapping->sweep_blocks.step = 1;
+  }
+  return error;
+}
+
+bool mapping_parse_size(const char* text, size_t* value) {
+  assert(text);
+  assert(value);
+  long parsed = 0;
+  if (sscanf(text, "%ld", &parsed) == 1 && parsed > 0) {
+    *value = parsed;
+    return true;
+  }
+  return false;
+}
+
+bool mapping_parse_speeds(mapping_t* mapping, const char* text) {
+  assert(mapping);
+  assert(text);
+  size_t count = 1;
+  for (const char* character = text; *character; ++character) {
+    count += *character == ',';
+  }
+  double* speeds = malloc(count * sizeof(double));
+  bool valid = speeds != NULL;
+  const char* position = text;
+  for (size_t index = 0; index < count && valid; ++index) {
+    int length = 0;
+    valid = sscanf(position, "%lf%n", &speeds[index], &length) == 1 &&
+            speeds[index] > 0.0 && isfinite(speeds[index]) &&
+            position[length] == (index + 1 < count ? ',' : '\0');
+    position += length + 1;
+  }
+  if (valid) {
+    free(mapping->owned_speeds);
+    mapping->owned_speeds = speeds;
+    mapping->speed_pattern = speeds;
+    mapping->speed_pattern_count = count;
+  } else {
+    free(speeds);
+  }
+  return valid;
+}
+
+bool mapping_parse_topology(const char* text, mapping_hierarchy_t* hierarchy) {
+  assert(text);
+  assert(hierarchy);
+  long node_count = 0;
+  long node_threads = 0;
+  int length = 0;
+  if (sscanf(text, "%ldx%ld%n", &node_count, &node_threads, &length) == 2 &&
+      text[length] == '\0' && node_count > 0 && node_threads > 0) {
+    hierarchy->node_count = node_count;
+    hierarchy->node_threads = node_threads;
+    return true;
+  }
+  return false;
+}
+
+size_t mapping_find_policy(const char* name) {
+  assert(name);
+  size_t policy = 0;
+  while (policy < MAPPING_COUNT &&
+         strcasecmp(name, mapping_policies[policy].name) != 0) {
+    ++policy;
+  }
+  return policy;
+}
+
+bool mapping_parse_sweep_range(const char* text,
+                               mapping_sweep_range_t* range) {
+  assert(text);
+  assert(range);
+  long first = 0;
+  long last = 0;
+  long step = 1;
+  int length = 0;
+  bool valid = false;
+  if (sscanf(text, "%ld%n", &first, &length) == 1 && text[length] == '\0') {
+    last = first;
+    valid = true;
+  } else if (sscanf(text, "%ld..%ld%n", &first, &last, &length) == 2 &&
+             text[length] == '\0') {
+    valid = true;
+  } else if (sscanf(text, "%ld..%ld:%ld%n", &first, &last, &step, &length) ==
+                 3 &&
+             text[length] == '\0') {
+    valid = true;
+  }
+  if (valid && first > 0 && last >= first && step > 0) {
+    range->first = first;
+    range->last = last;
+    range->step = step;
+    return true;
+  }
+  return false;
+}
+
+size_t mapping_count_sweep_range(const mapping_sweep_range_t* range) {
+  assert(range);
+  return (range->last - range->first) / range->step + 1;
+}
+
+int mapping_read_units(mapping_t* mapping, int fd) {
+  assert(mapping);
+  mapping->unit_count = 0;
+  unit_reader_t reader;
+  int error = unit_reader_open(&reader, fd);
+  if (error == EXIT_SUCCESS) {
+    // Mapped files are sized from a sample, with some room for estimate error
+    size_t capacity = unit_reader_estimate(&reader);
+    if (capacity > 0) {
+      capacity += capacity / UNIT_ESTIMATE_MARGIN + 1;
+    } else {
+      capacity = INITIAL_UNIT_CAPACITY;
+    }
+    error = mapping_resize_unit_array(mapping, capacity);
+    while (error == EXIT_SUCCESS) {
+      // Amortized memory allocation
+      if (mapping->unit_count == mapping->unit_capacity) {
+        error = mapping_resize_unit_array(mapping, 2 * mapping->unit_capacity);
+        if (error != EXIT_SUCCESS) {
+          break;
+        }
+      }
+      size_t count = unit_reader_read(&reader,
+                                      mapping->owned_units +
+                                          mapping->unit_count,
+                                      mapping->unit_capacity -
+                                          mapping->unit_count);
+      mapping->unit_count += count;
+      error = reader.error;
+      if (mapping->unit_count < mapping->unit_capacity) {
+        break;
+      }
+    }
+    unit_reader_close(&reader);
+    // Release unused capacity
+    if (error == EXIT_SUCCESS && mapping->unit_count > 0 &&
+        mapping->unit_count < mapping->unit_capacity) {
+      error = mapping_resize_unit_array(mapping, mapping->unit_count);
+    }
+  }
+  return error;
+}
+
+int mapping_resize_unit_array(mapping_t* mapping, size_t new_capacity) {
+  assert(mapping);
+  assert(new_capacity >= mapping->unit_count);
+  int error = EXIT_SUCCESS;
+  size_t* new_array = realloc(mapping->owned_units,
+                              new_capacity * sizeof(size_t));
+  if (new_array) {
+    mapping->owned_units = new_array;
+    mapping->units = new_array;
+    mapping->unit_capacity = new_capacity;
+  } else {
+    fprintf(stderr, "%s", "error: cannot resize unit array\n");
+    error = EXIT_FAILURE;
+  }
+  return error;
+}
+
+int mapping_calculate(mapping_t* mapping) {
+  assert(mapping);
+  int error = EXIT_SUCCESS;
+  error = mapping_allocate_results(mapping);
+  mapping_report_phase(mapping, "allocate", NULL);
+  if (error == EXIT_SUCCESS && mapping->summary) {
+    error = mapping_calculate_summary(mapping);
+    if (error == EXIT_SUCCESS) {
+      mapping_calculate_serial_sum(mapping);
+    }
+  } else if (error == EXIT_SUCCESS && mapping->thread_count > 1 &&
+             mapping->unit_count > 1) {
+    error = mapping_calculate_parallel(mapping);
+    mapping_report_phase(mapping, "assign", NULL);
+  } else if (error == EXIT_SUCCESS) {
+    for (size_t mapping_index = 0;
+         mapping_index < MAPPING_COUNT && error == EXIT_SUCCESS;
+         ++mapping_index) {
+      error = mapping_policies[mapping_index].calculate(mapping);
+      mapping_report_phase(mapping, "assign",
+                           mapping_policies[mapping_index].name);
+    }
+    if (error == EXIT_SUCCESS) {
+      mapping_calculate_serial_sum(mapping);
+    }
+  }
+  if (error == EXIT_SUCCESS) {
+    mapping_calculate_results(mapping);
+    mapping_report_phase(mapping, "reduce", NULL);
+  }
+  return error;
+}
+
+void mapping_report_phase(mapping_t* mapping, const char* phase,
+                          const char* name) {
+  assert(mapping);
+  assert(phase);
+  struct timespec stop;
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  if (mapping->profile) {
+    fprintf(stderr, "profile %s%s%s %.9lf\n", phase, name ? " " : "",
+            name ? name : "", get_duration(stop, mapping->phase_start));
+  }
+  mapping->phase_start = stop;
+}
+
+int mapping_calculate_summary(mapping_t* mapping) {
+  assert(mapping);
+  int error = EXIT_SUCCESS;
+  if (mapping->index) {
+    error = mapping_calculate_prefix_sums(mapping);
+    mapping_report_phase(mapping, "index", NULL);
+  }
+  if (error == EXIT_SUCCESS && mapping->thread_count > 1) {
+    pthread_t* threads = malloc(MAPPING_COUNT * sizeof(pthread_t));
+    mapping_sequential_thread_t* thread_data =
+        calloc(MAPPING_COUNT, sizeof(mapping_sequential_thread_t));
+    if (threads && thread_data) {
+      size_t created = 0;
+      for (; created < MAPPING_COUNT; ++created) {
+        thread_data[created].mapping = mapping;
+        thread_data[created].mapping_index = created;
+        if (pthread_create(&threads[created], NULL,
+                           mapping_calculate_sequential_thread,
+                           &thread_data[created]) != 0) {
+          fprintf(stderr, "%s", "error: cannot create mapping thread\n");
+          error = EXIT_FAILURE;
+          break;
+        }
+      }
+      for (size_t thread_index = 0; thread_index < created; ++thread_index) {
+        pthread_join(threads[thread_index], NULL);
+        if (thread_data[thread_index].error != EXIT_SUCCESS) {
+          error = thread_data[thread_index].error;
+        }
+      }
+    } else {
+      fprintf(stderr, "%s", "error: cannot allocate mapping threads\n");
+      error = EXIT_FAILURE;
+    }
+    free(thread_data);
+    free(threads);
+    mapping_report_phase(mapping, "assign", NULL);
+  } else if (error == EXIT_SUCCESS) {
+    for (size_t mapping_index = 0;
+         mapping_index < MAPPING_COUNT && error == EXIT_SUCCESS;
+         ++mapping_index) {
+      error = mapping_policies[mapping_index].calculate_loads(mapping);
+      mapping_report_phase(mapping, "assign",
+                           mapping_policies[mapping_index].name);
+    }
+  }
+  return error;
+}
+
+int mapping_calculate_parallel(mapping_t* mapping) {
+  assert(mapping);
+  int error = EXIT_SUCCESS;
+  size_t thread_count = mapping->thread_count;
+  if (thread_count > mapping->unit_count) {
+    thread_count = mapping->unit_count;
+  }
+  size_t range_count = 0;
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    if (mapping_policies[mapping_index].calculate_range) {
+      ++range_count;
+    }
+  }
+  const size_t sequential_count = MAPPING_COUNT - range_count;
+  const size_t partial_count = range_count * mapping->worker_count;
+  pthread_t* threads =
+      malloc((thread_count + sequential_count) * sizeof(pthread_t));
+  mapping_thread_t* thread_data =
+      calloc(thread_count, sizeof(mapping_thread_t));
+  mapping_sequential_thread_t* sequential_data =
+      calloc(sequential_count, sizeof(mapping_sequential_thread_t));
+  size_t* partials = calloc(thread_count * partial_count, sizeof(size_t));
+  if (threads && thread_data && sequential_data && partials) {
+    size_t created = 0;
+    // Each sequential mapping is calculated by its own thread
+    for (size_t mapping_index = 0;
+         mapping_index < MAPPING_COUNT && error == EXIT_SUCCESS;
+         ++mapping_index) {
+      if (mapping_policies[mapping_index].calculate_range == NULL) {
+        mapping_sequential_thread_t* data = &sequential_data[created];
+        data->mapping = mapping;
+        data->mapping_index = mapping_index;
+        if (pthread_create(&threads[created], NULL,
+                           mapping_calculate_sequential_thread, data) == 0) {
+          ++created;
+        } else {
+          fprintf(stderr, "%s", "error: cannot create mapping thread\n");
+          error = EXIT_FAILURE;
+        }
+      }
+    }
+    const size_t sequential_created = created;
+    // Each range thread takes a block of units
+    for (size_t thread_index = 0;
+         thread_index < thread_count && error == EXIT_SUCCESS;
+         ++thread_index) {
+      mapping_thread_t* data = &thread_data[thread_index];
+      data->mapping = mapping;
+      data->start = thread_index * mapping->unit_count / thread_count;
+      data->stop = (thread_index + 1) * mapping->unit_count / thread_count;
+      data->units_processed = partials + thread_index * partial_count;
+      if (pthread_create(&threads[created], NULL, mapping_calculate_thread,
+                         data) == 0) {
+        ++created;
+      } else {
+        fprintf(stderr, "%s", "error: cannot create mapping thread\n");
+        error = EXIT_FAILURE;
+      }
+    }
+    for (size_t thread_index = 0; thread_index < created; ++thread_index) {
+      pthread_join(threads[thread_index], NULL);
+    }
+    for (size_t thread_index = 0; thread_index < sequential_created;
+         ++thread_index) {
+      if (sequential_data[thread_index].error != EXIT_SUCCESS) {
+        error = sequential_data[thread_index].error;
+      }
+    }
+    // Add partial sums of all range threads
+    for (size_t thread_index = 0;
+         thread_index < thread_count && error == EXIT_SUCCESS;
+         ++thread_index) {
+      mapping->serial_sum += thread_data[thread_index].serial_sum;
+      const size_t* partial = thread_data[thread_index].units_processed;
+      for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+           ++mapping_index) {
+        if (mapping_policies[mapping_index].calculate_range) {
+          size_t* units_processed =
+              mapping->results[mapping_index].units_processed;
+          for (size_t worker_index = 0; worker_index < mapping->worker_count;
+               ++worker_index) {
+            units_processed[worker_index] += partial[worker_index];
+          }
+          partial += mapping->worker_count;
+        }
+      }
+    }
+  } else {
+    fprintf(stderr, "%s", "error: cannot allocate mapping threads\n");
+    error = EXIT_FAILURE;
+  }
+  free(partials);
+  free(sequential_data);
+  free(thread_data);
+  free(threads);
+  return error;
+}
+
+void* mapping_calculate_thread(void* data) {
+  assert(data);
+  mapping_thread_t* thread_data = (mapping_thread_t*)data;
+  mapping_t* mapping = thread_data->mapping;
+  size_t* partial = thread_data->units_processed;
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    if (mapping_policies[mapping_index].calculate_range) {
+      mapping_policies[mapping_index].calculate_range(
+          mapping, thread_data->start, thread_data->stop, partial);
+      partial += mapping->worker_count;
+    }
+  }
+  for (size_t unit_index = thread_data->start; unit_index < thread_data->stop;
+       ++unit_index) {
+    thread_data->serial_sum += mapping->units[unit_index];
+  }
+  return NULL;
+}
+
+void* mapping_calculate_sequential_thread(void* data) {
+  assert(data);
+  mapping_sequential_thread_t* thread_data =
+      (mapping_sequential_thread_t*)data;
+  const mapping_policy_t* policy =
+      &mapping_policies[thread_data->mapping_index];
+  if (thread_data->mapping->summary) {
+    thread_data->error = policy->calculate_loads(thread_data->mapping);
+  } else {
+    thread_data->error = policy->calculate(thread_data->mapping);
+  }
+  return NULL;
+}
+
+int mapping_stream(mapping_t* mapping) {
+  assert(mapping);
+  size_t buffer[STREAM_BUFFER_UNITS];
+  unit_reader_t reader;
+  mapping_stream_t stream;
+  memset(&stream, 0, sizeof(stream));
+  int error = unit_reader_open(&reader, STDIN_FILENO);
+  if (error == EXIT_SUCCESS) {
+    error = mapping_stream_count(mapping, &reader, buffer);
+    if (error == EXIT_SUCCESS) {
+      error = mapping_allocate_results(mapping);
+    }
+    if (error == EXIT_SUCCESS) {
+      stream.block_stop = mapping_find_start(mapping, 1);
+      error = mapping_scheduler_init(&stream.dynamic, mapping, DYNAMIC);
+    }
+    if (error == EXIT_SUCCESS) {
+      error =
+          mapping_scheduler_init(&stream.chunked, mapping, CHUNKED_DYNAMIC);
+    }
+    if (error == EXIT_SUCCESS) {
+      error = mapping_scheduler_init(&stream.guided, mapping, GUIDED);
+    }
+    size_t count = 0;
+    while (error == EXIT_SUCCESS &&
+           (count = unit_reader_read(&reader, buffer, STREAM_BUFFER_UNITS))) {
+      mapping_stream_units(mapping, &stream, buffer, count);
+      error = reader.error;
+    }
+    if (error == EXIT_SUCCESS && stream.unit_index != mapping->unit_count) {
+      fprintf(stderr, "error: read %zu units, expected %zu\n",
+              stream.unit_index, mapping->unit_count);
+      error = EXIT_FAILURE;
+    }
+    if (error == EXIT_SUCCESS) {
+      // Trailing units that do not fill a block are a shorter last block
+      mapping->results[BLOCK_CYCLIC]
+          .units_processed[stream.block_cyclic_worker] +=
+          stream.block_cyclic_sum;
+      // Last chunk may be shorter than chunk size
+      if (stream.chunked_fill > 0) {
+        mapping_scheduler_assign(&stream.chunked, stream.chunked_sum);
+      }
+      mapping_calculate_results(mapping);
+    }
+    mapping_scheduler_destroy(&stream.guided);
+    mapping_scheduler_destroy(&stream.chunked);
+    mapping_scheduler_destroy(&stream.dynamic);
+    unit_reader_close(&reader);
+  }
+  return error;
+}
+
+int mapping_stream_count(mapping_t* mapping, unit_reader_t* reader,
+                         size_t* buffer) {
+  assert(mapping);
+  assert(reader);
+  int error = EXIT_SUCCESS;
+  if (mapping->stream_count > 0) {
+    mapping->unit_count = mapping->stream_count;
+  } else if (reader->mapped) {
+    // Block mapping needs the unit count: make a first pass over the file
+    size_t count = 0;
+    while ((count = unit_reader_read(reader, buffer, STREAM_BUFFER_UNITS))) {
+      mapping->unit_count += count;
+    }
+    error = unit_reader_rewind(reader);
+  } else {
+    fprintf(stderr, "%s",
+            "error: stream mode requires --count if input is not a file\n");
+    error = EXIT_FAILURE;
+  }
+  return error;
+}
+
+void mapping_stream_units(mapping_t* mapping, mapping_stream_t* stream,
+                          const size_t* units, size_t count) {
+  assert(mapping);
+  assert(stream);
+  size_t* block = mapping->results[BLOCK].units_processed;
+  size_t* cyclic = mapping->results[CYCLIC].units_processed;
+  size_t* block_cyclic = mapping->results[BLOCK_CYCLIC].units_processed;
+  for (size_t index = 0; index < count; ++index) {
+    const size_t unit = units[index];
+    mapping->serial_sum += unit;
+    // Block: units beyond the expected count go to the last worker
+    while (stream->unit_index >= stream->block_stop &&
+           stream->block_worker + 1 < mapping->worker_count) {
+      ++stream->block_worker;
+      stream->block_stop =
+          mapping_find_start(mapping, stream->block_worker + 1);
+    }
+    block[stream->block_worker] += unit;
+    // Cyclic
+    cyclic[stream->cyclic_worker] += unit;
+    if (++stream->cyclic_worker == mapping->worker_count) {
+      stream->cyclic_worker = 0;
+    }
+    // Block-cyclic: a block is added to its worker once it is full
+    stream->block_cyclic_sum += unit;
+    if (++stream->block_cyclic_fill == mapping->block_size) {
+      block_cyclic[stream->block_cyclic_worker] += stream->block_cyclic_sum;
+      stream->block_cyclic_sum = 0;
+      stream->block_cyclic_fill = 0;
+      if (++stream->block_cyclic_worker == mapping->worker_count) {
+        stream->block_cyclic_worker = 0;
+      }
+    }
+    // Dynamic
+    mapping_scheduler_assign(&stream->dynamic, unit);
+    // Chunked-dynamic: a chunk is taken by a worker once it is full
+    stream->chunked_sum += unit;
+    if (++stream->chunked_fill == mapping->chunk_size) {
+      mapping_scheduler_assign(&stream->chunked, stream->chunked_sum);
+      stream->chunked_sum = 0;
+      stream->chunked_fill = 0;
+    }
+    // Guided: length of a chunk depends on units not mapped before it
+    if (stream->guided_fill == 0) {
+      stream->guided_length = mapping_find_guided_length(
+          mapping, mapping->unit_count - stream->unit_index);
+    }
+    stream->guided_sum += unit;
+    if (++stream->guided_fill >= stream->guided_length) {
+      mapping_scheduler_assign(&stream->guided, stream->guided_sum);
+      stream->guided_sum = 0;
+      stream->guided_fill = 0;
+    }
+    ++stream->unit_index;
+  }
+}
+
+int mapping_execute(mapping_t* mapping) {
+  assert(mapping);
+  int error = EXIT_SUCCESS;
+  executor_t executor;
+  executor_init(&executor, mapping->units, mapping->unit_count,
+                mapping->worker_count, mapping->unit_time);
+  mapping->serial_elapsed = executor_run_serial(&executor);
+  for (size_t mapping_index = 0;
+       mapping_index < MAPPING_COUNT && error == EXIT_SUCCESS;
+       ++mapping_index) {
+    mapping_result_t* result = &mapping->results[mapping_index];
+    // Other mappings, even guided and LPT, replay the simulated assignment
+    if (mapping_index == DYNAMIC) {
+      error = executor_run_dynamic(&executor, 1, &result->elapsed);
+    } else if (mapping_index == CHUNKED_DYNAMIC) {
+      error = executor_run_dynamic(&executor, mapping->chunk_size,
+                                   &result->elapsed);
+    } else {
+      error = executor_run_static(&executor, result->units_workers,
+                                  mapping->worker_width, &result->elapsed);
+    }
+  }
+  return error;
+}
+
+int mapping_allocate_results(mapping_t* mapping) {
+  assert(mapping);
+  int error = EXIT_SUCCESS;
+  // Units-workers arrays are not stored in stream and summary modes
+  const bool units_workers = !mapping->stream && !mapping->summary;
+  mapping->worker_width = worker_ids_width(mapping->worker_count);
+  const size_t results_size = MAPPING_COUNT * sizeof(mapping_result_t);
+  const size_t processed_size = mapping->worker_count * sizeof(size_t);
+  const size_t workers_size =
+      units_workers ? mapping->unit_count * mapping->worker_width : 0;
+  // Worker speeds and finish times of each mapping, only in event mode
+  const size_t times_size =
+      mapping->events ? mapping->worker_count * sizeof(double) : 0;
+  // Arrays are only allocated for selected mappings
+  size_t selected_count = 0;
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    selected_count += (mapping->mappings >> mapping_index) & 1u;
+  }
+  const size_t arena_size =
+      results_size + times_size +
+      selected_count * (processed_size + times_size + workers_size);
+  // A previous arena is reused if it is large enough
+  char* arena = (char*)mapping->results;
+  if (arena && arena_size <= mapping->results_capacity) {
+    memset(arena, 0, arena_size);
+  } else {
+    free(arena);
+    arena = calloc(1, arena_size);
+    mapping->results_capacity = arena ? arena_size : 0;
+  }
+  if (arena) {
+    mapping->results = (mapping_result_t*)arena;
+    // Sums and times are aligned as size_t, narrower worker indexes go after
+    char* processed = arena + results_size;
+    char* times = processed + selected_count * processed_size;
+    char* workers = times + (selected_count + 1) * times_size;
+    size_t selected = 0;
+    for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+         ++mapping_index) {
+      // Results of other mappings keep null arrays
+      if (!(mapping->mappings & (1u << mapping_index))) {
+        continue;
+      }
+      mapping_result_t* result = &mapping->results[mapping_index];
+      result->units_processed =
+          (size_t*)(processed + selected * processed_size);
+      if (mapping->events) {
+        result->finish_times = (double*)(times + (selected + 1) * times_size);
+      }
+      if (units_workers) {
+        result->units_workers = workers + selected * workers_size;
+      }
+      ++selected;
+    }
+    if (mapping->events) {
+      mapping_calculate_speeds(mapping, (double*)times);
+    }
+  } else {
+    fprintf(stderr, "%s", "error: cannot allocate results\n");
+    mapping->results = NULL;
+    error = EXIT_FAILURE;
+  }
+  return error;
+}
+
+void mapping_calculate_speeds(mapping_t* mapping, double* speeds) {
+  assert(mapping);
+  assert(speeds);
+  mapping->speeds = speeds;
+  mapping->capacity = 0.0;
+  for (size_t worker_index = 0; worker_index < mapping->worker_count;
+       ++worker_index) {
+    speeds[worker_index] =
+        mapping->speed_pattern
+            ? mapping->speed_pattern[worker_index %
+                                     mapping->speed_pattern_count]
+            : 1.0;
+    mapping->capacity += speeds[worker_index];
+  }
+}
+
+int mapping_calculate_block(mapping_t* mapping) {
+  assert(mapping);
+  mapping_calculate_block_range(mapping, 0, mapping->unit_count,
+                                mapping->results[BLOCK].units_processed);
+  return EXIT_SUCCESS;
+}
+
+void mapping_calculate_block_range(mapping_t* mapping, size_t start,
+                                   size_t stop, size_t* units_processed) {
+  assert(mapping);
+  if (start >= stop) {
+    return;
+  }
+  // Map units to workers.
+  // Stopping point for a worker is the starting point for the next worker.
+  size_t worker_index = mapping_find_worker(mapping, start);
+  size_t worker_stop = mapping_find_start(mapping, worker_index + 1);
+  for (size_t unit_index = start; unit_index < stop; ++unit_index) {
+    while (unit_index >= worker_stop) {
+      ++worker_index;
+      worker_stop = mapping_find_start(mapping, worker_index + 1);
+    }
+    mapping_set_worker(mapping, BLOCK, unit_index, worker_index);
+    units_processed[worker_index] += mapping->units[unit_index];
+  }
+}
+
+size_t mapping_find_start(mapping_t* mapping, size_t worker_index) {
+  long block_size = 0;
+  long block_remainder = 0;
+  ldiv_t division = ldiv(mapping->unit_count, mapping->worker_count);
+  size_t division_quotient = division.quot;
+  size_t division_remainder = division.rem;
+  block_size = worker_index * division_quotient;
+  if (worker_index < division_remainder) {
+    block_remainder = worker_index;
+  } else {
+    block_remainder = division_remainder;
+  }
+  return block_size + block_remainder;
+}
+
+size_t mapping_find_worker(mapping_t* mapping, size_t unit_index) {
+  // First remainder workers have one more unit than the rest
+  const size_t quotient = mapping->unit_count / mapping->worker_count;
+  const size_t remainder = mapping->unit_count % mapping->worker_count;
+  const size_t larger_units = remainder * (quotient + 1);
+  if (unit_index < larger_units) {
+    return unit_index / (quotient + 1);
+  }
+  return remainder + (unit_index - larger_units) / quotient;
+}
+
+int mapping_calculate_cyclic(mapping_t* mapping) {
+  assert(mapping);
+  mapping_calculate_cyclic_range(mapping, 0, mapping->unit_count,
+                                 mapping->results[CYCLIC].units_processed);
+  return EXIT_SUCCESS;
+}
+
+void mapping_calculate_cyclic_range(mapping_t* mapping, size_t start,
+                                    size_t stop, size_t* units_processed) {
+  assert(mapping);
+  size_t worker_index = start % mapping->worker_count;
+  for (size_t unit_index = start; unit_index < stop; ++unit_index) {
+    mapping_set_worker(mapping, CYCLIC, unit_index, worker_index);
+    units_processed[worker_index] += mapping->units[unit_index];
+    // Next worker in cycle, avoiding a division per unit
+    if (++worker_index == mapping->worker_count) {
+      worker_index = 0;
+    }
+  }
+}
+
+int mapping_calculate_block_cyclic(mapping_t* mapping) {
+  assert(mapping);
+  mapping_calculate_block_cyclic_range(
+      mapping, 0, mapping->unit_count,
+      mapping->results[BLOCK_CYCLIC].units_processed);
+  return EXIT_SUCCESS;
+}
+
+void mapping_calculate_block_cyclic_range(mapping_t* mapping, size_t start,
+                                          size_t stop,
+                                          size_t* units_processed) {
+  assert(mapping);
+  const size_t block_size = mapping->block_size;
+  // Trailing units that do not fill a block are a shorter last block
+  size_t index = start % block_size;
+  size_t worker_index = (start / block_size) % mapping->worker_count;
+  for (size_t unit_index = start; unit_index < stop; ++unit_index) {
+    mapping_set_worker(mapping, BLOCK_CYCLIC, unit_index, worker_index);
+    units_processed[worker_index] += mapping->units[unit_index];
+    if (++index == block_size) {
+      index = 0;
+      if (++worker_index == mapping->worker_count) {
+        worker_index = 0;
+      }
+    }
+  }
+}
+
+int mapping_autotune(mapping_t* mapping) {
+  assert(mapping);
+  int error = EXIT_SUCCESS;
+  if (mapping->prefix_sums == NULL) {
+    error = mapping_calculate_prefix_sums(mapping);
+  }
+  size_t* loads = malloc(mapping->worker_count * sizeof(size_t));
+  if (error == EXIT_SUCCESS && loads == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate autotune loads\n");
+    error = EXIT_FAILURE;
+  }
+  if (error == EXIT_SUCCESS && mapping->unit_count > 0) {
+    const size_t total = mapping->prefix_sums[mapping->unit_count];
+    size_t lower_bound =
+        (total + mapping->worker_count - 1) / mapping->worker_count;
+    for (size_t unit_index = 0; unit_index < mapping->unit_count;
+         ++unit_index) {
+      if (mapping->units[unit_index] > lower_bound) {
+        lower_bound = mapping->units[unit_index];
+      }
+    }
+    size_t best_size = 1;
+    size_t best_maximum = SIZE_MAX;
+    for (size_t block_size = 1;
+         block_size <= mapping->unit_count && best_maximum > lower_bound;
+         ++block_size) {
+      const size_t maximum = mapping_find_block_cyclic_maximum(
+          mapping, block_size, loads, best_maximum);
+      if (maximum < best_maximum) {
+        best_maximum = maximum;
+        best_size = block_size;
+      }
+    }
+    mapping->block_size = best_size;
+  }
+  free(loads);
+  return error;
+}
+
+size_t mapping_find_block_cyclic_maximum(mapping_t* mapping,
+                                         size_t block_size, size_t* loads,
+                                         size_t limit) {
+  assert(mapping);
+  assert(mapping->prefix_sums);
+  assert(loads);
+  const size_t* prefix_sums = mapping->prefix_sums;
+  const size_t block_count =
+      (mapping->unit_count + block_size - 1) / block_size;
+  const size_t worker_count = block_count < mapping->worker_count
+                                  ? block_count
+                                  : mapping->worker_count;
+  memset(loads, 0, worker_count * sizeof(size_t));
+  size_t maximum = 0;
+  size_t worker_index = 0;
+  for (size_t start = 0; start < mapping->unit_count; start += block_size) {
+    const size_t stop = mapping->unit_count - start > block_size
+                            ? start + block_size
+                            : mapping->unit_count;
+    loads[worker_index] += prefix_sums[stop] - prefix_sums[start];
+    if (loads[worker_index] > maximum) {
+      maximum = loads[worker_index];
+      if (maximum >= limit) {
+        return limit;
+      }
+    }
+    if (++worker_index == worker_count) {
+      worker_index = 0;
+    }
+  }
+  return maximum;
+}
+
+int mapping_calculate_hierarchy(mapping_t* mapping) {
+  assert(mapping);
+  mapping_hierarchy_t* hierarchy = &mapping->hierarchy;
+  const size_t node_count = hierarchy->node_count;
+  const size_t node_threads = hierarchy->node_threads;
   int error = EXIT_SUCCESS;
-  size_t new_capacity = 0;
-  // Amortized memory allocation
-  if (mapping->units) {
-    new_capacity = 10 * mapping->unit_capacity;
+  // Node loads, imbalances and worker loads in a single allocation
+  char* arena = calloc(1, node_count * (sizeof(size_t) + sizeof(double)) +
+                              mapping->worker_count * sizeof(size_t));
+  size_t* offsets = calloc(node_count + 1, sizeof(size_t));
+  size_t* grouped = malloc((mapping->unit_count + 1) * sizeof(size_t));
+  // Each level is evaluated as a mapping of its own, sharing units
+  mapping_t level;
+  memset(&level, 0, sizeof(level));
+  level.block_size = mapping->block_size;
+  level.chunk_size = mapping->chunk_size;
+  level.units = mapping->units;
+  level.unit_count = mapping->unit_count;
+  level.worker_count = node_count;
+  // Only the results of the mapping of each level are allocated
+  level.mappings = 1u << hierarchy->node_mapping;
+  if (arena && offsets && grouped) {
+    hierarchy->node_loads = (size_t*)arena;
+    hierarchy->imbalances = (double*)(arena + node_count * sizeof(size_t));
+    hierarchy->result.units_processed =
+        (size_t*)(arena + node_count * (sizeof(size_t) + sizeof(double)));
+    error = mapping_allocate_results(&level);
   } else {
-    new_capacity = 10;
+    fprintf(stderr, "%s", "error: cannot allocate hierarchy\n");
+    free(arena);
+    error = EXIT_FAILURE;
   }
-  size_t* new_array = realloc(mapping->units, new_capacity * sizeof(long));
-  if (new_array) {
-    mapping->units = new_array;
-    mapping->unit_capacity = new_capacity;
+  if (error == EXIT_SUCCESS) {
+    error = mapping_policies[hierarchy->node_mapping].calculate(&level);
+  }
+  if (error == EXIT_SUCCESS) {
+    const mapping_result_t* nodes = &level.results[hierarchy->node_mapping];
+    memcpy(hierarchy->node_loads, nodes->units_processed,
+           node_count * sizeof(size_t));
+    // Group units by node (counting sort), keeping their order
+    for (size_t unit_index = 0; unit_index < mapping->unit_count;
+         ++unit_index) {
+      ++offsets[worker_ids_get(nodes->units_workers, level.worker_width,
+                               unit_index) + 1];
+    }
+    for (size_t node_index = 0; node_index < node_count; ++node_index) {
+      offsets[node_index + 1] += offsets[node_index];
+    }
+    for (size_t unit_index = 0; unit_index < mapping->unit_count;
+         ++unit_index) {
+      const size_t node_index = worker_ids_get(
+          nodes->units_workers, level.worker_width, unit_index);
+      grouped[offsets[node_index]++] = mapping->units[unit_index];
+    }
+    // Offsets were moved to the end of each group
+    memmove(offsets + 1, offsets, node_count * sizeof(size_t));
+    offsets[0] = 0;
+  }
+  level.summary = true;
+  level.worker_count = node_threads;
+  level.mappings = 1u << hierarchy->thread_mapping;
+  for (size_t node_index = 0; node_index < node_count && error == EXIT_SUCCESS;
+       ++node_index) {
+    level.units = grouped + offsets[node_index];
+    level.unit_count = offsets[node_index + 1] - offsets[node_index];
+    error = mapping_allocate_results(&level);
+    // Sorted units of previous node must not be used
+    if (error == EXIT_SUCCESS && hierarchy->thread_mapping == LPT) {
+      error = mapping_sort_units(&level);
+    }
+    if (error == EXIT_SUCCESS) {
+      error = mapping_policies[hierarchy->thread_mapping].calculate_loads(
+          &level);
+    }
+    if (error == EXIT_SUCCESS) {
+      memcpy(hierarchy->result.units_processed + node_index * node_threads,
+             level.results[hierarchy->thread_mapping].units_processed,
+             node_threads * sizeof(size_t));
+    }
+  }
+  if (error == EXIT_SUCCESS) {
+    mapping_calculate_imbalance(mapping);
+  }
+  free(level.results);
+  free(level.sorted_units);
+  free(grouped);
+  free(offsets);
+  return error;
+}
+
+void mapping_calculate_imbalance(mapping_t* mapping) {
+  assert(mapping);
+  mapping_hierarchy_t* hierarchy = &mapping->hierarchy;
+  const size_t node_threads = hierarchy->node_threads;
+  // Imbalance is maximum divided by mean, 1 if there is no load
+  const size_t node_maximum =
+      mapping_find_maximum(hierarchy->node_loads, hierarchy->node_count);
+  hierarchy->node_imbalance =
+      mapping->serial_sum > 0 ? (double)node_maximum * hierarchy->node_count /
+                                    mapping->serial_sum
+                              : 1.0;
+  for (size_t node_index = 0; node_index < hierarchy->node_count;
+       ++node_index) {
+    const size_t thread_maximum = mapping_find_maximum(
+        hierarchy->result.units_processed + node_index * node_threads,
+        node_threads);
+    const size_t node_load = hierarchy->node_loads[node_index];
+    hierarchy->imbalances[node_index] =
+        node_load > 0 ? (double)thread_maximum * node_threads / node_load
+                      : 1.0;
+  }
+  mapping_result_t* result = &hierarchy->result;
+  result->maximum = mapping_find_maximum(result->units_processed,
+                                         mapping->worker_count);
+  result->speedup = (double)mapping->serial_sum / (double)result->maximum;
+  result->efficiency = result->speedup / mapping->worker_count;
+}
+
+int mapping_calculate_dynamic(mapping_t* mapping) {
+  assert(mapping);
+  mapping_scheduler_t scheduler;
+  int error = mapping_scheduler_init(&scheduler, mapping, DYNAMIC);
+  if (error == EXIT_SUCCESS) {
+    // Map next unit to worker with minimum sum of processed units.
+    for (size_t unit_index = 0; unit_index < mapping->unit_count;
+         ++unit_index) {
+      const size_t worker_index =
+          mapping_scheduler_assign(&scheduler, mapping->units[unit_index]);
+      mapping_set_worker(mapping, DYNAMIC, unit_index, worker_index);
+    }
+    mapping_scheduler_destroy(&scheduler);
+  }
+  return error;
+}
+
+int mapping_calculate_chunked_dynamic(mapping_t* mapping) {
+  assert(mapping);
+  mapping_scheduler_t scheduler;
+  int error = mapping_scheduler_init(&scheduler, mapping, CHUNKED_DYNAMIC);
+  if (error == EXIT_SUCCESS) {
+    for (size_t start = 0; start < mapping->unit_count;
+         start += mapping->chunk_size) {
+      size_t stop = start + mapping->chunk_size;
+      if (stop > mapping->unit_count) {
+        stop = mapping->unit_count;
+      }
+      mapping_assign_chunk(mapping, CHUNKED_DYNAMIC, &scheduler, start, stop);
+    }
+    mapping_scheduler_destroy(&scheduler);
+  }
+  return error;
+}
+
+int mapping_calculate_guided(mapping_t* mapping) {
+  assert(mapping);
+  mapping_scheduler_t scheduler;
+  int error = mapping_scheduler_init(&scheduler, mapping, GUIDED);
+  if (error == EXIT_SUCCESS) {
+    size_t start = 0;
+    while (start < mapping->unit_count) {
+      const size_t remaining = mapping->unit_count - start;
+      const size_t length = mapping_find_guided_length(mapping, remaining);
+      mapping_assign_chunk(mapping, GUIDED, &scheduler, start, start + length);
+      start += length;
+    }
+    mapping_scheduler_destroy(&scheduler);
+  }
+  return error;
+}
+
+size_t mapping_find_guided_length(mapping_t* mapping, size_t remaining) {
+  assert(mapping);
+  size_t length =
+      (remaining + mapping->worker_count - 1) / mapping->worker_count;
+  if (length < mapping->chunk_size) {
+    length = mapping->chunk_size;
+  }
+  if (length > remaining) {
+    length = remaining;
+  }
+  return length;
+}
+
+int mapping_calculate_lpt(mapping_t* mapping) {
+  assert(mapping);
+  mapping_scheduler_t scheduler;
+  // Pairs of value and index, sorted by decreasing value. No units, no pairs
+  const size_t unit_count = mapping->unit_count;
+  size_t* order = unit_count ? malloc(2 * unit_count * sizeof(size_t)) : NULL;
+  int error = EXIT_SUCCESS;
+  if (order || unit_count == 0) {
+    error = mapping_scheduler_init(&scheduler, mapping, LPT);
   } else {
-    fprintf(stderr, "%s", "error: cannot resize unit array\n");
+    fprintf(stderr, "%s", "error: cannot allocate LPT order\n");
+    error = EXIT_FAILURE;
+  }
+  if (error == EXIT_SUCCESS) {
+    for (size_t unit_index = 0; unit_index < unit_count; ++unit_index) {
+      order[2 * unit_index] = mapping->units[unit_index];
+      order[2 * unit_index + 1] = unit_index;
+    }
+    if (unit_count > 0) {
+      qsort(order, unit_count, 2 * sizeof(size_t), mapping_compare_lpt);
+    }
+    for (size_t index = 0; index < unit_count; ++index) {
+      const size_t worker_index =
+          mapping_scheduler_assign(&scheduler, order[2 * index]);
+      mapping_set_worker(mapping, LPT, order[2 * index + 1], worker_index);
+    }
+    mapping_scheduler_destroy(&scheduler);
+  }
+  free(order);
+  return error;
+}
+
+int mapping_compare_lpt(const void* first, const void* second) {
+  const size_t* first_unit = (const size_t*)first;
+  const size_t* second_unit = (const size_t*)second;
+  if (first_unit[0] != second_unit[0]) {
+    return first_unit[0] > second_unit[0] ? -1 : 1;
+  }
+  return first_unit[1] < second_unit[1] ? -1 : 1;
+}
+
+void mapping_assign_chunk(mapping_t* mapping, size_t mapping_index,
+                          mapping_scheduler_t* scheduler, size_t start,
+                          size_t stop) {
+  assert(mapping);
+  assert(scheduler);
+  size_t sum = 0;
+  for (size_t unit_index = start; unit_index < stop; ++unit_index) {
+    sum += mapping->units[unit_index];
+  }
+  const size_t worker_index = mapping_scheduler_assign(scheduler, sum);
+  for (size_t unit_index = start; unit_index < stop; ++unit_index) {
+    mapping_set_worker(mapping, mapping_index, unit_index, worker_index);
+  }
+}
+
+int mapping_scheduler_init(mapping_scheduler_t* scheduler, mapping_t* mapping,
+                           size_t mapping_index) {
+  assert(scheduler);
+  assert(mapping);
+  mapping_result_t* result = &mapping->results[mapping_index];
+  scheduler->loads = result->units_processed;
+  scheduler->worker_count = mapping->worker_count;
+  scheduler->use_events = mapping->events;
+  const size_t linear_max_workers =
+      load_search_get_kernel() == LOAD_SEARCH_SCALAR
+          ? DYNAMIC_LINEAR_MAX_WORKERS
+          : DYNAMIC_VECTOR_LINEAR_MAX_WORKERS;
+  scheduler->use_heap = !scheduler->use_events &&
+                        scheduler->worker_count > linear_max_workers;
+  if (scheduler->use_events) {
+    return event_queue_init(&scheduler->events, result->finish_times,
+                            mapping->speeds, scheduler->worker_count,
+                            mapping->overhead);
+  }
+  if (scheduler->use_heap) {
+    return worker_heap_init(&scheduler->heap, scheduler->loads,
+                            scheduler->worker_count);
+  }
+  return EXIT_SUCCESS;
+}
+
+size_t mapping_scheduler_assign(mapping_scheduler_t* scheduler, size_t load) {
+  assert(scheduler);
+  if (scheduler->use_events) {
+    const size_t worker_index = event_queue_dispatch(&scheduler->events, load);
+    scheduler->loads[worker_index] += load;
+    return worker_index;
+  }
+  if (scheduler->use_heap) {
+    return worker_heap_add_to_top(&scheduler->heap, load);
+  }
+  const size_t worker_index =
+      mapping_find_argmin(scheduler->loads, scheduler->worker_count);
+  scheduler->loads[worker_index] += load;
+  return worker_index;
+}
+
+void mapping_scheduler_destroy(mapping_scheduler_t* scheduler) {
+  assert(scheduler);
+  if (scheduler->use_events) {
+    event_queue_destroy(&scheduler->events);
+  } else if (scheduler->use_heap) {
+    worker_heap_destroy(&scheduler->heap);
+  }
+}
+
+size_t mapping_find_argmin(const size_t* loads, size_t worker_count) {
+  assert(loads);
+  return load_search_argmin(loads, worker_count);
+}
+
+int mapping_sweep(mapping_t* mapping) {
+  assert(mapping);
+  int error = mapping_calculate_prefix_sums(mapping);
+  if (error == EXIT_SUCCESS) {
+    error = mapping_sort_units(mapping);
+  }
+  mapping_sweep_t sweep;
+  sweep.mapping = mapping;
+  sweep.worker_counts = mapping_count_sweep_range(&mapping->sweep_workers);
+  sweep.block_sizes = mapping_count_sweep_range(&mapping->sweep_blocks);
+  sweep.maxima = NULL;
+  atomic_init(&sweep.next_worker_count, 0);
+  if (error == EXIT_SUCCESS) {
+    mapping->serial_sum = mapping->prefix_sums[mapping->unit_count];
+    sweep.maxima = malloc(sweep.worker_counts * sweep.block_sizes *
+                          MAPPING_COUNT * sizeof(size_t));
+    if (sweep.maxima == NULL) {
+      fprintf(stderr, "%s", "error: cannot allocate sweep results\n");
+      error = EXIT_FAILURE;
+    }
+  }
+  if (error == EXIT_SUCCESS) {
+    size_t thread_count = mapping->thread_count;
+    if (thread_count > sweep.worker_counts) {
+      thread_count = sweep.worker_counts;
+    }
+    pthread_t* threads = malloc(thread_count * sizeof(pthread_t));
+    mapping_sweep_thread_t* thread_data =
+        calloc(thread_count, sizeof(mapping_sweep_thread_t));
+    if (threads && thread_data) {
+      // The calling thread is one of the workers
+      thread_data[0].sweep = &sweep;
+      size_t created = 1;
+      for (; created < thread_count; ++created) {
+        thread_data[created].sweep = &sweep;
+        if (pthread_create(&threads[created], NULL, mapping_sweep_thread,
+                           &thread_data[created]) != 0) {
+          fprintf(stderr, "%s", "error: cannot create sweep thread\n");
+          error = EXIT_FAILURE;
+          break;
+        }
+      }
+      mapping_sweep_thread(&thread_data[0]);
+      for (size_t thread_index = 0; thread_index < created; ++thread_index) {
+        if (thread_index > 0) {
+          pthread_join(threads[thread_index], NULL);
+        }
+        if (thread_data[thread_index].error != EXIT_SUCCESS) {
+          error = thread_data[thread_index].error;
+        }
+      }
+    } else {
+      fprintf(stderr, "%s", "error: cannot allocate sweep threads\n");
+      error = EXIT_FAILURE;
+    }
+    free(thread_data);
+    free(threads);
+  }
+  if (error == EXIT_SUCCESS) {
+    error = mapping_print_sweep(&sweep);
+  }
+  free(sweep.maxima);
+  return error;
+}
+
+void* mapping_sweep_thread(void* data) {
+  assert(data);
+  mapping_sweep_thread_t* thread_data = (mapping_sweep_thread_t*)data;
+  mapping_sweep_t* sweep = thread_data->sweep;
+  const mapping_sweep_range_t* workers = &sweep->mapping->sweep_workers;
+  const mapping_sweep_range_t* blocks = &sweep->mapping->sweep_blocks;
+  // Each thread evaluates its own copy of mapping data, without units-workers
+  mapping_t mapping = *sweep->mapping;
+  mapping_result_t results[MAPPING_COUNT];
+  size_t* loads = calloc(MAPPING_COUNT * workers->last, sizeof(size_t));
+  if (loads == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate sweep loads\n");
+    thread_data->error = EXIT_FAILURE;
+    return NULL;
+  }
+  memset(results, 0, sizeof(results));
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    results[mapping_index].units_processed =
+        loads + mapping_index * workers->last;
+  }
+  mapping.results = results;
+  int error = EXIT_SUCCESS;
+  while (error == EXIT_SUCCESS) {
+    const size_t worker_index = atomic_fetch_add(&sweep->next_worker_count, 1);
+    if (worker_index >= sweep->worker_counts) {
+      break;
+    }
+    mapping.worker_count = workers->first + worker_index * workers->step;
+    size_t* maxima =
+        sweep->maxima + worker_index * sweep->block_sizes * MAPPING_COUNT;
+    for (size_t block_index = 0;
+         block_index < sweep->block_sizes && error == EXIT_SUCCESS;
+         ++block_index) {
+      mapping.block_size = blocks->first + block_index * blocks->step;
+      for (size_t mapping_index = 0;
+           mapping_index < MAPPING_COUNT && error == EXIT_SUCCESS;
+           ++mapping_index) {
+        // Only block-cyclic mapping depends on block size
+        if (block_index > 0 && mapping_index != BLOCK_CYCLIC) {
+          maxima[mapping_index] = maxima[mapping_index - MAPPING_COUNT];
+          continue;
+        }
+        size_t* units_processed = results[mapping_index].units_processed;
+        memset(units_processed, 0, mapping.worker_count * sizeof(size_t));
+        error = mapping_policies[mapping_index].calculate_loads(&mapping);
+        maxima[mapping_index] =
+            mapping_find_maximum(units_processed, mapping.worker_count);
+      }
+      maxima += MAPPING_COUNT;
+    }
+  }
+  free(loads);
+  thread_data->error = error;
+  return NULL;
+}
+
+int mapping_print_sweep(mapping_sweep_t* sweep) {
+  assert(sweep);
+  writer_t writer;
+  int error = writer_open(&writer, STDOUT_FILENO);
+  if (error == EXIT_SUCCESS) {
+    switch (sweep->mapping->format) {
+      case FORMAT_CSV:
+        mapping_print_sweep_csv(sweep, &writer);
+        break;
+      case FORMAT_JSON:
+        mapping_print_sweep_json(sweep, &writer);
+        break;
+      default:
+        mapping_print_sweep_text(sweep, &writer);
+        break;
+    }
+  }
+  return writer_close(&writer);
+}
+
+void mapping_print_sweep_text(mapping_sweep_t* sweep, writer_t* writer) {
+  assert(sweep);
+  const mapping_t* mapping = sweep->mapping;
+  writer_printf(writer, "%zu units\n", mapping->unit_count);
+  writer_printf(writer, "Serially processed units: %zu\n", mapping->serial_sum);
+  writer_put_char(writer, '\n');
+  writer_printf(writer, "%7s %7s", "Workers", "Block");
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    writer_printf(writer, "  %-18s", mapping_policies[mapping_index].name);
+  }
+  writer_printf(writer, "\n%15s", "");
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    writer_printf(writer, "  %7s %10s", "Speedup", "Efficiency");
+  }
+  writer_put_char(writer, '\n');
+  const size_t* maxima = sweep->maxima;
+  for (size_t worker_index = 0; worker_index < sweep->worker_counts;
+       ++worker_index) {
+    const size_t worker_count = mapping->sweep_workers.first +
+                                worker_index * mapping->sweep_workers.step;
+    for (size_t block_index = 0; block_index < sweep->block_sizes;
+         ++block_index) {
+      const size_t block_size = mapping->sweep_blocks.first +
+                                block_index * mapping->sweep_blocks.step;
+      writer_printf(writer, "%7zu %7zu", worker_count, block_size);
+      for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+           ++mapping_index) {
+        const double speedup =
+            (double)mapping->serial_sum / (double)maxima[mapping_index];
+        writer_printf(writer, "  %7.3lf %10.3lf", speedup,
+                      speedup / worker_count);
+      }
+      writer_put_char(writer, '\n');
+      maxima += MAPPING_COUNT;
+    }
+  }
+}
+
+void mapping_print_sweep_csv(mapping_sweep_t* sweep, writer_t* writer) {
+  assert(sweep);
+  const mapping_t* mapping = sweep->mapping;
+  writer_put_string(writer, "workers,block_size,mapping,maximum,speedup,"
+                            "efficiency\n");
+  const size_t* maxima = sweep->maxima;
+  for (size_t worker_index = 0; worker_index < sweep->worker_counts;
+       ++worker_index) {
+    const size_t worker_count = mapping->sweep_workers.first +
+                                worker_index * mapping->sweep_workers.step;
+    for (size_t block_index = 0; block_index < sweep->block_sizes;
+         ++block_index) {
+      const size_t block_size = mapping->sweep_blocks.first +
+                                block_index * mapping->sweep_blocks.step;
+      for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+           ++mapping_index) {
+        const double speedup =
+            (double)mapping->serial_sum / (double)maxima[mapping_index];
+        writer_printf(writer, "%zu,%zu,%s,%zu,%.6lf,%.6lf\n", worker_count,
+                      block_size, mapping_policies[mapping_index].name,
+                      maxima[mapping_index], speedup, speedup / worker_count);
+      }
+      maxima += MAPPING_COUNT;
+    }
+  }
+}
+
+void mapping_print_sweep_json(mapping_sweep_t* sweep, writer_t* writer) {
+  assert(sweep);
+  const mapping_t* mapping = sweep->mapping;
+  writer_printf(writer, "{\"units\":%zu,\"serial_sum\":%zu,",
+                mapping->unit_count, mapping->serial_sum);
+  writer_put_string(writer, "\"configurations\":[");
+  const size_t* maxima = sweep->maxima;
+  for (size_t worker_index = 0; worker_index < sweep->worker_counts;
+       ++worker_index) {
+    const size_t worker_count = mapping->sweep_workers.first +
+                                worker_index * mapping->sweep_workers.step;
+    for (size_t block_index = 0; block_index < sweep->block_sizes;
+         ++block_index) {
+      const size_t block_size = mapping->sweep_blocks.first +
+                                block_index * mapping->sweep_blocks.step;
+      if (worker_index > 0 || block_index > 0) {
+        writer_put_char(writer, ',');
+      }
+      writer_printf(writer, "\n{\"workers\":%zu,\"block_size\":%zu,",
+                    worker_count, block_size);
+      writer_put_string(writer, "\"mappings\":[");
+      for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+           ++mapping_index) {
+        const double speedup =
+            (double)mapping->serial_sum / (double)maxima[mapping_index];
+        writer_printf(writer, "%s{\"name\":\"%s\",\"maximum\":%zu,",
+                      mapping_index > 0 ? "," : "",
+                      mapping_policies[mapping_index].name,
+                      maxima[mapping_index]);
+        writer_put_string(writer, "\"speedup\":");
+        mapping_print_number(writer, speedup);
+        writer_put_string(writer, ",\"efficiency\":");
+        mapping_print_number(writer, speedup / worker_count);
+        writer_put_char(writer, '}');
+      }
+      writer_put_string(writer, "]}");
+      maxima += MAPPING_COUNT;
+    }
+  }
+  writer_put_string(writer, "\n]}\n");
+}
+
+int mapping_batch(mapping_t* mapping) {
+  assert(mapping);
+  mapping_batch_t batch;
+  memset(&batch, 0, sizeof(mapping_batch_t));
+  batch.mapping = mapping;
+  mapping_init_params(&batch.params);
+  batch.params.worker_count = mapping->worker_count;
+  batch.params.block_size = mapping->block_size;
+  batch.params.chunk_size = mapping->chunk_size;
+  batch.params.index = mapping->index;
+  batch.params.events = mapping->events;
+  batch.params.overhead = mapping->overhead;
+  batch.params.speeds = mapping->speed_pattern;
+  batch.params.speed_count = mapping->speed_pattern_count;
+  atomic_init(&batch.next_file, 0);
+  int error = mapping_find_batch_files(&batch, mapping->batch);
+  if (error == EXIT_SUCCESS) {
+    // Results of all files are written once, after every file is evaluated
+    batch.unit_counts = calloc(batch.file_count, sizeof(size_t));
+    batch.serial_sums = calloc(batch.file_count, sizeof(size_t));
+    batch.errors = calloc(batch.file_count, sizeof(int));
+    batch.outcomes =
+        calloc(batch.file_count * MAPPING_COUNT, sizeof(mapping_outcome_t));
+    if (batch.unit_counts == NULL || batch.serial_sums == NULL ||
+        batch.errors == NULL || batch.outcomes == NULL) {
+      fprintf(stderr, "%s", "error: cannot allocate batch results\n");
+      error = EXIT_FAILURE;
+    }
+  }
+  if (error == EXIT_SUCCESS) {
+    size_t thread_count = mapping->thread_count;
+    if (thread_count > batch.file_count) {
+      thread_count = batch.file_count;
+    }
+    pthread_t* threads = malloc(thread_count * sizeof(pthread_t));
+    mapping_batch_thread_t* thread_data =
+        calloc(thread_count, sizeof(mapping_batch_thread_t));
+    if (threads && thread_data) {
+      // The calling thread is one of the workers
+      thread_data[0].batch = &batch;
+      size_t created = 1;
+      for (; created < thread_count; ++created) {
+        thread_data[created].batch = &batch;
+        if (pthread_create(&threads[created], NULL, mapping_batch_thread,
+                           &thread_data[created]) != 0) {
+          fprintf(stderr, "%s", "error: cannot create batch thread\n");
+          error = EXIT_FAILURE;
+          break;
+        }
+      }
+      mapping_batch_thread(&thread_data[0]);
+      for (size_t thread_index = 0; thread_index < created; ++thread_index) {
+        if (thread_index > 0) {
+          pthread_join(threads[thread_index], NULL);
+        }
+        if (thread_data[thread_index].error != EXIT_SUCCESS) {
+          error = thread_data[thread_index].error;
+        }
+      }
+    } else {
+      fprintf(stderr, "%s", "error: cannot allocate batch threads\n");
+      error = EXIT_FAILURE;
+    }
+    free(thread_data);
+    free(threads);
+  }
+  // Files that failed are left out, the others are still reported
+  if (batch.errors) {
+    const int print_error = mapping_print_batch(&batch);
+    for (size_t file_index = 0; file_index < batch.file_count; ++file_index) {
+      if (batch.errors[file_index] != EXIT_SUCCESS) {
+        error = batch.errors[file_index];
+      }
+    }
+    if (error == EXIT_SUCCESS) {
+      error = print_error;
+    }
+  }
+  free(batch.outcomes);
+  free(batch.errors);
+  free(batch.serial_sums);
+  free(batch.unit_counts);
+  free(batch.paths);
+  globfree(&batch.matches);
+  return error;
+}
+
+int mapping_find_batch_files(mapping_batch_t* batch, const char* path) {
+  assert(batch);
+  assert(path);
+  int error = EXIT_SUCCESS;
+  // A directory stands for all of its files
+  char* pattern = NULL;
+  struct stat status;
+  if (stat(path, &status) == 0 && S_ISDIR(status.st_mode)) {
+    const size_t length = strlen(path);
+    pattern = malloc(length + 3);
+    if (pattern) {
+      memcpy(pattern, path, length);
+      strcpy(pattern + length, length > 0 && path[length - 1] == '/' ? "*"
+                                                                      : "/*");
+    } else {
+      fprintf(stderr, "%s", "error: cannot allocate batch pattern\n");
+      error = EXIT_FAILURE;
+    }
+  }
+  if (error == EXIT_SUCCESS) {
+    // Matches are sorted by name, so reports do not depend on thread count
+    const int result = glob(pattern ? pattern : path, 0, NULL, &batch->matches);
+    if (result == 0) {
+      batch->paths = malloc(batch->matches.gl_pathc * sizeof(char*));
+      if (batch->paths) {
+        for (size_t match = 0; match < batch->matches.gl_pathc; ++match) {
+          char* file = batch->matches.gl_pathv[match];
+          if (stat(file, &status) == 0 && S_ISREG(status.st_mode)) {
+            batch->paths[batch->file_count++] = file;
+          }
+        }
+      } else {
+        fprintf(stderr, "%s", "error: cannot allocate batch paths\n");
+        error = EXIT_FAILURE;
+      }
+    } else if (result != GLOB_NOMATCH) {
+      fprintf(stderr, "error: cannot list input files of %s\n", path);
+      error = EXIT_FAILURE;
+    }
+  }
+  if (error == EXIT_SUCCESS && batch->file_count == 0) {
+    fprintf(stderr, "error: no input files in %s\n", path);
     error = EXIT_FAILURE;
   }
+  free(pattern);
   return error;
 }
 
-int mapping_calculate(mapping_t* mapping) {
+void* mapping_batch_thread(void* data) {
+  assert(data);
+  mapping_batch_thread_t* thread_data = (mapping_batch_thread_t*)data;
+  mapping_batch_t* batch = thread_data->batch;
+  // Arrays of this mapping grow to the largest file of this thread, and are
+  // reused by its next files
+  mapping_t* mapping = mapping_create();
+  if (mapping == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate batch mapping\n");
+    thread_data->error = EXIT_FAILURE;
+    return NULL;
+  }
+  while (true) {
+    const size_t file_index = atomic_fetch_add(&batch->next_file, 1);
+    if (file_index >= batch->file_count) {
+      break;
+    }
+    batch->errors[file_index] =
+        mapping_evaluate_batch_file(batch, mapping, file_index);
+  }
+  mapping_destroy(mapping);
+  return NULL;
+}
+
+int mapping_evaluate_batch_file(mapping_batch_t* batch, mapping_t* mapping,
+                                size_t file_index) {
+  assert(batch);
   assert(mapping);
+  const char* path = batch->paths[file_index];
   int error = EXIT_SUCCESS;
-  error = mapping_allocate_results(mapping);
-  if (error == EXIT_SUCCESS) {
-    mapping_calculate_block(mapping);
-    mapping_calculate_cyclic(mapping);
-    mapping_calculate_block_cyclic(mapping);
-    mapping_calculate_dynamic(mapping);
-    mapping_calculate_results(mapping);
+  // Regular files are mapped in memory by the unit reader
+  const int fd = open(path, O_RDONLY);
+  if (fd >= 0) {
+    error = mapping_read_units(mapping, fd);
+    close(fd);
+    if (error == EXIT_SUCCESS) {
+      error = mapping_evaluate(mapping, mapping->units, mapping->unit_count,
+                               &batch->params,
+                               batch->outcomes + file_index * MAPPING_COUNT);
+    }
+    if (error == EXIT_SUCCESS) {
+      batch->unit_counts[file_index] = mapping->unit_count;
+      batch->serial_sums[file_index] = mapping->serial_sum;
+    } else {
+      fprintf(stderr, "error: cannot evaluate %s\n", path);
+    }
+  } else {
+    fprintf(stderr, "error: cannot open %s: %s\n", path, strerror(errno));
+    error = EXIT_FAILURE;
   }
   return error;
 }
 
-int mapping_allocate_results(mapping_t* mapping) {
-  assert(mapping);
-  int error = EXIT_SUCCESS;
-  mapping->results = calloc(MAPPING_COUNT, sizeof(mapping_result_t));
-  if (mapping->results) {
+int mapping_print_batch(mapping_batch_t* batch) {
+  assert(batch);
+  writer_t writer;
+  int error = writer_open(&writer, STDOUT_FILENO);
+  if (error == EXIT_SUCCESS) {
+    switch (batch->mapping->format) {
+      case FORMAT_CSV:
+        mapping_print_batch_csv(batch, &writer);
+        break;
+      case FORMAT_JSON:
+        mapping_print_batch_json(batch, &writer);
+        break;
+      default:
+        mapping_print_batch_text(batch, &writer);
+        break;
+    }
+  }
+  return writer_close(&writer);
+}
+
+void mapping_print_batch_text(mapping_batch_t* batch, writer_t* writer) {
+  assert(batch);
+  const mapping_t* mapping = batch->mapping;
+  writer_printf(writer, "%zu files, %zu workers\n", batch->file_count,
+                mapping->worker_count);
+  writer_printf(writer, "Block size: %zu\n", mapping->block_size);
+  writer_printf(writer, "Chunk size: %zu\n", mapping->chunk_size);
+  if (mapping->events) {
+    writer_printf(writer, "Dispatch overhead: %g\n", mapping->overhead);
+  }
+  writer_put_char(writer, '\n');
+  writer_printf(writer, "%10s", "Units");
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    writer_printf(writer, "  %-18s", mapping_policies[mapping_index].name);
+  }
+  writer_printf(writer, "  %s\n%10s", "File", "");
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    writer_printf(writer, "  %7s %10s", "Speedup", "Efficiency");
+  }
+  writer_put_char(writer, '\n');
+  // Mean of each mapping over evaluated files with units
+  double speedups[MAPPING_COUNT] = {0.0};
+  double efficiencies[MAPPING_COUNT] = {0.0};
+  size_t averaged = 0;
+  for (size_t file_index = 0; file_index < batch->file_count; ++file_index) {
+    if (batch->errors[file_index] != EXIT_SUCCESS) {
+      continue;
+    }
+    const mapping_outcome_t* outcomes =
+        batch->outcomes + file_index * MAPPING_COUNT;
+    writer_printf(writer, "%10zu", batch->unit_counts[file_index]);
     for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
          ++mapping_index) {
-      mapping->results[mapping_index].units_workers =
-          calloc(mapping->unit_count, sizeof(size_t));
-      if (mapping->results[mapping_index].units_workers) {
-        mapping->results[mapping_index].units_processed =
-            calloc(mapping->worker_count, sizeof(size_t));
-        if (mapping->results[mapping_index].units_processed) {
-        } else {
-          fprintf(stderr, "%s",
-                  "error: cannot allocate processed units array\n");
-          error = EXIT_FAILURE;
-        }
-      } else {
-        fprintf(stderr, "%s", "error: cannot allocate units-workers array\n");
-        error = EXIT_FAILURE;
+      writer_printf(writer, "  %7.3lf %10.3lf", outcomes[mapping_index].speedup,
+                    outcomes[mapping_index].efficiency);
+      if (batch->unit_counts[file_index] > 0) {
+        speedups[mapping_index] += outcomes[mapping_index].speedup;
+        efficiencies[mapping_index] += outcomes[mapping_index].efficiency;
       }
     }
-  } else {
-    fprintf(stderr, "%s", "error: cannot allocate results\n");
-    error = EXIT_FAILURE;
+    writer_printf(writer, "  %s\n", batch->paths[file_index]);
+    averaged += batch->unit_counts[file_index] > 0;
+  }
+  if (averaged > 1) {
+    writer_printf(writer, "%10s", "");
+    for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+         ++mapping_index) {
+      writer_printf(writer, "  %7.3lf %10.3lf",
+                    speedups[mapping_index] / averaged,
+                    efficiencies[mapping_index] / averaged);
+    }
+    writer_printf(writer, "  %s\n", "Mean");
   }
-  return error;
 }
 
-void mapping_calculate_block(mapping_t* mapping) {
-  assert(mapping);
-  size_t start = 0;
-  size_t stop = 0;
-  // Map units to workers.
-  // Stopping point for a worker is the starting point for the next worker.
-  for (size_t worker_index = 0; worker_index < mapping->worker_count;
-       ++worker_index) {
-    start = mapping_find_start(mapping, worker_index);
-    stop = mapping_find_start(mapping, worker_index + 1);
-    for (size_t unit_index = start; unit_index < stop; ++unit_index) {
-      mapping->results[BLOCK].units_workers[unit_index] = worker_index;
+void mapping_print_batch_csv(mapping_batch_t* batch, writer_t* writer) {
+  assert(batch);
+  const mapping_t* mapping = batch->mapping;
+  writer_put_string(writer, "file,mapping,units,serial_sum,workers,"
+                            "block_size,chunk_size,maximum,speedup,"
+                            "efficiency");
+  if (mapping->events) {
+    writer_put_string(writer, ",overhead,makespan");
+  }
+  writer_put_char(writer, '\n');
+  for (size_t file_index = 0; file_index < batch->file_count; ++file_index) {
+    if (batch->errors[file_index] != EXIT_SUCCESS) {
+      continue;
+    }
+    const mapping_outcome_t* outcomes =
+        batch->outcomes + file_index * MAPPING_COUNT;
+    for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+         ++mapping_index) {
+      const mapping_outcome_t* outcome = &outcomes[mapping_index];
+      mapping_print_csv_field(writer, batch->paths[file_index]);
+      writer_printf(writer, ",%s,%zu,%zu,%zu,%zu,%zu,%zu,%.6lf,%.6lf",
+                    mapping_policies[mapping_index].name,
+                    batch->unit_counts[file_index],
+                    batch->serial_sums[file_index], mapping->worker_count,
+                    mapping->block_size, mapping->chunk_size,
+                    outcome->maximum, outcome->speedup, outcome->efficiency);
+      if (mapping->events) {
+        writer_printf(writer, ",%g,%.6lf", mapping->overhead,
+                      outcome->makespan);
+      }
+      writer_put_char(writer, '\n');
     }
   }
 }
 
-size_t mapping_find_start(mapping_t* mapping, size_t worker_index) {
-  long block_size = 0;
-  long block_remainder = 0;
-  ldiv_t division = ldiv(mapping->unit_count, mapping->worker_count);
-  size_t division_quotient = division.quot;
-  size_t division_remainder = division.rem;
-  block_size = worker_index * division_quotient;
-  if (worker_index < division_remainder) {
-    block_remainder = worker_index;
-  } else {
-    block_remainder = division_remainder;
+void mapping_print_batch_json(mapping_batch_t* batch, writer_t* writer) {
+  assert(batch);
+  const mapping_t* mapping = batch->mapping;
+  writer_printf(writer,
+                "{\"workers\":%zu,\"block_size\":%zu,\"chunk_size\":%zu,",
+                mapping->worker_count, mapping->block_size,
+                mapping->chunk_size);
+  if (mapping->events) {
+    writer_put_string(writer, "\"overhead\":");
+    mapping_print_number(writer, mapping->overhead);
+    writer_put_char(writer, ',');
   }
-  return block_size + block_remainder;
+  writer_put_string(writer, "\"files\":[");
+  bool first = true;
+  for (size_t file_index = 0; file_index < batch->file_count; ++file_index) {
+    if (batch->errors[file_index] != EXIT_SUCCESS) {
+      continue;
+    }
+    writer_put_string(writer, first ? "\n{\"file\":" : ",\n{\"file\":");
+    first = false;
+    mapping_print_json_string(writer, batch->paths[file_index]);
+    writer_printf(writer, ",\"units\":%zu,\"serial_sum\":%zu,",
+                  batch->unit_counts[file_index],
+                  batch->serial_sums[file_index]);
+    writer_put_string(writer, "\"mappings\":[");
+    const mapping_outcome_t* outcomes =
+        batch->outcomes + file_index * MAPPING_COUNT;
+    for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+         ++mapping_index) {
+      const mapping_outcome_t* outcome = &outcomes[mapping_index];
+      writer_printf(writer, "%s{\"name\":\"%s\",\"maximum\":%zu,",
+                    mapping_index > 0 ? "," : "",
+                    mapping_policies[mapping_index].name, outcome->maximum);
+      writer_put_string(writer, "\"speedup\":");
+      mapping_print_number(writer, outcome->speedup);
+      writer_put_string(writer, ",\"efficiency\":");
+      mapping_print_number(writer, outcome->efficiency);
+      if (mapping->events) {
+        writer_put_string(writer, ",\"makespan\":");
+        mapping_print_number(writer, outcome->makespan);
+      }
+      writer_put_char(writer, '}');
+    }
+    writer_put_string(writer, "]}");
+  }
+  writer_put_string(writer, "\n]}\n");
+}
+
+void mapping_print_csv_field(writer_t* writer, const char* text) {
+  assert(text);
+  if (strpbrk(text, ",\"\r\n") == NULL) {
+    writer_put_string(writer, text);
+    return;
+  }
+  // Quotes inside a quoted field are doubled
+  writer_put_char(writer, '"');
+  for (const char* character = text; *character; ++character) {
+    if (*character == '"') {
+      writer_put_char(writer, '"');
+    }
+    writer_put_char(writer, *character);
+  }
+  writer_put_char(writer, '"');
+}
+
+void mapping_print_json_string(writer_t* writer, const char* text) {
+  assert(text);
+  writer_put_char(writer, '"');
+  for (const char* character = text; *character; ++character) {
+    const unsigned char code = (unsigned char)*character;
+    if (code == '"' || code == '\\') {
+      writer_put_char(writer, '\\');
+      writer_put_char(writer, *character);
+    } else if (code < 0x20) {
+      writer_printf(writer, "\\u%04x", code);
+    } else {
+      writer_put_char(writer, *character);
+    }
+  }
+  writer_put_char(writer, '"');
 }
 
-void mapping_calculate_cyclic(mapping_t* mapping) {
+int mapping_calculate_prefix_sums(mapping_t* mapping) {
   assert(mapping);
+  if (mapping->prefix_sums == NULL ||
+      mapping->unit_count > mapping->prefix_capacity) {
+    free(mapping->prefix_sums);
+    mapping->prefix_capacity = mapping->unit_count;
+    mapping->prefix_sums = malloc((mapping->unit_count + 1) * sizeof(size_t));
+    if (mapping->prefix_sums == NULL) {
+      fprintf(stderr, "%s", "error: cannot allocate prefix sums\n");
+      mapping->prefix_capacity = 0;
+      return EXIT_FAILURE;
+    }
+  }
+  mapping->prefix_sums[0] = 0;
   for (size_t unit_index = 0; unit_index < mapping->unit_count; ++unit_index) {
-    mapping->results[CYCLIC].units_workers[unit_index] =
-        unit_index % mapping->worker_count;
+    mapping->prefix_sums[unit_index + 1] =
+        mapping->prefix_sums[unit_index] + mapping->units[unit_index];
   }
+  return EXIT_SUCCESS;
 }
 
-void mapping_calculate_block_cyclic(mapping_t* mapping) {
+int mapping_sort_units(mapping_t* mapping) {
   assert(mapping);
-  ldiv_t division = ldiv(mapping->unit_count, mapping->block_size);
-  size_t block_count = division.quot;
-  for (size_t block_index = 0; block_index < block_count; ++block_index) {
-    for (size_t index = 0; index < mapping->block_size; ++index) {
-      mapping->results[BLOCK_CYCLIC]
-          .units_workers[block_index * mapping->block_size + index] =
-          block_index % mapping->worker_count;
+  if (mapping->sorted_units == NULL ||
+      mapping->unit_count > mapping->sorted_capacity) {
+    free(mapping->sorted_units);
+    mapping->sorted_capacity = mapping->unit_count;
+    mapping->sorted_units = malloc((mapping->unit_count + 1) * sizeof(size_t));
+    if (mapping->sorted_units == NULL) {
+      fprintf(stderr, "%s", "error: cannot allocate sorted units\n");
+      mapping->sorted_capacity = 0;
+      return EXIT_FAILURE;
     }
   }
+  memcpy(mapping->sorted_units, mapping->units,
+         mapping->unit_count * sizeof(size_t));
+  qsort(mapping->sorted_units, mapping->unit_count, sizeof(size_t),
+        mapping_compare_decreasing);
+  return EXIT_SUCCESS;
+}
+
+int mapping_compare_decreasing(const void* first, const void* second) {
+  const size_t first_unit = *(const size_t*)first;
+  const size_t second_unit = *(const size_t*)second;
+  return (first_unit < second_unit) - (first_unit > second_unit);
 }
 
-void mapping_calculate_dynamic(mapping_t* mapping) {
+size_t mapping_sum_units(mapping_t* mapping, size_t start, size_t stop) {
   assert(mapping);
-  // Map next unit to worker with minimum sum of processed units.
-  for (size_t unit_index = 0; unit_index < mapping->unit_count; ++unit_index) {
-    mapping->results[DYNAMIC].units_workers[unit_index] =
-        mapping_find_argmin(mapping);
-    mapping->results[DYNAMIC]
-        .units_processed[mapping->results[DYNAMIC].units_workers[unit_index]] +=
-        mapping->units[unit_index];
+  if (mapping->prefix_sums) {
+    return mapping->prefix_sums[stop] - mapping->prefix_sums[start];
   }
-  // Reset sums of units processed per worker
-  for (size_t worker_index = 0; worker_index < mapping->worker_count;
-       ++worker_index) {
-    mapping->results[DYNAMIC].units_processed[worker_index] = 0;
+  size_t sum = 0;
+  for (size_t unit_index = start; unit_index < stop; ++unit_index) {
+    sum += mapping->units[unit_index];
   }
+  return sum;
 }
 
-size_t mapping_find_argmin(mapping_t* mapping) {
+int mapping_calculate_block_loads(mapping_t* mapping) {
   assert(mapping);
-  size_t argmin = 0;
+  size_t* units_processed = mapping->results[BLOCK].units_processed;
+  size_t start = 0;
   for (size_t worker_index = 0; worker_index < mapping->worker_count;
        ++worker_index) {
-    if (mapping->results[DYNAMIC].units_processed[worker_index] <
-        mapping->results[DYNAMIC].units_processed[argmin]) {
-      argmin = worker_index;
-    }
+    const size_t stop = mapping_find_start(mapping, worker_index + 1);
+    units_processed[worker_index] += mapping_sum_units(mapping, start, stop);
+    start = stop;
   }
-  return argmin;
+  return EXIT_SUCCESS;
 }
 
-void mapping_calculate_results(mapping_t* mapping) {
+int mapping_calculate_cyclic_loads(mapping_t* mapping) {
   assert(mapping);
-  // Store sum of serially processed units
+  size_t* units_processed = mapping->results[CYCLIC].units_processed;
+  size_t worker_index = 0;
   for (size_t unit_index = 0; unit_index < mapping->unit_count; ++unit_index) {
-    mapping->serial_sum += mapping->units[unit_index];
+    units_processed[worker_index] += mapping->units[unit_index];
+    if (++worker_index == mapping->worker_count) {
+      worker_index = 0;
+    }
   }
-  // Compute results for each mapping
-  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
-       ++mapping_index) {
-    // For each worker, find all units that it should process and add them
-    for (size_t worker_index = 0; worker_index < mapping->worker_count;
-         ++worker_index) {
-      for (size_t unit_index = 0; unit_index < mapping->unit_count;
-           ++unit_index) {
-        if (mapping->results[mapping_index].units_workers[unit_index] ==
-            worker_index) {
-          mapping->results[mapping_index].units_processed[worker_index] +=
-              mapping->units[unit_index];
-        }
-      }
+  return EXIT_SUCCESS;
+}
+
+int mapping_calculate_block_cyclic_loads(mapping_t* mapping) {
+  assert(mapping);
+  size_t* units_processed = mapping->results[BLOCK_CYCLIC].units_processed;
+  const size_t block_size = mapping->block_size;
+  size_t worker_index = 0;
+  for (size_t start = 0; start < mapping->unit_count; start += block_size) {
+    // Last block may be shorter than block size
+    const size_t stop = mapping->unit_count - start > block_size
+                            ? start + block_size
+                            : mapping->unit_count;
+    units_processed[worker_index] += mapping_sum_units(mapping, start, stop);
+    if (++worker_index == mapping->worker_count) {
+      worker_index = 0;
     }
-    // Find index of maximum sum of processed units
-    size_t maximum_index = 0;
-    for (size_t worker_index = 0; worker_index < mapping->worker_count;
-         ++worker_index) {
-      if (mapping->results[mapping_index].units_processed[worker_index] >
-          mapping->results[mapping_index].units_processed[maximum_index]) {
-        maximum_index = worker_index;
+  }
+  return EXIT_SUCCESS;
+}
+
+int mapping_calculate_dynamic_loads(mapping_t* mapping) {
+  assert(mapping);
+  mapping_scheduler_t scheduler;
+  int error = mapping_scheduler_init(&scheduler, mapping, DYNAMIC);
+  if (error == EXIT_SUCCESS) {
+    for (size_t unit_index = 0; unit_index < mapping->unit_count;
+         ++unit_index) {
+      mapping_scheduler_assign(&scheduler, mapping->units[unit_index]);
+    }
+    mapping_scheduler_destroy(&scheduler);
+  }
+  return error;
+}
+
+int mapping_calculate_chunked_dynamic_loads(mapping_t* mapping) {
+  assert(mapping);
+  mapping_scheduler_t scheduler;
+  int error = mapping_scheduler_init(&scheduler, mapping, CHUNKED_DYNAMIC);
+  if (error == EXIT_SUCCESS) {
+    for (size_t start = 0; start < mapping->unit_count;
+         start += mapping->chunk_size) {
+      size_t stop = start + mapping->chunk_size;
+      if (stop > mapping->unit_count) {
+        stop = mapping->unit_count;
       }
+      mapping_scheduler_assign(&scheduler,
+                               mapping_sum_units(mapping, start, stop));
+    }
+    mapping_scheduler_destroy(&scheduler);
+  }
+  return error;
+}
+
+int mapping_calculate_guided_loads(mapping_t* mapping) {
+  assert(mapping);
+  mapping_scheduler_t scheduler;
+  int error = mapping_scheduler_init(&scheduler, mapping, GUIDED);
+  if (error == EXIT_SUCCESS) {
+    size_t start = 0;
+    while (start < mapping->unit_count) {
+      const size_t remaining = mapping->unit_count - start;
+      const size_t length = mapping_find_guided_length(mapping, remaining);
+      const size_t stop = start + length;
+      mapping_scheduler_assign(&scheduler,
+                               mapping_sum_units(mapping, start, stop));
+      start = stop;
+    }
+    mapping_scheduler_destroy(&scheduler);
+  }
+  return error;
+}
+
+int mapping_calculate_lpt_loads(mapping_t* mapping) {
+  assert(mapping);
+  int error = EXIT_SUCCESS;
+  if (mapping->sorted_units == NULL) {
+    error = mapping_sort_units(mapping);
+  }
+  mapping_scheduler_t scheduler;
+  if (error == EXIT_SUCCESS) {
+    error = mapping_scheduler_init(&scheduler, mapping, LPT);
+  }
+  if (error == EXIT_SUCCESS) {
+    for (size_t index = 0; index < mapping->unit_count; ++index) {
+      mapping_scheduler_assign(&scheduler, mapping->sorted_units[index]);
+    }
+    mapping_scheduler_destroy(&scheduler);
+  }
+  return error;
+}
+
+size_t mapping_find_maximum(const size_t* loads, size_t worker_count) {
+  assert(loads);
+  return worker_count > 0 ? loads[load_search_argmax(loads, worker_count)]
+                          : 0;
+}
+
+void mapping_calculate_serial_sum(mapping_t* mapping) {
+  assert(mapping);
+  mapping->serial_sum += mapping_sum_units(mapping, 0, mapping->unit_count);
+}
+
+void mapping_calculate_results(mapping_t* mapping) {
+  assert(mapping);
+  // Compute results for each mapping. Sums of units processed per worker
+  // were accumulated while units were mapped.
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    if ((mapping->stream && !mapping_policies[mapping_index].online) ||
+        !(mapping->mappings & (1u << mapping_index))) {
+      continue;
     }
-    mapping->results[mapping_index].maximum =
-        mapping->results[mapping_index].units_processed[maximum_index];
+    mapping->results[mapping_index].maximum = mapping_find_maximum(
+        mapping->results[mapping_index].units_processed,
+        mapping->worker_count);
     mapping->results[mapping_index].speedup =
         (double)mapping->serial_sum /
         (double)mapping->results[mapping_index].maximum;
     mapping->results[mapping_index].efficiency =
         mapping->results[mapping_index].speedup / mapping->worker_count;
+    if (mapping->events) {
+      mapping_calculate_makespan(mapping, mapping_index);
+    }
   }
 }
 
-void mapping_print_results(mapping_t* mapping) {
+void mapping_calculate_makespan(mapping_t* mapping, size_t mapping_index) {
   assert(mapping);
-  printf("%zu units\n", mapping->unit_count);
-  for (size_t unit_index = 0; unit_index < mapping->unit_count; ++unit_index) {
-    printf("%zu ", mapping->units[unit_index]);
+  mapping_result_t* result = &mapping->results[mapping_index];
+  // Dispatched mappings advanced their finish times while they were mapped.
+  // Static workers know their units beforehand and never wait for a dispatch
+  if (!mapping_policies[mapping_index].dispatched) {
+    for (size_t worker_index = 0; worker_index < mapping->worker_count;
+         ++worker_index) {
+      result->finish_times[worker_index] =
+          (double)result->units_processed[worker_index] /
+          mapping->speeds[worker_index];
+    }
   }
-  printf("\n");
-  printf("Serially processed units: %zu\n", mapping->serial_sum);
-  printf("\n");
-  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
-       ++mapping_index) {
-    switch (mapping_index) {
-      case BLOCK:
-        printf("BLOCK MAPPING\n");
-        break;
-      case CYCLIC:
-        printf("CYCLIC MAPPING\n");
+  result->makespan = 0.0;
+  for (size_t worker_index = 0; worker_index < mapping->worker_count;
+       ++worker_index) {
+    if (result->finish_times[worker_index] > result->makespan) {
+      result->makespan = result->finish_times[worker_index];
+    }
+  }
+  // Serial time is that of one worker of speed 1 without dispatches, and
+  // efficiency is relative to the sum of speeds of all workers
+  result->speedup = (double)mapping->serial_sum / result->makespan;
+  result->efficiency = result->speedup / mapping->capacity;
+}
+
+int mapping_print_results(mapping_t* mapping) {
+  assert(mapping);
+  writer_t writer;
+  int error = writer_open(&writer, STDOUT_FILENO);
+  if (error == EXIT_SUCCESS) {
+    switch (mapping->format) {
+      case FORMAT_CSV:
+        mapping_print_csv(mapping, &writer);
         break;
-      case BLOCK_CYCLIC:
-        printf("BLOCK-CYCLIC MAPPING\n");
+      case FORMAT_JSON:
+        mapping_print_json(mapping, &writer);
         break;
-      case DYNAMIC:
-        printf("DYNAMIC MAPPING\n");
+      case FORMAT_BINARY:
+        mapping_print_binary(mapping, &writer);
         break;
       default:
+        mapping_print_text(mapping, &writer);
         break;
     }
-    printf("Units-workers mapping\n");
+  }
+  return writer_close(&writer);
+}
+
+void mapping_print_text(mapping_t* mapping, writer_t* writer) {
+  assert(mapping);
+  writer_put_size(writer, mapping->unit_count);
+  writer_put_string(writer, " units\n");
+  // Units are not stored in stream mode, nor printed in summary mode
+  if (mapping->units && !mapping->summary) {
     for (size_t unit_index = 0; unit_index < mapping->unit_count;
          ++unit_index) {
-      printf("%zu ", mapping->results[mapping_index].units_workers[unit_index]);
+      writer_put_size(writer, mapping->units[unit_index]);
+      writer_put_char(writer, ' ');
+    }
+    writer_put_char(writer, '\n');
+  }
+  writer_put_string(writer, "Serially processed units: ");
+  writer_put_size(writer, mapping->serial_sum);
+  writer_put_char(writer, '\n');
+  if (mapping->execute) {
+    writer_printf(writer, "Serial execution: %.6lfs\n",
+                  mapping->serial_elapsed);
+  }
+  if (mapping->autotune) {
+    writer_printf(writer, "Recommended block size: %zu (speedup %.3lf)\n",
+                  mapping->block_size,
+                  mapping->results[BLOCK_CYCLIC].speedup);
+  }
+  if (mapping->events) {
+    writer_printf(writer, "Dispatch overhead: %g\n", mapping->overhead);
+    writer_put_string(writer, "Worker speeds: ");
+    for (size_t worker_index = 0; worker_index < mapping->worker_count;
+         ++worker_index) {
+      writer_printf(writer, "%g ", mapping->speeds[worker_index]);
+    }
+    writer_put_char(writer, '\n');
+  }
+  writer_put_char(writer, '\n');
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    // Offline mappings cannot be calculated in stream mode
+    if (mapping->stream && !mapping_policies[mapping_index].online) {
+      continue;
     }
-    printf("\n");
-    printf("Units processed per worker\n");
+    const mapping_result_t* result = &mapping->results[mapping_index];
+    writer_put_string(writer, mapping_policies[mapping_index].name);
+    writer_put_string(writer, " MAPPING\n");
+    if (result->units_workers) {
+      writer_put_string(writer, "Units-workers mapping\n");
+      for (size_t unit_index = 0; unit_index < mapping->unit_count;
+           ++unit_index) {
+        writer_put_size(writer,
+                        worker_ids_get(result->units_workers,
+                                       mapping->worker_width, unit_index));
+        writer_put_char(writer, ' ');
+      }
+      writer_put_char(writer, '\n');
+    }
+    writer_put_string(writer, "Units processed per worker\n");
     for (size_t worker_index = 0; worker_index < mapping->worker_count;
          ++worker_index) {
-      printf("%zu ",
-             mapping->results[mapping_index].units_processed[worker_index]);
+      writer_put_size(writer, result->units_processed[worker_index]);
+      writer_put_char(writer, ' ');
     }
-    printf("\n");
-    printf("Maximum:    %zu\n", mapping->results[mapping_index].maximum);
-    printf("Speedup:    %2.3lf\n", mapping->results[mapping_index].speedup);
-    printf("Efficiency: %2.3lf\n", mapping->results[mapping_index].efficiency);
-    printf("\n");
+    writer_put_char(writer, '\n');
+    writer_printf(writer, "Maximum:    %zu\n", result->maximum);
+    if (mapping->events) {
+      writer_printf(writer, "Makespan:   %.3lf\n", result->makespan);
+    }
+    writer_printf(writer, "Speedup:    %2.3lf\n", result->speedup);
+    writer_printf(writer, "Efficiency: %2.3lf\n", result->efficiency);
+    if (mapping->execute) {
+      // Measured values next to simulated ones
+      const double speedup = mapping->serial_elapsed / result->elapsed;
+      writer_printf(writer, "Execution:  %.6lfs\n", result->elapsed);
+      writer_printf(writer, "Measured speedup:    %2.3lf\n", speedup);
+      writer_printf(writer, "Measured efficiency: %2.3lf\n",
+                    speedup / mapping->worker_count);
+    }
+    writer_put_char(writer, '\n');
+  }
+  if (mapping->hierarchy.node_count > 0) {
+    mapping_print_hierarchy_text(mapping, writer);
   }
 }
 
-void mapping_destroy(mapping_t* mapping) {
+void mapping_print_hierarchy_text(mapping_t* mapping, writer_t* writer) {
   assert(mapping);
-  if (mapping->units) {
-    free(mapping->units);
+  const mapping_hierarchy_t* hierarchy = &mapping->hierarchy;
+  writer_printf(writer, "%s/%s HIERARCHICAL MAPPING\n",
+                mapping_policies[hierarchy->node_mapping].name,
+                mapping_policies[hierarchy->thread_mapping].name);
+  writer_printf(writer, "Topology: %zu nodes x %zu threads\n",
+                hierarchy->node_count, hierarchy->node_threads);
+  writer_put_string(writer, "Units processed per node\n");
+  for (size_t node_index = 0; node_index < hierarchy->node_count;
+       ++node_index) {
+    writer_put_size(writer, hierarchy->node_loads[node_index]);
+    writer_put_char(writer, ' ');
   }
-  if (mapping->results) {
-    for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
-         ++mapping_index) {
-      if (mapping->results[mapping_index].units_workers) {
-        free(mapping->results[mapping_index].units_workers);
+  writer_put_char(writer, '\n');
+  writer_printf(writer, "Node imbalance: %2.3lf\n", hierarchy->node_imbalance);
+  writer_put_string(writer, "Thread imbalance per node\n");
+  for (size_t node_index = 0; node_index < hierarchy->node_count;
+       ++node_index) {
+    writer_printf(writer, "%.3lf ", hierarchy->imbalances[node_index]);
+  }
+  writer_put_char(writer, '\n');
+  writer_put_string(writer, "Units processed per worker\n");
+  for (size_t worker_index = 0; worker_index < mapping->worker_count;
+       ++worker_index) {
+    writer_put_size(writer, hierarchy->result.units_processed[worker_index]);
+    writer_put_char(writer, ' ');
+  }
+  writer_put_char(writer, '\n');
+  writer_printf(writer, "Maximum:    %zu\n", hierarchy->result.maximum);
+  writer_printf(writer, "Speedup:    %2.3lf\n", hierarchy->result.speedup);
+  writer_printf(writer, "Efficiency: %2.3lf\n", hierarchy->result.efficiency);
+  writer_put_char(writer, '\n');
+}
+
+void mapping_print_csv(mapping_t* mapping, writer_t* writer) {
+  assert(mapping);
+  writer_put_string(writer, "mapping,units,serial_sum,workers,block_size,"
+                            "chunk_size,maximum,speedup,efficiency");
+  if (mapping->events) {
+    writer_put_string(writer, ",overhead,makespan");
+  }
+  if (mapping->execute) {
+    writer_put_string(writer, ",serial_elapsed,elapsed,measured_speedup,"
+                              "measured_efficiency");
+  }
+  writer_put_char(writer, '\n');
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    if (mapping->stream && !mapping_policies[mapping_index].online) {
+      continue;
+    }
+    const mapping_result_t* result = &mapping->results[mapping_index];
+    writer_printf(writer, "%s,%zu,%zu,%zu,%zu,%zu,%zu,%.6lf,%.6lf",
+                  mapping_policies[mapping_index].name, mapping->unit_count,
+                  mapping->serial_sum, mapping->worker_count,
+                  mapping->block_size, mapping->chunk_size, result->maximum,
+                  result->speedup, result->efficiency);
+    if (mapping->events) {
+      writer_printf(writer, ",%g,%.6lf", mapping->overhead, result->makespan);
+    }
+    if (mapping->execute) {
+      const double speedup = mapping->serial_elapsed / result->elapsed;
+      writer_printf(writer, ",%.6lf,%.6lf,%.6lf,%.6lf",
+                    mapping->serial_elapsed, result->elapsed, speedup,
+                    speedup / mapping->worker_count);
+    }
+    writer_put_char(writer, '\n');
+  }
+  // Hierarchical mapping is named after its node and thread mappings
+  const mapping_hierarchy_t* hierarchy = &mapping->hierarchy;
+  if (hierarchy->node_count > 0) {
+    writer_printf(writer, "%s/%s,%zu,%zu,%zu,%zu,%zu,%zu,%.6lf,%.6lf\n",
+                  mapping_policies[hierarchy->node_mapping].name,
+                  mapping_policies[hierarchy->thread_mapping].name,
+                  mapping->unit_count, mapping->serial_sum,
+                  mapping->worker_count, mapping->block_size,
+                  mapping->chunk_size, hierarchy->result.maximum,
+                  hierarchy->result.speedup, hierarchy->result.efficiency);
+  }
+}
+
+void mapping_print_json(mapping_t* mapping, writer_t* writer) {
+  assert(mapping);
+  writer_printf(writer,
+                "{\"units\":%zu,\"serial_sum\":%zu,\"workers\":%zu,"
+                "\"block_size\":%zu,\"chunk_size\":%zu,",
+                mapping->unit_count, mapping->serial_sum, mapping->worker_count,
+                mapping->block_size, mapping->chunk_size);
+  if (mapping->execute) {
+    writer_printf(writer, "\"serial_elapsed\":%.6lf,",
+                  mapping->serial_elapsed);
+  }
+  if (mapping->events) {
+    writer_printf(writer, "\"overhead\":%g,\"speeds\":[", mapping->overhead);
+    for (size_t worker_index = 0; worker_index < mapping->worker_count;
+         ++worker_index) {
+      writer_printf(writer, "%s%g", worker_index > 0 ? "," : "",
+                    mapping->speeds[worker_index]);
+    }
+    writer_put_string(writer, "],");
+  }
+  writer_put_string(writer, "\"mappings\":[");
+  bool first = true;
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    if (mapping->stream && !mapping_policies[mapping_index].online) {
+      continue;
+    }
+    const mapping_result_t* result = &mapping->results[mapping_index];
+    writer_printf(writer, "%s\n{\"name\":\"%s\",\"maximum\":%zu,",
+                  first ? "" : ",", mapping_policies[mapping_index].name,
+                  result->maximum);
+    first = false;
+    writer_put_string(writer, "\"speedup\":");
+    mapping_print_number(writer, result->speedup);
+    writer_put_string(writer, ",\"efficiency\":");
+    mapping_print_number(writer, result->efficiency);
+    if (mapping->events) {
+      writer_put_string(writer, ",\"makespan\":");
+      mapping_print_number(writer, result->makespan);
+    }
+    if (mapping->execute) {
+      const double speedup = mapping->serial_elapsed / result->elapsed;
+      writer_printf(writer, ",\"elapsed\":%.6lf,\"measured_speedup\":",
+                    result->elapsed);
+      mapping_print_number(writer, speedup);
+      writer_put_string(writer, ",\"measured_efficiency\":");
+      mapping_print_number(writer, speedup / mapping->worker_count);
+    }
+    writer_put_string(writer, ",\"units_processed\":");
+    mapping_print_array(writer, result->units_processed,
+                        mapping->worker_count);
+    if (result->units_workers) {
+      writer_put_string(writer, ",\"units_workers\":[");
+      for (size_t unit_index = 0; unit_index < mapping->unit_count;
+           ++unit_index) {
+        if (unit_index > 0) {
+          writer_put_char(writer, ',');
+        }
+        writer_put_size(writer,
+                        worker_ids_get(result->units_workers,
+                                       mapping->worker_width, unit_index));
       }
-      if (mapping->results[mapping_index].units_processed) {
-        free(mapping->results[mapping_index].units_processed);
+      writer_put_char(writer, ']');
+    }
+    writer_put_char(writer, '}');
+  }
+  const mapping_hierarchy_t* hierarchy = &mapping->hierarchy;
+  if (hierarchy->node_count > 0) {
+    writer_printf(writer,
+                  "%s\n{\"name\":\"%s/%s\",\"nodes\":%zu,"
+                  "\"node_threads\":%zu,\"maximum\":%zu,\"speedup\":",
+                  first ? "" : ",",
+                  mapping_policies[hierarchy->node_mapping].name,
+                  mapping_policies[hierarchy->thread_mapping].name,
+                  hierarchy->node_count, hierarchy->node_threads,
+                  hierarchy->result.maximum);
+    mapping_print_number(writer, hierarchy->result.speedup);
+    writer_put_string(writer, ",\"efficiency\":");
+    mapping_print_number(writer, hierarchy->result.efficiency);
+    writer_put_string(writer, ",\"node_imbalance\":");
+    mapping_print_number(writer, hierarchy->node_imbalance);
+    writer_put_string(writer, ",\"thread_imbalances\":[");
+    for (size_t node_index = 0; node_index < hierarchy->node_count;
+         ++node_index) {
+      if (node_index > 0) {
+        writer_put_char(writer, ',');
       }
+      mapping_print_number(writer, hierarchy->imbalances[node_index]);
+    }
+    writer_put_string(writer, "],\"node_loads\":");
+    mapping_print_array(writer, hierarchy->node_loads, hierarchy->node_count);
+    writer_put_string(writer, ",\"units_processed\":");
+    mapping_print_array(writer, hierarchy->result.units_processed,
+                        mapping->worker_count);
+    writer_put_char(writer, '}');
+  }
+  writer_put_string(writer, "\n]}\n");
+}
+
+void mapping_print_binary(mapping_t* mapping, writer_t* writer) {
+  assert(mapping);
+  mapping_binary_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+  header.version = BINARY_VERSION;
+  header.worker_width = mapping->worker_width;
+  header.mapping_count = MAPPING_COUNT;
+  header.unit_count = mapping->unit_count;
+  header.worker_count = mapping->worker_count;
+  writer_put_bytes(writer, &header, sizeof(header));
+  for (size_t mapping_index = 0; mapping_index < MAPPING_COUNT;
+       ++mapping_index) {
+    char name[BINARY_NAME_SIZE];
+    memset(name, 0, sizeof(name));
+    strncpy(name, mapping_policies[mapping_index].name, sizeof(name) - 1);
+    writer_put_bytes(writer, name, sizeof(name));
+    writer_put_bytes(writer, mapping->results[mapping_index].units_workers,
+                     mapping->unit_count * mapping->worker_width);
+  }
+}
+
+void mapping_print_array(writer_t* writer, const size_t* values,
+                         size_t count) {
+  assert(values || count == 0);
+  writer_put_char(writer, '[');
+  for (size_t index = 0; index < count; ++index) {
+    if (index > 0) {
+      writer_put_char(writer, ',');
     }
-    free(mapping->results);
+    writer_put_size(writer, values[index]);
+  }
+  writer_put_char(writer, ']');
+}
+
+void mapping_print_number(writer_t* writer, double value) {
+  if (isfinite(value)) {
+    writer_printf(writer, "%.6lf", value);
+  } else {
+    writer_put_string(writer, "null");
   }
+}
+
+void mapping_destroy(mapping_t* mapping) {
+  assert(mapping);
+  free(mapping->owned_units);
+  free(mapping->prefix_sums);
+  free(mapping->sorted_units);
+  free(mapping->owned_speeds);
+  // Node loads, imbalances and worker loads are in the same allocation
+  free(mapping->hierarchy.node_loads);
+  // Arrays of results are in the same allocation
+  free(mapping->results);
   free(mapping);
 }
+
+// https://jeisson.ecci.ucr.ac.cr/concurrente/2021b/ejemplos/pthreads/hello_iw_shr/src/hello_iw_shr.c
+static double get_duration(struct timespec stop_time,
+                           struct timespec start_time) {
+  return (stop_time.tv_sec + 1e-9 * stop_time.tv_nsec) -
+         (start_time.tv_sec + 1e-9 * start_time.tv_nsec);
+}
@@ -12,6 +12,9 @@
 #ifndef MAPPING_H
 #define MAPPING_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
 /**
  * @brief Mapping data.
  * @remark Opaque struct.
@@ -36,6 +39,94 @@ mapping_t* mapping_create();
  */
 int mapping_run(mapping_t* mapping, int argc, char* argv[]);
 
+/**
+ * @brief Parameters of an in-process evaluation of all mappings.
+ * @details Fields have the meaning of the command line options with the
+ * same name. See mapping_init_params() for defaults.
+ *
+ */
+typedef struct mapping_params {
+  /// Worker count
+  size_t worker_count;
+  /// Block size for block-cyclic mapping
+  size_t block_size;
+  /// Chunk size for chunked-dynamic mapping, minimum chunk size for guided
+  size_t chunk_size;
+  /// True to build prefix sums of units before mapping them, as --index
+  bool index;
+  /// True to simulate dispatch overhead and worker speeds as events
+  bool events;
+  /// Time of each dispatch in event mode, as --overhead
+  double overhead;
+  /// Speed factors repeated over workers in event mode, as --speeds. NULL
+  /// for speed 1. Not owned by the mapping
+  const double* speeds;
+  /// Number of speed factors
+  size_t speed_count;
+  /// Mappings to evaluate, bit i for mapping index i. All by default.
+  /// Outcomes of other mappings are not stored
+  unsigned mappings;
+} mapping_params_t;
+
+/**
+ * @brief Results of one mapping, in storage owned by the caller.
+ *
+ */
+typedef struct mapping_outcome {
+  /// Maximum sum of units processed by a worker
+  size_t maximum;
+  /// Speedup
+  double speedup;
+  /// Efficiency
+  double efficiency;
+  /// Simulated time of the last worker, only in event mode
+  double makespan;
+  /// Array of worker_count elements where units processed per worker are
+  /// stored, or NULL if they are not needed
+  size_t* units_processed;
+} mapping_outcome_t;
+
+/**
+ * @brief Set default parameters, as if no option was given.
+ *
+ * @param params Parameters to initialize
+ */
+void mapping_init_params(mapping_params_t* params);
+
+/**
+ * @brief Get number of mappings reported by an evaluation.
+ *
+ * @return Mapping count
+ */
+size_t mapping_get_count(void);
+
+/**
+ * @brief Get name of a mapping, as printed in results.
+ *
+ * @param mapping_index Mapping index, less than mapping_get_count()
+ * @return Mapping name
+ */
+const char* mapping_get_name(size_t mapping_index);
+
+/**
+ * @brief Evaluate all mappings of units in memory, without reading input or
+ * printing results.
+ * @details Units are not copied. Internal arrays are kept between calls and
+ * only grow, so repeated evaluations of similar sizes do not allocate. A
+ * mapping can be used by one thread at a time. Its own units and options
+ * are kept, for later calls to mapping_run().
+ *
+ * @param mapping Mapping data
+ * @param units Positive units. Only read during the call
+ * @param unit_count Unit count
+ * @param params Parameters
+ * @param outcomes Array of mapping_get_count() results to fill
+ * @return Error code
+ */
+int mapping_evaluate(mapping_t* mapping, const size_t* units,
+                     size_t unit_count, const mapping_params_t* params,
+                     mapping_outcome_t* outcomes);
+
 /**
  * @brief Destroy mapping data.
  *
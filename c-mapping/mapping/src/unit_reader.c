@@ -0,0 +1,289 @@
+/**
+ * @file unit_reader.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Buffered reader of work units. Implementation.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "unit_reader.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Size of chunks read from inputs that cannot be mapped
+#define UNIT_READER_CHUNK_SIZE (1 << 20)
+
+/// Bytes of mapped input sampled to estimate its unit count
+#define UNIT_READER_SAMPLE_SIZE (1 << 20)
+
+/// Largest value accepted, as scanf("%ld") saturates to LONG_MAX
+#define UNIT_READER_MAX_VALUE ((size_t)LONG_MAX)
+
+/**
+ * @brief Map a regular file into memory.
+ *
+ * @param reader Reader
+ * @return true if file was mapped
+ */
+static bool unit_reader_map(unit_reader_t* reader);
+
+/**
+ * @brief Read next chunk of input keeping unparsed bytes.
+ *
+ * @param reader Reader
+ * @return Error code
+ */
+static int unit_reader_fill(unit_reader_t* reader);
+
+/**
+ * @brief Find end of bytes that can be parsed without splitting a token.
+ *
+ * @param reader Reader
+ * @return Position after last white space, or end of data at end of input
+ */
+static size_t unit_reader_safe_end(const unit_reader_t* reader);
+
+/**
+ * @brief Parse units in data range [position, stop).
+ *
+ * @param reader Reader
+ * @param stop End of range
+ * @param units Array where units are stored
+ * @param count Maximum number of units to store
+ * @return Number of units stored
+ */
+static size_t unit_reader_parse(unit_reader_t* reader, size_t stop,
+                                size_t* units, size_t count);
+
+/**
+ * @brief Check for white space as isspace() does in the "C" locale.
+ *
+ * @param character Character
+ * @return true if white space
+ */
+static inline bool unit_reader_is_space(char character) {
+  return character == ' ' || (character >= '\t' && character <= '\r');
+}
+
+/**
+ * @brief Check for decimal digit.
+ *
+ * @param character Character
+ * @return true if digit
+ */
+static inline bool unit_reader_is_digit(char character) {
+  return (unsigned char)(character - '0') < 10;
+}
+
+int unit_reader_open(unit_reader_t* reader, int fd) {
+  assert(reader);
+  memset(reader, 0, sizeof(unit_reader_t));
+  reader->fd = fd;
+  reader->error = EXIT_SUCCESS;
+  if (!unit_reader_map(reader)) {
+    reader->capacity = UNIT_READER_CHUNK_SIZE;
+    reader->data = malloc(reader->capacity);
+    if (reader->data == NULL) {
+      fprintf(stderr, "%s", "error: cannot allocate input buffer\n");
+      reader->error = EXIT_FAILURE;
+      reader->end = true;
+    }
+  }
+  return reader->error;
+}
+
+static bool unit_reader_map(unit_reader_t* reader) {
+  struct stat status;
+  if (fstat(reader->fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+    return false;
+  }
+  // Input may have been partially consumed by a previous process
+  off_t offset = lseek(reader->fd, 0, SEEK_CUR);
+  if (offset < 0 || offset > status.st_size) {
+    return false;
+  }
+  // Empty files cannot be mapped, but are files without units
+  if (status.st_size == 0) {
+    reader->mapped = true;
+    reader->end = true;
+    return true;
+  }
+  void* data =
+      mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, reader->fd, 0);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  madvise(data, status.st_size, MADV_SEQUENTIAL);
+  reader->data = data;
+  reader->size = status.st_size;
+  reader->position = offset;
+  reader->start = offset;
+  reader->file_size = status.st_size - offset;
+  reader->mapped = true;
+  reader->end = true;
+  return true;
+}
+
+size_t unit_reader_read(unit_reader_t* reader, size_t* units, size_t count) {
+  assert(reader);
+  size_t stored = 0;
+  while (stored < count && !reader->stopped &&
+         reader->error == EXIT_SUCCESS) {
+    size_t stop = unit_reader_safe_end(reader);
+    if (reader->position < stop) {
+      stored += unit_reader_parse(reader, stop, units + stored,
+                                  count - stored);
+    } else if (reader->end) {
+      break;
+    } else {
+      reader->error = unit_reader_fill(reader);
+    }
+  }
+  return stored;
+}
+
+static size_t unit_reader_safe_end(const unit_reader_t* reader) {
+  if (reader->end) {
+    return reader->size;
+  }
+  size_t stop = reader->size;
+  while (stop > reader->position &&
+         !unit_reader_is_space(reader->data[stop - 1])) {
+    --stop;
+  }
+  return stop;
+}
+
+static int unit_reader_fill(unit_reader_t* reader) {
+  int error = EXIT_SUCCESS;
+  // Move unparsed bytes to the beginning of buffer
+  size_t pending = reader->size - reader->position;
+  memmove(reader->data, reader->data + reader->position, pending);
+  reader->position = 0;
+  reader->size = pending;
+  // A token larger than buffer requires a larger buffer
+  if (reader->size == reader->capacity) {
+    char* data = realloc(reader->data, 2 * reader->capacity);
+    if (data) {
+      reader->data = data;
+      reader->capacity *= 2;
+    } else {
+      fprintf(stderr, "%s", "error: cannot resize input buffer\n");
+      return EXIT_FAILURE;
+    }
+  }
+  ssize_t bytes = 0;
+  do {
+    bytes = read(reader->fd, reader->data + reader->size,
+                 reader->capacity - reader->size);
+  } while (bytes < 0 && errno == EINTR);
+  if (bytes > 0) {
+    reader->size += bytes;
+  } else if (bytes == 0) {
+    reader->end = true;
+  } else {
+    fprintf(stderr, "error: cannot read input: %s\n", strerror(errno));
+    error = EXIT_FAILURE;
+  }
+  return error;
+}
+
+static size_t unit_reader_parse(unit_reader_t* reader, size_t stop,
+                                size_t* units, size_t count) {
+  const char* data = reader->data;
+  size_t position = reader->position;
+  size_t stored = 0;
+  while (stored < count) {
+    while (position < stop && unit_reader_is_space(data[position])) {
+      ++position;
+    }
+    if (position == stop) {
+      break;
+    }
+    const size_t token = position;
+    bool negative = false;
+    if (data[position] == '-' || data[position] == '+') {
+      negative = data[position] == '-';
+      ++position;
+    }
+    if (position == stop || !unit_reader_is_digit(data[position])) {
+      // Not an integer: stop reading as scanf() would
+      position = token;
+      reader->stopped = true;
+      break;
+    }
+    size_t value = 0;
+    while (position < stop && unit_reader_is_digit(data[position])) {
+      if (value <= UNIT_READER_MAX_VALUE / 10) {
+        value = 10 * value + (size_t)(data[position] - '0');
+      } else {
+        value = UNIT_READER_MAX_VALUE + 1;
+      }
+      ++position;
+    }
+    if (!negative && value > 0) {
+      units[stored++] =
+          value > UNIT_READER_MAX_VALUE ? UNIT_READER_MAX_VALUE : value;
+    }
+  }
+  reader->position = position;
+  return stored;
+}
+
+size_t unit_reader_estimate(const unit_reader_t* reader) {
+  assert(reader);
+  if (!reader->mapped || reader->position >= reader->size) {
+    return 0;
+  }
+  const size_t remaining = reader->size - reader->position;
+  const size_t sample =
+      remaining < UNIT_READER_SAMPLE_SIZE ? remaining : UNIT_READER_SAMPLE_SIZE;
+  const char* data = reader->data + reader->position;
+  // A token starts at each byte that is not space and follows a space
+  size_t tokens = !unit_reader_is_space(data[0]);
+  for (size_t index = 1; index < sample; ++index) {
+    tokens += unit_reader_is_space(data[index - 1]) &&
+              !unit_reader_is_space(data[index]);
+  }
+  if (sample == remaining) {
+    return tokens;
+  }
+  return (size_t)((double)tokens * remaining / sample) + 1;
+}
+
+int unit_reader_rewind(unit_reader_t* reader) {
+  assert(reader);
+  int error = EXIT_SUCCESS;
+  if (reader->mapped && reader->error == EXIT_SUCCESS) {
+    reader->position = reader->start;
+    reader->stopped = false;
+  } else {
+    error = EXIT_FAILURE;
+  }
+  return error;
+}
+
+void unit_reader_close(unit_reader_t* reader) {
+  assert(reader);
+  if (reader->mapped) {
+    if (reader->data) {
+      munmap(reader->data, reader->size);
+    }
+  } else {
+    free(reader->data);
+  }
+  reader->data = NULL;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file unit_reader.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Buffered reader of work units. Header.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef UNIT_READER_H
+#define UNIT_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Reader of integers separated by white space.
+ * @details Regular files are memory mapped. Other inputs, e.g. pipes, are
+ * read in large chunks. Values are parsed with the same rules as
+ * scanf("%ld"): reading stops at the first token that is not an integer.
+ *
+ */
+typedef struct unit_reader {
+  /// File descriptor
+  int fd;
+  /// Input data, either mapped or buffered. NULL for empty files
+  char* data;
+  /// Number of valid bytes in data
+  size_t size;
+  /// Capacity of data buffer, zero if mapped
+  size_t capacity;
+  /// Position of next byte to parse in data
+  size_t position;
+  /// Position of first byte of input in data, if mapped
+  size_t start;
+  /// Size of input file in bytes, zero if unknown
+  size_t file_size;
+  /// True if data is memory mapped
+  bool mapped;
+  /// True if there is no more input to read from file descriptor
+  bool end;
+  /// True if a token that is not an integer was found
+  bool stopped;
+  /// Error code
+  int error;
+} unit_reader_t;
+
+/**
+ * @brief Open reader on a file descriptor. The descriptor is not closed.
+ *
+ * @param reader Reader to initialize
+ * @param fd File descriptor
+ * @return Error code
+ */
+int unit_reader_open(unit_reader_t* reader, int fd);
+
+/**
+ * @brief Read next positive units. Non-positive values are skipped.
+ *
+ * @param reader Reader
+ * @param units Array where units are stored
+ * @param count Maximum number of units to store
+ * @return Number of units stored. Less than count only at end of input or
+ * on error, see reader->error
+ */
+size_t unit_reader_read(unit_reader_t* reader, size_t* units, size_t count);
+
+/**
+ * @brief Estimate how many units remain in a memory mapped input.
+ * @details Tokens are counted in a sample at the start of remaining data and
+ * scaled to its size. Exact if the sample covers the whole input, except for
+ * non-positive values and tokens that are not integers.
+ *
+ * @param reader Reader
+ * @return Estimated unit count, or zero if unknown
+ */
+size_t unit_reader_estimate(const unit_reader_t* reader);
+
+/**
+ * @brief Restart reading from the beginning of input.
+ * @remark Only memory mapped inputs can be rewound.
+ *
+ * @param reader Reader
+ * @return Error code
+ */
+int unit_reader_rewind(unit_reader_t* reader);
+
+/**
+ * @brief Release reader resources.
+ *
+ * @param reader Reader
+ */
+void unit_reader_close(unit_reader_t* reader);
+
+#endif  // UNIT_READER_H
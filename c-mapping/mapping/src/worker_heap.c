@@ -0,0 +1,96 @@
+/**
+ * @file worker_heap.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Priority queue of workers keyed by load. Implementation.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "worker_heap.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Compare two workers by load, then by index.
+ *
+ * @param heap Heap
+ * @param first First worker index
+ * @param second Second worker index
+ * @return true if first worker goes before second worker
+ */
+static inline bool worker_heap_less(const worker_heap_t* heap, size_t first,
+                                    size_t second) {
+  return heap->loads[first] < heap->loads[second] ||
+         (heap->loads[first] == heap->loads[second] && first < second);
+}
+
+/**
+ * @brief Move worker at heap position down until heap order is restored.
+ *
+ * @param heap Heap
+ * @param position Heap position
+ */
+static void worker_heap_sift_down(worker_heap_t* heap, size_t position) {
+  size_t* workers = heap->workers;
+  const size_t worker = workers[position];
+  while (true) {
+    size_t child = 2 * position + 1;
+    if (child >= heap->worker_count) {
+      break;
+    }
+    if (child + 1 < heap->worker_count &&
+        worker_heap_less(heap, workers[child + 1], workers[child])) {
+      ++child;
+    }
+    if (!worker_heap_less(heap, workers[child], worker)) {
+      break;
+    }
+    workers[position] = workers[child];
+    position = child;
+  }
+  workers[position] = worker;
+}
+
+int worker_heap_init(worker_heap_t* heap, size_t* loads, size_t worker_count) {
+  assert(heap);
+  assert(loads);
+  assert(worker_count > 0);
+  int error = EXIT_SUCCESS;
+  heap->worker_count = worker_count;
+  heap->loads = loads;
+  heap->workers = malloc(worker_count * sizeof(size_t));
+  if (heap->workers) {
+    for (size_t worker_index = 0; worker_index < worker_count;
+         ++worker_index) {
+      heap->workers[worker_index] = worker_index;
+    }
+    // Heapify, from last parent up to the root
+    for (size_t position = worker_count / 2; position > 0; --position) {
+      worker_heap_sift_down(heap, position - 1);
+    }
+  } else {
+    fprintf(stderr, "%s", "error: cannot allocate worker heap\n");
+    error = EXIT_FAILURE;
+  }
+  return error;
+}
+
+size_t worker_heap_add_to_top(worker_heap_t* heap, size_t load) {
+  assert(heap);
+  const size_t worker = heap->workers[0];
+  heap->loads[worker] += load;
+  worker_heap_sift_down(heap, 0);
+  return worker;
+}
+
+void worker_heap_destroy(worker_heap_t* heap) {
+  assert(heap);
+  free(heap->workers);
+  heap->workers = NULL;
+}
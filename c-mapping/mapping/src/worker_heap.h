@@ -0,0 +1,68 @@
+/**
+ * @file worker_heap.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Priority queue of workers keyed by load. Header.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef WORKER_HEAP_H
+#define WORKER_HEAP_H
+
+#include <stddef.h>
+
+/**
+ * @brief Binary min-heap of worker indexes.
+ * @remark Workers are ordered by load and then by index, so the top of the
+ * heap is the same worker that a linear argmin search would choose.
+ *
+ */
+typedef struct worker_heap {
+  /// Worker count
+  size_t worker_count;
+  /// Load per worker, indexed by worker. Not owned by the heap
+  size_t* loads;
+  /// Worker indexes in heap order
+  size_t* workers;
+} worker_heap_t;
+
+/**
+ * @brief Initialize a heap over existing worker loads.
+ *
+ * @param heap Heap to initialize
+ * @param loads Load array of worker_count elements. It must outlive the heap
+ * @param worker_count Worker count. Must be greater than zero
+ * @return Error code
+ */
+int worker_heap_init(worker_heap_t* heap, size_t* loads, size_t worker_count);
+
+/**
+ * @brief Get worker with minimum load, lowest index on ties.
+ *
+ * @param heap Heap
+ * @return Worker index
+ */
+static inline size_t worker_heap_top(const worker_heap_t* heap) {
+  return heap->workers[0];
+}
+
+/**
+ * @brief Add load to worker on top of heap and restore heap order.
+ *
+ * @param heap Heap
+ * @param load Load to add
+ * @return Index of the worker that received the load
+ */
+size_t worker_heap_add_to_top(worker_heap_t* heap, size_t load);
+
+/**
+ * @brief Release heap memory. Loads are not released.
+ *
+ * @param heap Heap
+ */
+void worker_heap_destroy(worker_heap_t* heap);
+
+#endif  // WORKER_HEAP_H
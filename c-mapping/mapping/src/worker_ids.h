@@ -0,0 +1,85 @@
+/**
+ * @file worker_ids.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Compact arrays of worker indexes. Header.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef WORKER_IDS_H
+#define WORKER_IDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Find the narrowest width that can store any worker index.
+ *
+ * @param worker_count Worker count
+ * @return Bytes per worker index: 1, 2, 4 or 8
+ */
+static inline size_t worker_ids_width(size_t worker_count) {
+  if (worker_count <= (size_t)UINT8_MAX + 1) {
+    return sizeof(uint8_t);
+  }
+  if (worker_count <= (size_t)UINT16_MAX + 1) {
+    return sizeof(uint16_t);
+  }
+  if (worker_count <= (size_t)UINT32_MAX + 1) {
+    return sizeof(uint32_t);
+  }
+  return sizeof(uint64_t);
+}
+
+/**
+ * @brief Get a worker index from an array.
+ *
+ * @param ids Array of worker indexes
+ * @param width Bytes per worker index
+ * @param index Position in array
+ * @return Worker index
+ */
+static inline size_t worker_ids_get(const void* ids, size_t width,
+                                    size_t index) {
+  switch (width) {
+    case sizeof(uint8_t):
+      return ((const uint8_t*)ids)[index];
+    case sizeof(uint16_t):
+      return ((const uint16_t*)ids)[index];
+    case sizeof(uint32_t):
+      return ((const uint32_t*)ids)[index];
+    default:
+      return ((const uint64_t*)ids)[index];
+  }
+}
+
+/**
+ * @brief Store a worker index in an array.
+ *
+ * @param ids Array of worker indexes
+ * @param width Bytes per worker index
+ * @param index Position in array
+ * @param worker_index Worker index. It must fit in width bytes
+ */
+static inline void worker_ids_set(void* ids, size_t width, size_t index,
+                                  size_t worker_index) {
+  switch (width) {
+    case sizeof(uint8_t):
+      ((uint8_t*)ids)[index] = (uint8_t)worker_index;
+      break;
+    case sizeof(uint16_t):
+      ((uint16_t*)ids)[index] = (uint16_t)worker_index;
+      break;
+    case sizeof(uint32_t):
+      ((uint32_t*)ids)[index] = (uint32_t)worker_index;
+      break;
+    default:
+      ((uint64_t*)ids)[index] = (uint64_t)worker_index;
+      break;
+  }
+}
+
+#endif  // WORKER_IDS_H
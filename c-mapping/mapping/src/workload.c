@@ -0,0 +1,168 @@
+/**
+ * @file workload.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Generator of synthetic workloads. Implementation.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "workload.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Largest value of uniform and sorted distributions
+#define WORKLOAD_MAX_VALUE 100
+
+/// Largest exponent of geometric distribution
+#define WORKLOAD_MAX_EXPONENT 20
+
+/// Largest value of Zipf distribution
+#define WORKLOAD_ZIPF_VALUES 1000
+
+/// Percentage of small values in bimodal distribution
+#define WORKLOAD_BIMODAL_SMALL 90
+
+/// Names of distributions, as given on command line
+static const char* const workload_names[WORKLOAD_DISTRIBUTION_COUNT] = {
+    [WORKLOAD_UNIFORM] = "uniform",       [WORKLOAD_GEOMETRIC] = "geometric",
+    [WORKLOAD_ZIPF] = "zipf",             [WORKLOAD_BIMODAL] = "bimodal",
+    [WORKLOAD_ASCENDING] = "ascending",   [WORKLOAD_DESCENDING] = "descending",
+};
+
+/**
+ * @brief Generate next pseudo-random number (SplitMix64).
+ *
+ * @param workload Workload
+ * @return Pseudo-random number
+ */
+static uint64_t workload_random(workload_t* workload);
+
+/**
+ * @brief Generate a pseudo-random number in [first, last].
+ *
+ * @param workload Workload
+ * @param first Smallest value
+ * @param last Largest value
+ * @return Pseudo-random number
+ */
+static size_t workload_between(workload_t* workload, size_t first,
+                               size_t last);
+
+/**
+ * @brief Generate a Zipf value by binary search of cumulative probabilities.
+ *
+ * @param workload Workload
+ * @return Value from 1 to WORKLOAD_ZIPF_VALUES
+ */
+static size_t workload_zipf(workload_t* workload);
+
+const char* workload_name(enum workload_distribution distribution) {
+  assert(distribution < WORKLOAD_DISTRIBUTION_COUNT);
+  return workload_names[distribution];
+}
+
+enum workload_distribution workload_find(const char* name) {
+  assert(name);
+  size_t distribution = 0;
+  while (distribution < WORKLOAD_DISTRIBUTION_COUNT &&
+         strcmp(name, workload_names[distribution]) != 0) {
+    ++distribution;
+  }
+  return (enum workload_distribution)distribution;
+}
+
+int workload_init(workload_t* workload,
+                  enum workload_distribution distribution, size_t unit_count,
+                  uint64_t seed) {
+  assert(workload);
+  assert(distribution < WORKLOAD_DISTRIBUTION_COUNT);
+  int error = EXIT_SUCCESS;
+  workload->distribution = distribution;
+  workload->unit_count = unit_count;
+  workload->unit_index = 0;
+  workload->state = seed;
+  workload->cumulative = NULL;
+  if (distribution == WORKLOAD_ZIPF) {
+    workload->cumulative = malloc(WORKLOAD_ZIPF_VALUES * sizeof(double));
+    if (workload->cumulative) {
+      double sum = 0.0;
+      for (size_t value = 1; value <= WORKLOAD_ZIPF_VALUES; ++value) {
+        sum += 1.0 / value;
+        workload->cumulative[value - 1] = sum;
+      }
+      for (size_t index = 0; index < WORKLOAD_ZIPF_VALUES; ++index) {
+        workload->cumulative[index] /= sum;
+      }
+    } else {
+      fprintf(stderr, "%s", "error: cannot allocate Zipf probabilities\n");
+      error = EXIT_FAILURE;
+    }
+  }
+  return error;
+}
+
+size_t workload_next(workload_t* workload) {
+  assert(workload);
+  assert(workload->unit_index < workload->unit_count);
+  const size_t unit_index = workload->unit_index++;
+  switch (workload->distribution) {
+    case WORKLOAD_GEOMETRIC:
+      return (size_t)1 << workload_between(workload, 0, WORKLOAD_MAX_EXPONENT);
+    case WORKLOAD_ZIPF:
+      return workload_zipf(workload);
+    case WORKLOAD_BIMODAL:
+      if (workload_between(workload, 1, 100) <= WORKLOAD_BIMODAL_SMALL) {
+        return workload_between(workload, 1, 10);
+      }
+      return workload_between(workload, 500, 1000);
+    case WORKLOAD_ASCENDING:
+      return 1 + (size_t)((double)unit_index * WORKLOAD_MAX_VALUE /
+                          workload->unit_count);
+    case WORKLOAD_DESCENDING:
+      return WORKLOAD_MAX_VALUE -
+             (size_t)((double)unit_index * WORKLOAD_MAX_VALUE /
+                      workload->unit_count);
+    default:
+      return workload_between(workload, 1, WORKLOAD_MAX_VALUE);
+  }
+}
+
+void workload_destroy(workload_t* workload) {
+  assert(workload);
+  free(workload->cumulative);
+  workload->cumulative = NULL;
+}
+
+static uint64_t workload_random(workload_t* workload) {
+  uint64_t value = (workload->state += 0x9e3779b97f4a7c15u);
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9u;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebu;
+  return value ^ (value >> 31);
+}
+
+static size_t workload_between(workload_t* workload, size_t first,
+                               size_t last) {
+  return first + workload_random(workload) % (last - first + 1);
+}
+
+static size_t workload_zipf(workload_t* workload) {
+  // Uniform number in [0, 1) with 53 random bits
+  const double probability = (workload_random(workload) >> 11) * 0x1.0p-53;
+  size_t low = 0;
+  size_t high = WORKLOAD_ZIPF_VALUES - 1;
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    if (workload->cumulative[middle] > probability) {
+      high = middle;
+    } else {
+      low = middle + 1;
+    }
+  }
+  return low + 1;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file workload.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Generator of synthetic workloads. Header.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Distributions of unit values.
+ *
+ */
+enum workload_distribution {
+  /// Uniform values from 1 to 100, like input000
+  WORKLOAD_UNIFORM,
+  /// Powers of two from 1 to 2^20 with uniform exponent, like input011
+  WORKLOAD_GEOMETRIC,
+  /// Values from 1 to 1000 with probability proportional to 1 / value
+  WORKLOAD_ZIPF,
+  /// 90% of values from 1 to 10, and 10% from 500 to 1000
+  WORKLOAD_BIMODAL,
+  /// Increasing values from 1 to 100
+  WORKLOAD_ASCENDING,
+  /// Decreasing values from 100 to 1, like first half of input001
+  WORKLOAD_DESCENDING,
+  /// Number of distributions
+  WORKLOAD_DISTRIBUTION_COUNT
+};
+
+/**
+ * @brief Sequence of units that follows a distribution.
+ * @details Units are generated one at a time, so sequences of any length can
+ * be generated in constant memory. The same seed generates the same units.
+ *
+ */
+typedef struct workload {
+  /// Distribution of unit values
+  enum workload_distribution distribution;
+  /// Unit count
+  size_t unit_count;
+  /// Index of next unit
+  size_t unit_index;
+  /// State of pseudo-random number generator
+  uint64_t state;
+  /// Cumulative probabilities of Zipf values, NULL for other distributions
+  double* cumulative;
+} workload_t;
+
+/**
+ * @brief Get name of a distribution.
+ *
+ * @param distribution Distribution
+ * @return Name, e.g. "uniform"
+ */
+const char* workload_name(enum workload_distribution distribution);
+
+/**
+ * @brief Find a distribution by name.
+ *
+ * @param name Name
+ * @return Distribution, or WORKLOAD_DISTRIBUTION_COUNT if not found
+ */
+enum workload_distribution workload_find(const char* name);
+
+/**
+ * @brief Initialize a workload.
+ *
+ * @param workload Workload to initialize
+ * @param distribution Distribution of unit values
+ * @param unit_count Unit count
+ * @param seed Seed of pseudo-random number generator
+ * @return Error code
+ */
+int workload_init(workload_t* workload,
+                  enum workload_distribution distribution, size_t unit_count,
+                  uint64_t seed);
+
+/**
+ * @brief Generate next unit.
+ * @remark At most unit_count units must be generated.
+ *
+ * @param workload Workload
+ * @return Positive unit value
+ */
+size_t workload_next(workload_t* workload);
+
+/**
+ * @brief Release workload resources.
+ *
+ * @param workload Workload
+ */
+void workload_destroy(workload_t* workload);
+
+#endif  // WORKLOAD_H
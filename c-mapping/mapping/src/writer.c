@@ -0,0 +1,176 @@
+/**
+ * @file writer.c
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Buffered writer with a fast integer formatter. Implementation.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "writer.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/// Capacity of output buffer
+#define WRITER_CAPACITY (1 << 20)
+
+/// Maximum number of decimal digits of a size_t value
+#define WRITER_MAX_DIGITS 20
+
+/// Decimal representation of 00 to 99
+static const char writer_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/**
+ * @brief Make room in buffer, flushing it if needed.
+ *
+ * @param writer Writer
+ * @param count Number of bytes that will be written
+ * @return true if there is room for count bytes
+ */
+static bool writer_reserve(writer_t* writer, size_t count);
+
+int writer_open(writer_t* writer, int fd) {
+  assert(writer);
+  writer->fd = fd;
+  writer->size = 0;
+  writer->capacity = WRITER_CAPACITY;
+  writer->error = EXIT_SUCCESS;
+  writer->data = malloc(writer->capacity);
+  if (writer->data == NULL) {
+    fprintf(stderr, "%s", "error: cannot allocate output buffer\n");
+    writer->error = EXIT_FAILURE;
+  }
+  return writer->error;
+}
+
+static bool writer_reserve(writer_t* writer, size_t count) {
+  if (writer->error != EXIT_SUCCESS) {
+    return false;
+  }
+  if (writer->capacity - writer->size < count) {
+    writer_flush(writer);
+  }
+  return writer->error == EXIT_SUCCESS && writer->capacity >= count;
+}
+
+void writer_put_string(writer_t* writer, const char* text) {
+  assert(text);
+  writer_put_bytes(writer, text, strlen(text));
+}
+
+void writer_put_char(writer_t* writer, char character) {
+  assert(writer);
+  if (writer_reserve(writer, 1)) {
+    writer->data[writer->size++] = character;
+  }
+}
+
+void writer_put_size(writer_t* writer, size_t value) {
+  assert(writer);
+  if (!writer_reserve(writer, WRITER_MAX_DIGITS)) {
+    return;
+  }
+  // Digits are formatted from right to left into a small buffer
+  char digits[WRITER_MAX_DIGITS];
+  size_t position = WRITER_MAX_DIGITS;
+  while (value >= 100) {
+    const size_t pair = 2 * (value % 100);
+    value /= 100;
+    digits[--position] = writer_digit_pairs[pair + 1];
+    digits[--position] = writer_digit_pairs[pair];
+  }
+  if (value >= 10) {
+    digits[--position] = writer_digit_pairs[2 * value + 1];
+    digits[--position] = writer_digit_pairs[2 * value];
+  } else {
+    digits[--position] = (char)('0' + value);
+  }
+  const size_t count = WRITER_MAX_DIGITS - position;
+  memcpy(writer->data + writer->size, digits + position, count);
+  writer->size += count;
+}
+
+void writer_put_bytes(writer_t* writer, const void* bytes, size_t count) {
+  assert(writer);
+  assert(bytes || count == 0);
+  const char* data = (const char*)bytes;
+  // Large outputs are copied in buffer-sized pieces
+  while (count > 0 && writer->error == EXIT_SUCCESS) {
+    if (writer->size == writer->capacity) {
+      writer_flush(writer);
+      continue;
+    }
+    size_t piece = writer->capacity - writer->size;
+    if (piece > count) {
+      piece = count;
+    }
+    memcpy(writer->data + writer->size, data, piece);
+    writer->size += piece;
+    data += piece;
+    count -= piece;
+  }
+}
+
+void writer_printf(writer_t* writer, const char* format, ...) {
+  assert(writer);
+  assert(format);
+  char text[256];
+  va_list arguments;
+  va_start(arguments, format);
+  const int length = vsnprintf(text, sizeof(text), format, arguments);
+  va_end(arguments);
+  if (length >= 0 && (size_t)length < sizeof(text)) {
+    writer_put_bytes(writer, text, length);
+  } else {
+    fprintf(stderr, "%s", "error: formatted output too long\n");
+    writer->error = EXIT_FAILURE;
+  }
+}
+
+int writer_flush(writer_t* writer) {
+  assert(writer);
+  size_t written = 0;
+  while (written < writer->size && writer->error == EXIT_SUCCESS) {
+    const ssize_t bytes =
+        write(writer->fd, writer->data + written, writer->size - written);
+    if (bytes >= 0) {
+      written += bytes;
+    } else if (errno != EINTR) {
+      fprintf(stderr, "error: cannot write output: %s\n", strerror(errno));
+      writer->error = EXIT_FAILURE;
+    }
+  }
+  writer->size = 0;
+  return writer->error;
+}
+
+int writer_close(writer_t* writer) {
+  assert(writer);
+  if (writer->data) {
+    writer_flush(writer);
+    free(writer->data);
+    writer->data = NULL;
+  }
+  return writer->error;
+}
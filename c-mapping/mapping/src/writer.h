@@ -0,0 +1,105 @@
+/**
+ * @file writer.h
+ * @author Marco Piedra Venegas (marco.piedra@ucr.ac.cr)
+ * @brief Buffered writer with a fast integer formatter. Header.
+ * @version 1.0.0
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <stddef.h>
+
+/**
+ * @brief Writer that formats output into a large buffer and writes it to a
+ * file descriptor only when the buffer is full.
+ * @details Integers are formatted two digits at a time, so writing millions
+ * of values is bound by I/O instead of printf() formatting.
+ *
+ */
+typedef struct writer {
+  /// File descriptor
+  int fd;
+  /// Output buffer
+  char* data;
+  /// Number of bytes in buffer
+  size_t size;
+  /// Capacity of buffer
+  size_t capacity;
+  /// Error code. Once set, nothing else is written
+  int error;
+} writer_t;
+
+/**
+ * @brief Open writer on a file descriptor. The descriptor is not closed.
+ *
+ * @param writer Writer to initialize
+ * @param fd File descriptor
+ * @return Error code
+ */
+int writer_open(writer_t* writer, int fd);
+
+/**
+ * @brief Write a string.
+ *
+ * @param writer Writer
+ * @param text Null-terminated string
+ */
+void writer_put_string(writer_t* writer, const char* text);
+
+/**
+ * @brief Write a character.
+ *
+ * @param writer Writer
+ * @param character Character
+ */
+void writer_put_char(writer_t* writer, char character);
+
+/**
+ * @brief Write an unsigned integer in decimal, as printf("%zu") does.
+ *
+ * @param writer Writer
+ * @param value Value
+ */
+void writer_put_size(writer_t* writer, size_t value);
+
+/**
+ * @brief Write raw bytes.
+ *
+ * @param writer Writer
+ * @param bytes Bytes
+ * @param count Byte count
+ */
+void writer_put_bytes(writer_t* writer, const void* bytes, size_t count);
+
+/**
+ * @brief Write formatted text, as printf() does. Meant for few values, e.g.
+ * floating point results.
+ *
+ * @param writer Writer
+ * @param format Format string
+ */
+void writer_printf(writer_t* writer, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Write buffered bytes to file descriptor.
+ *
+ * @param writer Writer
+ * @return Error code
+ */
+int writer_flush(writer_t* writer);
+
+/**
+ * @brief Flush and release writer resources.
+ *
+ * @param writer Writer
+ * @return Error code
+ */
+int writer_close(writer_t* writer);
+
+#endif  // WRITER_H